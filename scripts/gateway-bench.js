@@ -0,0 +1,118 @@
+#!/usr/bin/env node
+
+// Throughput of the local gateway under concurrent clients. Each client keeps one connection alive
+// and sends chat completions back to back; the report has requests per second and latency
+// percentiles per concurrency level.
+//
+// Point a provider at the stand-in server so the numbers measure the gateway, not a real provider:
+//   node scripts/stand-in-server.js &
+//   (an LLM config with baseURL http://127.0.0.1:8788/v1, launched with BYOA_GATEWAY_PORT=8790)
+//   node scripts/gateway-bench.js --token "$(cat <app data dir>/gateway-token)"
+//
+// Usage: node scripts/gateway-bench.js --token <gateway token> [--url http://127.0.0.1:8790/v1]
+//                                      [--clients 1,4,16,64] [--requests 200] [--stream false]
+
+const http = require('http');
+
+const options = {
+    token: '',
+    url: 'http://127.0.0.1:8790/v1',
+    clients: '1,4,16,64',
+    requests: '200',
+    stream: 'false',
+};
+const args = process.argv.slice(2);
+for (let i = 0; i < args.length; i += 2) {
+    const name = args[i].replace(/^--/, '');
+    if (!(name in options) || args[i + 1] === undefined) {
+        console.error(
+            'Usage: node scripts/gateway-bench.js --token <gateway token> [--url <base url>] ' +
+                '[--clients 1,4,16,64] [--requests 200] [--stream false]',
+        );
+        process.exit(1);
+    }
+    options[name] = args[i + 1];
+}
+
+const target = new URL(`${options.url.replace(/\/$/, '')}/chat/completions`);
+const stream = options.stream === 'true';
+const body = JSON.stringify({
+    model: 'auto',
+    stream,
+    messages: [
+        { role: 'system', content: 's'.repeat(512) },
+        { role: 'user', content: 'u'.repeat(1024) },
+    ],
+});
+
+function post(agent) {
+    return new Promise(resolve => {
+        const started = process.hrtime.bigint();
+        const req = http.request(
+            {
+                agent,
+                host: target.hostname,
+                port: target.port,
+                path: target.pathname,
+                method: 'POST',
+                headers: {
+                    'Content-Type': 'application/json',
+                    'Content-Length': Buffer.byteLength(body),
+                    Authorization: `Bearer ${options.token}`,
+                },
+            },
+            res => {
+                res.resume();
+                res.on('end', () =>
+                    resolve({
+                        ok: res.statusCode === 200,
+                        ms: Number(process.hrtime.bigint() - started) / 1e6,
+                    }),
+                );
+            },
+        );
+        req.on('error', () => resolve({ ok: false, ms: Number(process.hrtime.bigint() - started) / 1e6 }));
+        req.end(body);
+    });
+}
+
+async function run(clients, total) {
+    const agent = new http.Agent({ keepAlive: true, maxSockets: clients });
+    const latencies = [];
+    let failures = 0;
+    let next = 0;
+
+    const started = process.hrtime.bigint();
+    await Promise.all(
+        Array.from({ length: clients }, async () => {
+            while (next < total) {
+                next++;
+                const result = await post(agent);
+                latencies.push(result.ms);
+                failures += result.ok ? 0 : 1;
+            }
+        }),
+    );
+    const seconds = Number(process.hrtime.bigint() - started) / 1e9;
+    agent.destroy();
+
+    latencies.sort((a, b) => a - b);
+    const percentile = p => latencies[Math.min(latencies.length - 1, Math.floor(latencies.length * p))];
+    return { rps: total / seconds, p50: percentile(0.5), p99: percentile(0.99), failures };
+}
+
+(async () => {
+    const requests = Number(options.requests);
+    console.log(`${requests} requests per level, stream: ${stream}, ${target.href}\n`);
+    console.log('clients      req/s     p50 ms     p99 ms   fail');
+    for (const clients of options.clients.split(',').map(Number)) {
+        // Warm the upstream connections before measuring
+        await run(clients, clients);
+        const result = await run(clients, requests);
+        console.log(
+            `${String(clients).padStart(7)} ${result.rps.toFixed(0).padStart(10)} ` +
+                `${result.p50.toFixed(2).padStart(10)} ${result.p99.toFixed(2).padStart(10)} ` +
+                `${String(result.failures).padStart(6)}`,
+        );
+    }
+})();
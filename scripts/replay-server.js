@@ -0,0 +1,68 @@
+#!/usr/bin/env node
+
+// Serves a network recording (BYOA_RECORD_FILE output) over HTTP with the original
+// header delay and chunk timing, so benchmarks can run the real network stack offline.
+//
+// Usage: node scripts/replay-server.js <recording.jsonl> [port]
+// Requests are matched on method and path+query; the recorded host is ignored.
+
+const fs = require('fs');
+const http = require('http');
+
+const [file, port = '8787'] = process.argv.slice(2);
+if (!file) {
+    console.error('Usage: node scripts/replay-server.js <recording.jsonl> [port]');
+    process.exit(1);
+}
+
+// "METHOD /path?query" -> { exchanges, next }
+const replays = new Map();
+for (const line of fs.readFileSync(file, 'utf8').split('\n')) {
+    if (!line.trim()) {
+        continue;
+    }
+    const exchange = JSON.parse(line);
+    const url = new URL(exchange.url.replace(/^unix:[^:]*:?/, 'http://localhost'));
+    const key = `${exchange.method} ${url.pathname}${url.search}`;
+    if (!replays.has(key)) {
+        replays.set(key, { exchanges: [], next: 0 });
+    }
+    replays.get(key).exchanges.push(exchange);
+}
+console.log(`Loaded ${[...replays.values()].reduce((n, r) => n + r.exchanges.length, 0)} exchanges`);
+
+const sleepUntil = (start, micros) =>
+    new Promise(resolve => setTimeout(resolve, Math.max(0, start + micros / 1000 - Date.now())));
+
+http.createServer(async (req, res) => {
+    const entry = replays.get(`${req.method} ${req.url}`);
+    if (!entry) {
+        res.writeHead(502, { 'Content-Type': 'text/plain' });
+        res.end(`No recorded exchange for ${req.method} ${req.url}`);
+        return;
+    }
+
+    const exchange = entry.exchanges[entry.next];
+    entry.next = (entry.next + 1) % entry.exchanges.length;
+
+    // The body is re-chunked by the recorded sizes, so drop framing headers that no longer apply
+    const headers = { ...exchange.responseHeaders };
+    for (const name of Object.keys(headers)) {
+        if (['content-length', 'transfer-encoding', 'content-encoding', 'connection'].includes(name.toLowerCase())) {
+            delete headers[name];
+        }
+    }
+
+    const start = Date.now();
+    await sleepUntil(start, exchange.headersMicros);
+    res.writeHead(exchange.status, headers);
+
+    const body = Buffer.from(exchange.body, 'utf8');
+    let offset = 0;
+    for (const [micros, size] of exchange.chunks) {
+        await sleepUntil(start, micros);
+        res.write(body.subarray(offset, offset + size));
+        offset += size;
+    }
+    res.end(body.subarray(offset));
+}).listen(Number(port), '127.0.0.1', () => console.log(`Replaying on http://127.0.0.1:${port}`));
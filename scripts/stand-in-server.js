@@ -0,0 +1,127 @@
+#!/usr/bin/env node
+
+// A stand-in OpenAI-compatible provider for benchmarks: answers /v1/chat/completions with a canned
+// reply (streamed as server-sent events when the request asks for it) and /v1/models with one model.
+// It listens on TCP and, optionally, on a Unix domain socket and on a TLS port so all transports hit
+// the same server. TLS needs a certificate, e.g. a self-signed one for localhost:
+//   openssl req -x509 -newkey rsa:2048 -nodes -days 30 -subj /CN=localhost \
+//       -addext subjectAltName=DNS:localhost -keyout key.pem -out cert.pem
+//
+// Usage: node scripts/stand-in-server.js [--port 8788] [--socket /tmp/byoa-stand-in.sock]
+//                                        [--tls-port 8789 --cert cert.pem --key key.pem]
+//                                        [--tokens 32] [--token-delay-ms 0]
+
+const fs = require('fs');
+const http = require('http');
+const https = require('https');
+
+const options = {
+    port: '8788',
+    socket: '',
+    'tls-port': '',
+    cert: '',
+    key: '',
+    tokens: '32',
+    'token-delay-ms': '0',
+};
+const args = process.argv.slice(2);
+for (let i = 0; i < args.length; i += 2) {
+    const name = args[i].replace(/^--/, '');
+    if (!(name in options) || args[i + 1] === undefined) {
+        console.error(
+            'Usage: node scripts/stand-in-server.js [--port 8788] [--socket <path>] ' +
+                '[--tls-port 8789 --cert <pem> --key <pem>] [--tokens 32] [--token-delay-ms 0]',
+        );
+        process.exit(1);
+    }
+    options[name] = args[i + 1];
+}
+
+const tokens = Array.from({ length: Number(options.tokens) }, (_, i) => (i === 0 ? 'Stand' : ` in${i}`));
+const tokenDelay = Number(options['token-delay-ms']);
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+const completion = model => ({
+    id: 'chatcmpl-stand-in',
+    object: 'chat.completion',
+    created: Math.floor(Date.now() / 1000),
+    model,
+    choices: [{ index: 0, message: { role: 'assistant', content: tokens.join('') }, finish_reason: 'stop' }],
+    usage: { prompt_tokens: 16, completion_tokens: tokens.length, total_tokens: 16 + tokens.length },
+});
+
+const chunk = (model, delta, finishReason) => ({
+    id: 'chatcmpl-stand-in',
+    object: 'chat.completion.chunk',
+    created: Math.floor(Date.now() / 1000),
+    model,
+    choices: [{ index: 0, delta, finish_reason: finishReason }],
+});
+
+const server = http.createServer((req, res) => {
+    let body = '';
+    req.on('data', data => (body += data));
+    req.on('end', async () => {
+        if (req.method === 'GET' && req.url.endsWith('/models')) {
+            res.writeHead(200, { 'Content-Type': 'application/json' });
+            res.end(JSON.stringify({ object: 'list', data: [{ id: 'stand-in', object: 'model' }] }));
+            return;
+        }
+        if (req.method !== 'POST' || !req.url.endsWith('/chat/completions')) {
+            res.writeHead(404, { 'Content-Type': 'text/plain' });
+            res.end(`No stand-in for ${req.method} ${req.url}`);
+            return;
+        }
+
+        let request;
+        try {
+            request = JSON.parse(body);
+        } catch {
+            res.writeHead(400, { 'Content-Type': 'text/plain' });
+            res.end('Invalid JSON');
+            return;
+        }
+        const model = request.model || 'stand-in';
+
+        if (!request.stream) {
+            await sleep(tokenDelay * tokens.length);
+            res.writeHead(200, { 'Content-Type': 'application/json' });
+            res.end(JSON.stringify(completion(model)));
+            return;
+        }
+
+        res.writeHead(200, { 'Content-Type': 'text/event-stream', 'Cache-Control': 'no-cache' });
+        for (const token of tokens) {
+            if (tokenDelay) {
+                await sleep(tokenDelay);
+            }
+            res.write(`data: ${JSON.stringify(chunk(model, { content: token }, null))}\n\n`);
+        }
+        res.write(`data: ${JSON.stringify(chunk(model, {}, 'stop'))}\n\n`);
+        res.end('data: [DONE]\n\n');
+    });
+});
+
+server.keepAliveTimeout = 30000;
+server.listen(Number(options.port), '127.0.0.1', () => console.log(`Stand-in on http://127.0.0.1:${options.port}`));
+
+if (options.socket) {
+    if (fs.existsSync(options.socket)) {
+        fs.unlinkSync(options.socket);
+    }
+    const unixServer = http.createServer(server.listeners('request')[0]);
+    unixServer.keepAliveTimeout = 30000;
+    unixServer.listen(options.socket, () => console.log(`Stand-in on unix:${options.socket}`));
+}
+
+if (options['tls-port']) {
+    // Node issues TLS 1.3 session tickets by default, so clients can resume
+    const tlsServer = https.createServer(
+        { cert: fs.readFileSync(options.cert), key: fs.readFileSync(options.key) },
+        server.listeners('request')[0],
+    );
+    tlsServer.keepAliveTimeout = 30000;
+    tlsServer.listen(Number(options['tls-port']), '127.0.0.1', () =>
+        console.log(`Stand-in on https://localhost:${options['tls-port']}`),
+    );
+}
@@ -0,0 +1,176 @@
+// Load and save latency of ConfigStore for large action lists.
+//
+// For each list size the actions are saved repeatedly (encode, flushed temporary file, renames), then
+// loaded cold in fresh child processes, each mapping and decoding settings.bin on its first get().
+// LLM configs go along with their API keys, which land in an in-memory Vault backend, so the
+// keychain is never touched. Everything lives in a temporary data directory.
+//
+// Usage: config-store-bench [--runs N] [action counts, default 100 1000 5000]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "app-paths.hpp"
+#include "config-store.hpp"
+#include "vault-backend.hpp"
+#include "vault.hpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int DEFAULT_RUNS = 20;
+
+    double microsSince(Clock::time_point started) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - started).count();
+    }
+
+    std::string actionsJson(std::size_t count) {
+        json actions = json::array();
+        for (std::size_t i = 0; i < count; i++) {
+            actions.push_back({
+                {"id", "action-" + std::to_string(i)},
+                {"label", "Action " + std::to_string(i)},
+                {"prompt", "Rewrite the text below so that it reads clearly, keeping its meaning, tone and formatting. "
+                           "Variant " +
+                               std::to_string(i)},
+                {"enabled", i % 3 != 0},
+                {"incremental", i % 5 == 0},
+            });
+        }
+        return actions.dump();
+    }
+
+    std::string llmConfigsJson() {
+        json configs = json::array();
+        for (int i = 0; i < 8; i++) {
+            configs.push_back({
+                {"id", "llm-" + std::to_string(i)},
+                {"name", "Provider " + std::to_string(i)},
+                {"modelName", "model-" + std::to_string(i)},
+                {"baseURL", "https://api.example.com/v1"},
+                {"apiKey", "sk-bench-" + std::to_string(i)},
+                {"enabled", true},
+            });
+        }
+        return configs.dump();
+    }
+
+    // Child process: time the first read, which maps and decodes the file
+    int load() {
+        auto started = Clock::now();
+        auto actions = byoa::ConfigStore::get("actions");
+        double micros = microsSince(started);
+        if (!actions) {
+            return 1;
+        }
+        std::printf("%.1f %zu\n", micros, actions->size());
+        return 0;
+    }
+
+    bool runLoad(const std::string &self, double &micros, std::size_t &bytes) {
+        std::string command = "\"" + self + "\" --load";
+        FILE *child         = popen(command.c_str(), "r");
+        if (!child) {
+            return false;
+        }
+        double value     = 0;
+        std::size_t size = 0;
+        int fields       = std::fscanf(child, "%lf %zu", &value, &size);
+        int status       = pclose(child);
+        if (fields != 2 || status != 0) {
+            return false;
+        }
+        micros = value;
+        bytes  = size;
+        return true;
+    }
+
+    void setDataDir(const std::filesystem::path &dir) {
+        // AppPaths::dataDir reads these on first use, here and in the children
+#ifdef _WIN32
+        _putenv_s("APPDATA", dir.string().c_str());
+#elif defined(__APPLE__)
+        setenv("HOME", dir.c_str(), 1);
+#else
+        setenv("XDG_DATA_HOME", dir.c_str(), 1);
+#endif
+    }
+
+    double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0 : values[values.size() / 2];
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    byoa::Vault::setBackend(byoa::VaultBackend::memory());
+    if (argc == 2 && std::string(argv[1]) == "--load") {
+        return load();
+    }
+
+    int runs = DEFAULT_RUNS;
+    std::vector<std::size_t> counts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            counts.push_back(static_cast<std::size_t>(std::strtoul(arg.c_str(), nullptr, 10)));
+        }
+    }
+    if (counts.empty()) {
+        counts = {100, 1000, 5000};
+    }
+
+    auto dataDir = std::filesystem::temp_directory_path() / "byoa-config-store-bench";
+    setDataDir(dataDir);
+
+    std::printf("%d runs per size, median microseconds\n\n", runs);
+    std::printf("%8s %10s %10s %10s %6s\n", "actions", "bytes", "save", "cold load", "fail");
+
+    const std::string configs = llmConfigsJson();
+    int failures              = 0;
+    for (std::size_t count : counts) {
+        const std::string actions = actionsJson(count);
+
+        std::vector<double> saves;
+        for (int i = 0; i < runs; i++) {
+            auto started = Clock::now();
+            bool ok      = byoa::ConfigStore::setMany({{"actions", actions}, {"llm_configs", configs}});
+            saves.push_back(microsSince(started));
+            failures += ok ? 0 : 1;
+        }
+
+        std::vector<double> loads;
+        std::size_t bytes = 0;
+        for (int i = 0; i < runs; i++) {
+            double micros = 0;
+            if (runLoad(argv[0], micros, bytes)) {
+                loads.push_back(micros);
+            } else {
+                failures++;
+            }
+        }
+
+        std::printf("%8zu %10zu %10.0f %10.0f %6d\n", count, bytes, median(saves), median(loads), failures);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dataDir, ec);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+// Cold vs warm first-request latency after a restart, against the TLS port of the local stand-in
+// server (scripts/stand-in-server.js --tls-port).
+//
+// Every "launch" is a fresh child process that does what the app does around its first request:
+// ConnectionCache::load, one transfer attached to the shared caches, ConnectionCache::save. A cold
+// launch starts without connection-cache.json, a warm one with the file the previous launch wrote.
+// The children use a temporary data directory, so the app's own cache file is never touched.
+//
+// Usage: connection-cache-bench [--launches N] <https url> <CA file>
+// e.g.   node scripts/stand-in-server.js --tls-port 8789 --cert cert.pem --key key.pem &
+//        connection-cache-bench https://localhost:8789/v1/models cert.pem
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <curl/curl.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "app-paths.hpp"
+#include "connection-cache.hpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace {
+
+    constexpr int DEFAULT_LAUNCHES = 20;
+
+    struct Timings {
+        double dnsMicros   = 0;
+        double tcpMicros   = 0;
+        double tlsMicros   = 0;
+        double totalMicros = 0;
+    };
+
+    size_t discard(char *, size_t size, size_t count, void *) {
+        return size * count;
+    }
+
+    // One launch: load the persisted caches, make the first request, save them again
+    int launch(const std::string &url, const std::string &caFile) {
+        byoa::ConnectionCache::load();
+
+        CURL *handle = curl_easy_init();
+        curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(handle, CURLOPT_CAINFO, caFile.c_str());
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, discard);
+        auto resolve = byoa::ConnectionCache::attach(handle, url);
+
+        CURLcode rc = curl_easy_perform(handle);
+        if (rc != CURLE_OK) {
+            std::fprintf(stderr, "%s\n", curl_easy_strerror(rc));
+            curl_easy_cleanup(handle);
+            return 1;
+        }
+        byoa::ConnectionCache::record(handle, url);
+
+        // Cumulative times from the start of the transfer, in microseconds
+        curl_off_t dns = 0, connect = 0, tls = 0, total = 0;
+        curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+        curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &tls);
+        curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+        curl_easy_cleanup(handle);
+
+        byoa::ConnectionCache::save();
+        std::printf("%lld %lld %lld %lld\n", static_cast<long long>(dns), static_cast<long long>(connect - dns),
+                    static_cast<long long>(tls - connect), static_cast<long long>(total));
+        return 0;
+    }
+
+    bool runLaunch(const std::string &self, const std::string &url, const std::string &caFile, Timings &timings) {
+        std::string command = "\"" + self + "\" --launch \"" + url + "\" \"" + caFile + "\"";
+        FILE *child         = popen(command.c_str(), "r");
+        if (!child) {
+            return false;
+        }
+        long long dns = 0, tcp = 0, tls = 0, total = 0;
+        int fields    = std::fscanf(child, "%lld %lld %lld %lld", &dns, &tcp, &tls, &total);
+        int status    = pclose(child);
+        if (fields != 4 || status != 0) {
+            return false;
+        }
+        timings.dnsMicros += dns;
+        timings.tcpMicros += tcp;
+        timings.tlsMicros += tls;
+        timings.totalMicros += total;
+        return true;
+    }
+
+    void setDataDir(const std::filesystem::path &dir) {
+        // AppPaths::dataDir reads these on first use in the child
+#ifdef _WIN32
+        _putenv_s("APPDATA", dir.string().c_str());
+#elif defined(__APPLE__)
+        setenv("HOME", dir.c_str(), 1);
+#else
+        setenv("XDG_DATA_HOME", dir.c_str(), 1);
+#endif
+    }
+
+    void print(const char *name, const Timings &sum, int launches) {
+        std::printf("%-6s %10.0f %10.0f %10.0f %10.0f\n", name, sum.dnsMicros / launches, sum.tcpMicros / launches,
+                    sum.tlsMicros / launches, sum.totalMicros / launches);
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc == 4 && std::string(argv[1]) == "--launch") {
+        return launch(argv[2], argv[3]);
+    }
+
+    int launches = DEFAULT_LAUNCHES;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--launches" && i + 1 < argc) {
+            launches = std::max(1, std::atoi(argv[++i]));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        std::fprintf(stderr, "Usage: connection-cache-bench [--launches N] <https url> <CA file>\n");
+        return 1;
+    }
+    const std::string &url    = positional[0];
+    const std::string &caFile = positional[1];
+
+    auto dataDir = std::filesystem::temp_directory_path() / "byoa-connection-cache-bench";
+    setDataDir(dataDir);
+    // Same layout as AppPaths::dataDir computes in the children
+    auto cacheFile = byoa::AppPaths::dataDir() / "connection-cache.json";
+
+    Timings cold, warm;
+    int failures = 0;
+    for (int i = 0; i < launches; i++) {
+        std::error_code ec;
+        std::filesystem::remove(cacheFile, ec);
+        failures += runLaunch(argv[0], url, caFile, cold) ? 0 : 1;
+        failures += runLaunch(argv[0], url, caFile, warm) ? 0 : 1;
+    }
+
+    std::printf("%d cold and %d warm launches, mean microseconds\n\n", launches, launches);
+    std::printf("%-6s %10s %10s %10s %10s\n", "launch", "dns", "tcp", "tls", "total");
+    print("cold", cold, launches);
+    print("warm", warm, launches);
+    if (failures) {
+        std::printf("\n%d launches failed\n", failures);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dataDir, ec);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,376 @@
+// Tokens per second of the in-process CPU backend (LocalModel) on tiny models.
+//
+// Without arguments it writes small synthetic llama models (2 layers, 256 wide, random weights) in
+// every supported weight type to the temp directory and benchmarks each; pass .gguf paths to
+// benchmark real models instead. Per model it reports the cold time to first token (empty KV
+// cache), the warm one (same prompt again, KV cache reused) and the generation rate.
+//
+// Usage: local-model-bench [--runs N] [model.gguf...]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "local-model.hpp"
+
+namespace {
+
+    constexpr int DEFAULT_RUNS = 5;
+
+    /**
+     * @brief Writer for minimal GGUF v3 files with a llama layout and a small SentencePiece vocabulary
+     */
+    class TinyModel {
+      public:
+        explicit TinyModel(std::string weightType) : _weightType(std::move(weightType)) {}
+
+        bool write(const std::filesystem::path &path) {
+            buildVocabulary();
+            addTensors();
+
+            std::string out = "GGUF";
+            put<uint32_t>(out, 3);
+            put<uint64_t>(out, _tensors.size());
+            put<uint64_t>(out, 15);
+            metadata(out);
+
+            uint64_t offset = 0;
+            for (const auto &tensor : _tensors) {
+                putString(out, tensor.name);
+                put<uint32_t>(out, static_cast<uint32_t>(tensor.dims.size()));
+                for (uint64_t dim : tensor.dims) {
+                    put<uint64_t>(out, dim);
+                }
+                put<uint32_t>(out, tensor.type);
+                put<uint64_t>(out, offset);
+                offset += padded(tensor.data.size());
+            }
+            out.resize(padded(out.size()), '\0');
+            for (const auto &tensor : _tensors) {
+                out += tensor.data;
+                out.resize(padded(out.size()), '\0');
+            }
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(out.data(), static_cast<std::streamsize>(out.size()));
+            return file.good();
+        }
+
+      private:
+        static constexpr uint64_t DIM = 256, HIDDEN = 512, HEADS = 4, KV_HEADS = 2, LAYERS = 2;
+
+        struct Tensor {
+            std::string name;
+            std::vector<uint64_t> dims;
+            uint32_t type;
+            std::string data;
+        };
+
+        static std::size_t padded(std::size_t size) {
+            return (size + 31) / 32 * 32;
+        }
+
+        template <typename T>
+        static void put(std::string &out, T value) {
+            out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        static void putString(std::string &out, const std::string &value) {
+            put<uint64_t>(out, value.size());
+            out += value;
+        }
+
+        static void putKey(std::string &out, const std::string &key, uint32_t type) {
+            putString(out, key);
+            put<uint32_t>(out, type);
+        }
+
+        static uint16_t half(float value) {
+            // Round to nearest; the weights here are small normal numbers or zero
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            uint32_t sign     = (bits >> 16) & 0x8000;
+            int exponent      = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+            uint32_t mantissa = bits & 0x7FFFFF;
+            if (exponent <= 0) {
+                return static_cast<uint16_t>(sign);
+            }
+            if (exponent >= 31) {
+                return static_cast<uint16_t>(sign | 0x7BFF);
+            }
+            uint32_t result = sign | (exponent << 10) | (mantissa >> 13);
+            return static_cast<uint16_t>(result + ((mantissa >> 12) & 1));
+        }
+
+        void buildVocabulary() {
+            _tokens = {"<unk>", "<s>", "</s>"};
+            _types  = {2, 3, 3};
+            for (int i = 0; i < 256; i++) {
+                char name[8];
+                std::snprintf(name, sizeof(name), "<0x%02X>", i);
+                _tokens.push_back(name);
+                _types.push_back(6);
+            }
+            // "\xE2\x96\x81" is U+2581, SentencePiece's word-start marker (split where a hex digit follows)
+            for (const char *word : {"\xE2\x96\x81the", "\xE2\x96\x81" "a", "\xE2\x96\x81" "fix", "\xE2\x96\x81this",
+                                     "\xE2\x96\x81sentence", "\xE2\x96\x81hello", "\xE2\x96\x81world", "he", "ll", "o",
+                                     "\xE2\x96\x81", "th", "e"}) {
+                _tokens.push_back(word);
+                _types.push_back(1);
+            }
+            for (const char *marker : {"<|user|>", "<|system|>", "<|assistant|>"}) {
+                _tokens.push_back(marker);
+                _types.push_back(3);
+            }
+            for (char c = 'a'; c <= 'z'; c++) {
+                _tokens.push_back(std::string(1, c));
+                _types.push_back(1);
+            }
+        }
+
+        void metadata(std::string &out) {
+            auto u32 = [&](const std::string &key, uint32_t value) {
+                putKey(out, key, 4);
+                put<uint32_t>(out, value);
+            };
+            auto str = [&](const std::string &key, const std::string &value) {
+                putKey(out, key, 8);
+                putString(out, value);
+            };
+
+            str("general.architecture", "llama");
+            u32("llama.embedding_length", DIM);
+            u32("llama.feed_forward_length", HIDDEN);
+            u32("llama.attention.head_count", HEADS);
+            u32("llama.attention.head_count_kv", KV_HEADS);
+            u32("llama.block_count", LAYERS);
+            u32("llama.context_length", 512);
+            putKey(out, "llama.attention.layer_norm_rms_epsilon", 6);
+            put<float>(out, 1e-5f);
+            str("tokenizer.ggml.model", "llama");
+
+            putKey(out, "tokenizer.ggml.tokens", 9);
+            put<uint32_t>(out, 8);
+            put<uint64_t>(out, _tokens.size());
+            for (const auto &token : _tokens) {
+                putString(out, token);
+            }
+            putKey(out, "tokenizer.ggml.scores", 9);
+            put<uint32_t>(out, 6);
+            put<uint64_t>(out, _tokens.size());
+            for (std::size_t i = 0; i < _tokens.size(); i++) {
+                put<float>(out, _types[i] == 1 ? -static_cast<float>(i) / 100 : 0.0f);
+            }
+            putKey(out, "tokenizer.ggml.token_type", 9);
+            put<uint32_t>(out, 5);
+            put<uint64_t>(out, _types.size());
+            for (int32_t type : _types) {
+                put<int32_t>(out, type);
+            }
+
+            u32("tokenizer.ggml.bos_token_id", 1);
+            u32("tokenizer.ggml.eos_token_id", 2);
+            str("tokenizer.chat_template", "<|user|>");
+        }
+
+        void addTensors() {
+            uint64_t vocabulary = _tokens.size();
+            add("token_embd.weight", {DIM, vocabulary}, "f32");
+            add("output_norm.weight", {DIM}, "f32", true);
+            for (uint64_t l = 0; l < LAYERS; l++) {
+                std::string prefix = "blk." + std::to_string(l) + ".";
+                add(prefix + "attn_norm.weight", {DIM}, "f32", true);
+                add(prefix + "ffn_norm.weight", {DIM}, "f32", true);
+                add(prefix + "attn_q.weight", {DIM, DIM}, _weightType);
+                add(prefix + "attn_k.weight", {DIM, DIM / HEADS * KV_HEADS}, _weightType);
+                add(prefix + "attn_v.weight", {DIM, DIM / HEADS * KV_HEADS}, _weightType);
+                add(prefix + "attn_output.weight", {DIM, DIM}, _weightType);
+                add(prefix + "ffn_gate.weight", {DIM, HIDDEN}, _weightType);
+                add(prefix + "ffn_up.weight", {DIM, HIDDEN}, _weightType);
+                // Q4_K models usually keep ffn_down in Q6_K
+                add(prefix + "ffn_down.weight", {HIDDEN, DIM}, _weightType == "q4_k" ? "q6_k" : _weightType);
+            }
+        }
+
+        void add(const std::string &name, std::vector<uint64_t> dims, const std::string &type, bool ones = false) {
+            uint64_t count = 1;
+            for (uint64_t dim : dims) {
+                count *= dim;
+            }
+            std::vector<float> values(count, 1.0f);
+            if (!ones) {
+                std::normal_distribution<float> gauss(0.0f, 0.08f);
+                for (float &value : values) {
+                    value = gauss(_random);
+                }
+            }
+            _tensors.push_back({name, std::move(dims), typeId(type), encode(type, values)});
+        }
+
+        static uint32_t typeId(const std::string &type) {
+            return type == "f32" ? 0 : type == "f16" ? 1 : type == "q4_0" ? 2 : type == "q8_0" ? 8 : type == "q4_k" ? 12 : 14;
+        }
+
+        std::string encode(const std::string &type, const std::vector<float> &values) {
+            std::string out;
+            if (type == "f32") {
+                out.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(float));
+            } else if (type == "f16") {
+                for (float value : values) {
+                    put<uint16_t>(out, half(value));
+                }
+            } else if (type == "q8_0") {
+                for (std::size_t i = 0; i < values.size(); i += 32) {
+                    float max = 0;
+                    for (std::size_t j = 0; j < 32; j++) {
+                        max = std::max(max, std::fabs(values[i + j]));
+                    }
+                    float d = max > 0 ? max / 127 : 1;
+                    put<uint16_t>(out, half(d));
+                    for (std::size_t j = 0; j < 32; j++) {
+                        out += static_cast<char>(static_cast<int8_t>(std::lround(values[i + j] / d)));
+                    }
+                }
+            } else if (type == "q4_0") {
+                for (std::size_t i = 0; i < values.size(); i += 32) {
+                    float extreme = 0;
+                    for (std::size_t j = 0; j < 32; j++) {
+                        extreme = std::fabs(values[i + j]) > std::fabs(extreme) ? values[i + j] : extreme;
+                    }
+                    float d = extreme != 0 ? extreme / -8 : 1;
+                    uint8_t q[32];
+                    for (std::size_t j = 0; j < 32; j++) {
+                        q[j] = static_cast<uint8_t>(std::clamp(static_cast<int>(values[i + j] / d + 8.5f), 0, 15));
+                    }
+                    put<uint16_t>(out, half(d));
+                    for (std::size_t j = 0; j < 16; j++) {
+                        out += static_cast<char>(q[j] | (q[j + 16] << 4));
+                    }
+                }
+            } else {
+                // K-quants: random blocks with small scales; only the speed matters here
+                std::uniform_int_distribution<int> byte(0, 255);
+                for (std::size_t i = 0; i < values.size(); i += 256) {
+                    if (type == "q4_k") {
+                        put<uint16_t>(out, half(0.002f));
+                        put<uint16_t>(out, half(0.001f));
+                        for (int j = 0; j < 140; j++) {
+                            out += static_cast<char>(byte(_random));
+                        }
+                    } else {
+                        for (int j = 0; j < 192; j++) {
+                            out += static_cast<char>(byte(_random));
+                        }
+                        for (int j = 0; j < 16; j++) {
+                            out += static_cast<char>(byte(_random) % 16 - 8);
+                        }
+                        put<uint16_t>(out, half(0.001f));
+                    }
+                }
+            }
+            return out;
+        }
+
+        std::string _weightType;
+        std::mt19937 _random{1};
+        std::vector<std::string> _tokens;
+        std::vector<int32_t> _types;
+        std::vector<Tensor> _tensors;
+    };
+
+    struct Result {
+        double coldFirstTokenMs = 0;
+        double warmFirstTokenMs = 0;
+        double tokensPerSecond  = 0;
+        std::size_t tokens      = 0;
+        bool ok                 = true;
+    };
+
+    Result run(const std::filesystem::path &model, int runs) {
+        byoa::LLM::Config config;
+        config.baseURL = std::string(byoa::LocalModel::SCHEME) + model.string();
+
+        std::string userContent;
+        for (int i = 0; i < 15; i++) {
+            userContent += "hello world the sentence ";
+        }
+
+        // Load and page in the weights outside the measured runs
+        byoa::LocalModel::generate(config, "warm up", "hello", nullptr);
+
+        Result result;
+        for (int i = 0; i < runs; i++) {
+            // A different system prompt each run empties the reusable KV prefix
+            auto cold = byoa::LocalModel::generate(config, "fix this sentence " + std::to_string(i), userContent, nullptr);
+            auto warm = byoa::LocalModel::generate(config, "fix this sentence " + std::to_string(i), userContent, nullptr);
+            if (!cold.ok || !warm.ok) {
+                std::fprintf(stderr, "%s: %s\n", model.string().c_str(), (cold.ok ? warm.error : cold.error).c_str());
+                result.ok = false;
+                return result;
+            }
+
+            result.coldFirstTokenMs += cold.firstByteMicros / 1000.0 / runs;
+            result.warmFirstTokenMs += warm.firstByteMicros / 1000.0 / runs;
+            // Tokens after the first, over the time after the first
+            auto decodeMicros = std::max<int64_t>(cold.totalMicros - cold.firstByteMicros, 1);
+            result.tokensPerSecond += (cold.outputTokens > 1 ? (cold.outputTokens - 1) * 1e6 / decodeMicros : 0) / runs;
+            result.tokens = cold.outputTokens;
+        }
+        byoa::LocalModel::unload();
+        return result;
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int runs = DEFAULT_RUNS;
+    std::vector<std::filesystem::path> models;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            models.push_back(arg);
+        }
+    }
+
+    std::vector<std::filesystem::path> generated;
+    if (models.empty()) {
+        for (const char *type : {"f32", "f16", "q8_0", "q4_0", "q4_k"}) {
+            auto path = std::filesystem::temp_directory_path() / (std::string("byoa-tiny-") + type + ".gguf");
+            if (!TinyModel(type).write(path)) {
+                std::fprintf(stderr, "Failed to write %s\n", path.string().c_str());
+                return 1;
+            }
+            generated.push_back(path);
+        }
+        models = generated;
+    }
+
+    std::printf("%d runs per model\n\n", runs);
+    std::printf("%-28s %12s %12s %10s %8s\n", "model", "cold 1st ms", "warm 1st ms", "tok/s", "tokens");
+    int failures = 0;
+    for (const auto &model : models) {
+        auto result = run(model, runs);
+        if (!result.ok) {
+            failures++;
+            continue;
+        }
+        std::printf("%-28s %12.2f %12.2f %10.0f %8zu\n", model.filename().string().c_str(), result.coldFirstTokenMs,
+                    result.warmFirstTokenMs, result.tokensPerSecond, result.tokens);
+    }
+
+    for (const auto &path : generated) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return failures ? 1 : 0;
+}
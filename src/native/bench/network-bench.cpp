@@ -0,0 +1,230 @@
+// Heap allocations and round-trip latency per fetch against a local stand-in server
+// (scripts/stand-in-server.js).
+//
+// Each http(s) URL is fetched both through Network::fetch (request arena, SAX options, callbacks
+// writing into pre-sized buffers) and through a copy of the fetch path as it was before the arena
+// (JSON DOM options, std::map headers, cpr::Response copies, DOM response), so the difference is
+// the before/after of the arena change. unix:<socket>:<path> URLs only exist on the new path; give
+// one next to the http://127.0.0.1 URL of the same server to compare a Unix socket with loopback TCP.
+//
+// Usage: network-bench [--iterations N] <url>...
+// e.g.   node scripts/stand-in-server.js --socket /tmp/byoa-stand-in.sock &
+//        network-bench http://127.0.0.1:8788/v1/chat/completions unix:/tmp/byoa-stand-in.sock:/v1/chat/completions
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cpr/cpr.h>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "logger.hpp"
+#include "network.hpp"
+
+namespace {
+
+    std::atomic<std::size_t> allocations{0};
+    std::atomic<std::size_t> allocatedBytes{0};
+
+} // namespace
+
+// Count every operator new; curl's own mallocs are the same on both paths and not counted
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+    using json = nlohmann::json;
+
+    constexpr int DEFAULT_ITERATIONS = 200;
+    constexpr int WARMUP             = 5;
+
+    /**
+     * @brief The fetch path before the request arena, kept as the baseline to compare against
+     */
+    namespace legacy {
+
+        struct FetchOptions {
+            std::string method = "GET";
+            std::map<std::string, std::string> headers;
+            std::string body;
+        };
+
+        struct FetchResponse {
+            int status = 0;
+            std::string statusText;
+            std::map<std::string, std::string> headers;
+            std::string body;
+            bool ok = false;
+        };
+
+        FetchOptions parseOptions(const std::string &optionsJson) {
+            FetchOptions options;
+            json j = json::parse(optionsJson);
+            if (j.contains("method") && j["method"].is_string()) {
+                options.method = j["method"].get<std::string>();
+            }
+            if (j.contains("headers") && j["headers"].is_object()) {
+                for (auto &[key, value] : j["headers"].items()) {
+                    if (value.is_string()) {
+                        options.headers[key] = value.get<std::string>();
+                    }
+                }
+            }
+            if (j.contains("body") && j["body"].is_string()) {
+                options.body = j["body"].get<std::string>();
+            }
+            return options;
+        }
+
+        std::string responseToJson(const FetchResponse &response) {
+            json j;
+            j["status"]     = response.status;
+            j["statusText"] = response.statusText;
+            j["ok"]         = response.ok;
+            j["headers"]    = response.headers;
+            j["body"]       = response.body;
+            return j.dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+
+        std::string fetch(const std::string &url, const std::string &optionsJson) {
+            FetchOptions options = parseOptions(optionsJson);
+            Logger::getInstance().info("Network::fetchImpl: Method: {}", options.method);
+
+            cpr::Session session;
+            session.SetUrl(cpr::Url{url});
+
+            cpr::Header headers;
+            for (const auto &[key, value] : options.headers) {
+                headers[key] = value;
+                Logger::getInstance().info("Network::fetchImpl: Header: {} = {}", key, value);
+            }
+            if (!headers.empty()) {
+                session.SetHeader(headers);
+            }
+            session.SetTimeout(cpr::Timeout{30000});
+            if (!options.body.empty()) {
+                session.SetBody(cpr::Body{options.body});
+            }
+
+            cpr::Response r = options.method == "POST" ? session.Post() : session.Get();
+
+            FetchResponse response;
+            response.status     = static_cast<int>(r.status_code);
+            response.statusText = r.status_line;
+            response.body       = r.text;
+            response.ok         = (r.status_code >= 200 && r.status_code < 300);
+            for (const auto &[key, value] : r.header) {
+                response.headers[key] = value;
+            }
+            return responseToJson(response);
+        }
+
+    } // namespace legacy
+
+    struct Result {
+        double allocationsPerRequest = 0;
+        double bytesPerRequest       = 0;
+        double p50Micros             = 0;
+        double meanMicros            = 0;
+        int failures                 = 0;
+    };
+
+    template <typename Fetch>
+    Result run(Fetch fetch, int iterations) {
+        Result result;
+        for (int i = 0; i < WARMUP; i++) {
+            fetch();
+        }
+
+        std::vector<double> micros;
+        micros.reserve(iterations);
+        auto allocationsBefore = allocations.load();
+        auto bytesBefore       = allocatedBytes.load();
+        for (int i = 0; i < iterations; i++) {
+            auto started  = std::chrono::steady_clock::now();
+            auto response = fetch();
+            micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count());
+            if (response.find(R"("ok":true)") == std::string::npos) {
+                result.failures++;
+            }
+        }
+
+        result.allocationsPerRequest = static_cast<double>(allocations.load() - allocationsBefore) / iterations;
+        result.bytesPerRequest       = static_cast<double>(allocatedBytes.load() - bytesBefore) / iterations;
+        std::sort(micros.begin(), micros.end());
+        result.p50Micros = micros[micros.size() / 2];
+        for (double value : micros) {
+            result.meanMicros += value / iterations;
+        }
+        return result;
+    }
+
+    void print(const std::string &path, const std::string &url, const Result &result) {
+        fmt::print("{:<10} {:>12.1f} {:>12.0f} {:>10.0f} {:>10.0f} {:>6}  {}\n", path, result.allocationsPerRequest,
+                   result.bytesPerRequest, result.p50Micros, result.meanMicros, result.failures, url);
+    }
+
+    std::string chatRequestOptions() {
+        json request = {
+            {"model", "stand-in"},
+            {"messages",
+             {{{"role", "system"}, {"content", std::string(512, 's')}}, {{"role", "user"}, {"content", std::string(1024, 'u')}}}},
+        };
+        json options = {
+            {"method", "POST"},
+            {"headers", {{"Content-Type", "application/json"}, {"Authorization", "Bearer stand-in"}}},
+            {"body", request.dump()},
+        };
+        return options.dump();
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int iterations = DEFAULT_ITERATIONS;
+    std::vector<std::string> urls;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else {
+            urls.push_back(arg);
+        }
+    }
+    if (urls.empty()) {
+        fmt::print(stderr, "Usage: network-bench [--iterations N] <url>...\n");
+        return 1;
+    }
+
+    const std::string options = chatRequestOptions();
+    fmt::print("{} requests per path, {} byte request options\n\n", iterations, options.size());
+    fmt::print("{:<10} {:>12} {:>12} {:>10} {:>10} {:>6}  {}\n", "path", "allocs/req", "bytes/req", "p50 us", "mean us", "fail",
+               "url");
+
+    for (const auto &url : urls) {
+        if (!url.starts_with("unix:")) {
+            print("pre-arena", url, run([&] { return legacy::fetch(url, options); }, iterations));
+        }
+        print("arena", url, run([&] { return byoa::Network::fetch(url, options); }, iterations));
+    }
+    return 0;
+}
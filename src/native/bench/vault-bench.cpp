@@ -0,0 +1,131 @@
+// Set and get throughput and latency of the Vault backends.
+//
+// The memory store and an encrypted file in the temp directory are always measured. The OS
+// credential store only with --keychain, since it may prompt; it then uses its own service name,
+// so the app's entries are never touched, and deletes what it wrote.
+//
+// Usage: vault-bench [--iterations N] [--value-bytes N] [--keychain]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "crypto.hpp"
+#include "vault-backend.hpp"
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t DEFAULT_ITERATIONS  = 1000;
+    constexpr std::size_t DEFAULT_VALUE_BYTES = 256;
+    constexpr const char *KEYCHAIN_PACKAGE    = "com.byoa.assistant";
+    constexpr const char *KEYCHAIN_SERVICE    = "vault-bench";
+
+    struct Summary {
+        double opsPerSec = 0;
+        int64_t p50Us    = 0;
+        int64_t p99Us    = 0;
+    };
+
+    Summary summarize(std::vector<int64_t> &micros, Clock::duration total) {
+        std::sort(micros.begin(), micros.end());
+        auto at = [&](double fraction) {
+            return micros.empty() ? 0 : micros[std::min(micros.size() - 1, static_cast<std::size_t>(fraction * micros.size()))];
+        };
+        auto seconds = std::chrono::duration<double>(total).count();
+        return {seconds > 0 ? micros.size() / seconds : 0.0, at(0.50), at(0.99)};
+    }
+
+    void print(const char *backend, const char *operation, const Summary &summary) {
+        std::printf("%-14s %-4s %12.0f %10lld %10lld\n", backend, operation, summary.opsPerSec, static_cast<long long>(summary.p50Us),
+                    static_cast<long long>(summary.p99Us));
+    }
+
+    // Time @p iterations sets, then as many gets, and delete the keys again
+    std::size_t run(byoa::VaultBackend &backend, std::size_t iterations, std::size_t valueBytes) {
+        std::vector<std::string> keys;
+        for (std::size_t i = 0; i < iterations; i++) {
+            keys.push_back("__benchmark_" + std::to_string(i));
+        }
+        std::string value(valueBytes, 'x');
+
+        auto measure = [&](auto &&operation) {
+            std::vector<int64_t> micros;
+            micros.reserve(iterations);
+            auto started = Clock::now();
+            for (const auto &key : keys) {
+                auto before = Clock::now();
+                operation(key);
+                micros.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - before).count());
+            }
+            return summarize(micros, Clock::now() - started);
+        };
+
+        using Status         = byoa::VaultBackend::Status;
+        std::size_t failures = 0;
+        auto set             = measure([&](const std::string &key) { failures += backend.set(key, value).status != Status::OK; });
+        auto get             = measure([&](const std::string &key) { failures += backend.get(key).status != Status::OK; });
+        for (const auto &key : keys) {
+            backend.remove(key);
+        }
+
+        print(backend.name(), "set", set);
+        print(backend.name(), "get", get);
+        return failures;
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t iterations = DEFAULT_ITERATIONS;
+    std::size_t valueBytes = DEFAULT_VALUE_BYTES;
+    bool keychain          = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--value-bytes" && i + 1 < argc) {
+            valueBytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--keychain") {
+            keychain = true;
+        } else {
+            std::fprintf(stderr, "Usage: vault-bench [--iterations N] [--value-bytes N] [--keychain]\n");
+            return 1;
+        }
+    }
+
+    std::printf("%zu operations of %zu bytes per backend\n\n", iterations, valueBytes);
+    std::printf("%-14s %-4s %12s %10s %10s\n", "backend", "op", "ops/s", "p50 us", "p99 us");
+
+    std::size_t failures = 0;
+    auto memory          = byoa::VaultBackend::memory();
+    failures += run(*memory, iterations, valueBytes);
+
+    auto path = std::filesystem::temp_directory_path() / "byoa-vault-bench.bin";
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    if (auto file = byoa::VaultBackend::encryptedFile(path, byoa::Crypto::randomBytes(32))) {
+        failures += run(*file, iterations, valueBytes);
+    } else {
+        std::fprintf(stderr, "Failed to create %s\n", path.string().c_str());
+        failures++;
+    }
+    std::filesystem::remove(path, ec);
+
+    if (keychain) {
+        auto store = byoa::VaultBackend::keychain(KEYCHAIN_PACKAGE, KEYCHAIN_SERVICE);
+        failures += run(*store, iterations, valueBytes);
+    }
+
+    if (failures) {
+        std::printf("\n%zu operations failed\n", failures);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <filesystem>
+
+namespace byoa {
+
+    /**
+     * @brief Per-user locations for files the app persists between launches
+     */
+    class AppPaths {
+      public:
+        /**
+         * @brief Application data directory, created on first use
+         *
+         * ~/Library/Application Support/com.byoa.assistant on macOS,
+         * %APPDATA%\BYOA on Windows and $XDG_DATA_HOME/byoa elsewhere.
+         */
+        static std::filesystem::path dataDir();
+    };
+
+} // namespace byoa
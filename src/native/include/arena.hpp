@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+namespace byoa {
+
+    /**
+     * @brief Request-scoped monotonic allocator
+     *
+     * Serves every allocation of a single request/response lifecycle from an
+     * inline buffer first and from geometrically growing upstream blocks after
+     * that. Individual deallocations are no-ops; everything is released at once
+     * when the arena goes out of scope, so containers built on it must not
+     * outlive it.
+     */
+    class RequestArena {
+      public:
+        /**
+         * @brief Allocation counters, used to log the per-request footprint
+         */
+        struct Stats {
+            std::size_t upstreamAllocations = 0;
+            std::size_t upstreamBytes       = 0;
+        };
+
+        RequestArena();
+
+        // The inline buffer is referenced by the monotonic resource
+        RequestArena(const RequestArena &)            = delete;
+        RequestArena &operator=(const RequestArena &) = delete;
+
+        /**
+         * @brief Memory resource to hand to std::pmr containers
+         */
+        std::pmr::memory_resource *resource();
+
+        /**
+         * @brief Number and size of the blocks requested from the heap so far
+         */
+        Stats stats() const;
+
+      private:
+        /**
+         * @brief Pass-through to the default resource that counts what it hands out
+         */
+        class CountingResource : public std::pmr::memory_resource {
+          public:
+            Stats stats;
+
+          private:
+            void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+        };
+
+        static constexpr std::size_t INLINE_SIZE = 8 * 1024;
+
+        alignas(std::max_align_t) std::array<std::byte, INLINE_SIZE> _inline;
+        CountingResource _upstream;
+        std::pmr::monotonic_buffer_resource _resource;
+    };
+
+} // namespace byoa
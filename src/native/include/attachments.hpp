@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace byoa {
+
+    /**
+     * @brief Native store for large request payloads referenced by handle
+     *
+     * Clipboard images and large texts are captured here and only their handle
+     * crosses the bridge. Network splices them into request bodies when the
+     * fetch options reference them through "bodyParts".
+     */
+    class Attachments {
+      public:
+        /**
+         * @brief How an attachment is written into a request body
+         */
+        enum class Encoding {
+            RAW,      // bytes as-is
+            JSON,     // JSON string escaped (without quotes)
+            BASE64,   // plain base64
+            DATA_URL, // data:<mimeType>;base64,<...>
+        };
+
+        struct Attachment {
+            std::string mimeType;
+            std::string data;
+        };
+
+        /**
+         * @brief Take ownership of a payload and return its handle
+         */
+        static std::string put(std::string mimeType, std::string data);
+
+        /**
+         * @brief Look up an attachment by handle
+         *
+         * @return The attachment, or nullptr if the handle is unknown or was evicted
+         */
+        static std::shared_ptr<const Attachment> get(const std::string &handle);
+
+        /**
+         * @brief Drop an attachment
+         *
+         * @return true if the handle existed
+         */
+        static bool release(const std::string &handle);
+
+        /**
+         * @brief Parse an encoding name ("raw", "json", "base64", "dataUrl")
+         */
+        static std::optional<Encoding> parseEncoding(std::string_view name);
+
+        /**
+         * @brief Exact number of bytes @p attachment occupies in a body with @p encoding
+         */
+        static std::size_t encodedLength(const Attachment &attachment, Encoding encoding);
+
+        /**
+         * @brief Write @p attachment into @p out using @p encoding
+         *
+         * @return Pointer one past the last byte written
+         */
+        static char *write(char *out, const Attachment &attachment, Encoding encoding);
+
+      private:
+        // Oldest attachments are evicted once the store holds more than this
+        static constexpr std::size_t MAX_TOTAL_BYTES = 64 * 1024 * 1024;
+    };
+
+} // namespace byoa
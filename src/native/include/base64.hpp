@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+namespace byoa {
+
+    /**
+     * @brief Base64 encoder writing into caller-provided buffers
+     *
+     * Uses a NEON table-lookup kernel on ARM64 (48 input bytes per iteration),
+     * an SSSE3 kernel on x86-64 CPUs that have it (12 bytes per iteration) and a
+     * 12-bit lookup table elsewhere, so large attachments can be encoded
+     * straight into a pre-sized request body.
+     */
+    class Base64 {
+      public:
+        /**
+         * @brief Size of the padded encoding of @p length input bytes
+         */
+        static constexpr std::size_t encodedLength(std::size_t length) {
+            return ((length + 2) / 3) * 4;
+        }
+
+        /**
+         * @brief Encode @p length bytes from @p input into @p out
+         *
+         * @p out must have room for encodedLength(length) bytes.
+         * @return Pointer one past the last byte written
+         */
+        static char *encode(char *out, const unsigned char *input, std::size_t length);
+    };
+
+} // namespace byoa
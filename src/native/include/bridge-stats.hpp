@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace byoa {
+
+    /**
+     * @brief Call counts, in-flight gauges, latency and payload size histograms per exposed bridge function
+     *
+     * Latency runs from the native handler being invoked to its task completing.
+     * The call path only does relaxed atomic increments into fixed log2 buckets
+     * (no locks, no allocation), so the stats stay on in release builds.
+     */
+    class BridgeStats {
+      public:
+        /**
+         * @brief Log2 histogram: bucket i counts values in [2^(i-1), 2^i), bucket 0 counts zeros
+         */
+        class Histogram {
+          public:
+            static constexpr std::size_t BUCKETS = 40;
+
+            void record(uint64_t value);
+
+            /**
+             * @brief {count, avg, p50, p90, p99, max}; percentiles are bucket upper bounds, capped at max
+             */
+            nlohmann::json summary() const;
+
+          private:
+            std::array<std::atomic<uint64_t>, BUCKETS> _buckets{};
+            std::atomic<uint64_t> _total{0};
+            std::atomic<uint64_t> _max{0};
+        };
+
+        class Function {
+          public:
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * @brief Count a call starting with @p argumentBytes of arguments
+             */
+            Clock::time_point begin(std::size_t argumentBytes);
+
+            void end(Clock::time_point started, std::size_t resultBytes, bool failed = false);
+
+            uint64_t calls() const {
+                return _calls.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief {calls, inFlight, failed, latencyUs, argumentBytes, resultBytes}
+             */
+            nlohmann::json summary() const;
+
+          private:
+            std::atomic<uint64_t> _calls{0};
+            std::atomic<int64_t> _inFlight{0};
+            std::atomic<uint64_t> _failed{0};
+            Histogram _latencyMicros;
+            Histogram _argumentBytes;
+            Histogram _resultBytes;
+        };
+
+        /**
+         * @brief Stats of the function exposed as @p name, created on first use; the reference stays valid
+         */
+        static Function &function(const std::string &name);
+
+        /**
+         * @brief {name: Function::summary()} for every function called at least once
+         */
+        static std::string statsJson();
+
+        /**
+         * @brief Log a summary every BYOA_BRIDGE_STATS_SECONDS (default 300, 0 disables) while there are new calls
+         */
+        static void configureFromEnvironment();
+
+      private:
+        struct State;
+        static State &state();
+
+        static void logSummary();
+    };
+
+} // namespace byoa
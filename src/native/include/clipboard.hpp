@@ -26,6 +26,10 @@ class Clipboard {
     // Reads a string from the macOS clipboard
     static std::string readText();
 
+    // Reads an image from the clipboard as PNG bytes,
+    // or an empty string if the clipboard does not contain one
+    static std::string readImage();
+
     // Clears the clipboard
     static void clear();
 
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "vault.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Local store for non-secret settings (LLM configs, actions, theme)
+     *
+     * Settings live in one versioned binary file in the app data dir. On first
+     * use it is mapped and decoded once into a hash map, which serves every
+     * read afterwards. Every write bumps the revision and replaces the file
+     * atomically (flushed temporary file and rename, directory flushed too),
+     * keeping the previous generation as a ".bak" file. A file a crash left
+     * empty or undecodable is treated as corrupt and the backup loaded instead.
+     *
+     * API keys don't belong in a plain file: "llm_configs" is split on write,
+     * with each config's keys stored in Vault as one "llm_secrets:<id>" item
+     * and merged back on read, so callers always see complete configs.
+     */
+    class ConfigStore {
+      public:
+        using Values = Vault::Values;
+
+        /**
+         * @brief Keys the web frontend keeps here, returned by snapshot()
+         */
+        static constexpr std::array<const char *, 3> SNAPSHOT_KEYS = {"llm_configs", "actions", "theme"};
+
+        /**
+         * @brief Value of @p key, or std::nullopt if not set
+         */
+        static std::optional<std::string> get(const std::string &key);
+
+        /**
+         * @brief Set @p key and persist
+         *
+         * @return true if the file (and any API keys) were written
+         */
+        static bool set(const std::string &key, const std::string &value);
+
+        /**
+         * @brief Remove @p key and persist
+         */
+        static bool remove(const std::string &key);
+
+        /**
+         * @brief get() for several keys; missing ones map to std::nullopt
+         */
+        static Values getMany(const std::vector<std::string> &keys);
+
+        /**
+         * @brief set() for several keys with a single file write
+         */
+        static bool setMany(const std::map<std::string, std::string> &values);
+
+        /**
+         * @brief getMany() over SNAPSHOT_KEYS
+         */
+        static Values snapshot();
+
+        /**
+         * @brief Revision of the stored settings, bumped by every write and kept across launches
+         */
+        static uint64_t revision();
+
+        /**
+         * @brief Move settings saved by older versions out of Vault (one time, on first launch with the store)
+         */
+        static void migrateFromVault();
+
+      private:
+        static constexpr const char *FILE_NAME       = "settings.bin";
+        static constexpr const char *BACKUP_SUFFIX   = ".bak";
+        static constexpr uint32_t FORMAT_VERSION     = 1;
+        static constexpr const char *LLM_CONFIGS_KEY = "llm_configs";
+        static constexpr const char *SECRETS_PREFIX  = "llm_secrets:";
+
+        struct Store;
+        static Store &store();
+
+        /**
+         * @brief Value of @p key as written to the file, without API keys
+         */
+        static std::optional<std::string> stored(const std::string &key);
+
+        /**
+         * @brief Apply @p values (std::nullopt removes) and write the file
+         */
+        static bool commit(const Values &values);
+
+        /**
+         * @brief Move API keys out of an llm_configs array into Vault (as deferred writes)
+         *
+         * @return The configs without keys, or std::nullopt if Vault refused the keys because its store can't be used
+         */
+        static std::optional<std::string> storeSecrets(const std::string &configsJson, const std::optional<std::string> &previous);
+
+        /**
+         * @brief Fill the API keys of a stored llm_configs array back in from Vault
+         */
+        static std::string loadSecrets(const std::string &configsJson);
+    };
+
+} // namespace byoa
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <memory>
+#include <string>
+
+namespace byoa {
+
+    /**
+     * @brief TLS session and DNS cache shared by all requests and persisted across launches
+     *
+     * Every transfer is attached to one curl share handle holding TLS sessions
+     * and resolved addresses. On shutdown the still-valid sessions and the
+     * addresses of recently used hosts are written to connection-cache.json in
+     * the app data dir; the next launch imports them so its first request can
+     * skip the DNS lookup and resume the TLS session instead of doing a full
+     * handshake. Expired entries are dropped on both load and save.
+     */
+    class ConnectionCache {
+      public:
+        using ResolveList = std::unique_ptr<curl_slist, void (*)(curl_slist *)>;
+
+        /**
+         * @brief Create the share handle and import the cache file (call once at startup)
+         */
+        static void load();
+
+        /**
+         * @brief Export the current TLS sessions and addresses to the cache file
+         */
+        static void save();
+
+        /**
+         * @brief Attach @p handle to the shared caches before a transfer to @p url
+         *
+         * @return Persisted addresses for the host, which must outlive the transfer
+         */
+        static ResolveList attach(CURL *handle, const std::string &url);
+
+        /**
+         * @brief Remember the address @p handle connected to for @p url after a direct (unproxied) transfer
+         */
+        static void record(CURL *handle, const std::string &url);
+    };
+
+} // namespace byoa
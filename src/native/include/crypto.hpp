@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace byoa {
+
+    /**
+     * @brief The few primitives the encrypted vault file needs
+     *
+     * SHA-256/HMAC/PBKDF2 (FIPS 180-4, RFC 2104, RFC 8018) derive the file key
+     * from a local secret, and ChaCha20-Poly1305 (RFC 8439) seals the contents.
+     * Kept in-tree because the TLS library differs per platform, so there is no
+     * crypto library every build links.
+     */
+    class Crypto {
+      public:
+        using Key    = std::array<uint8_t, 32>;
+        using Nonce  = std::array<uint8_t, 12>;
+        using Digest = std::array<uint8_t, 32>;
+
+        static constexpr std::size_t TAG_SIZE = 16;
+
+        static Digest sha256(std::string_view data);
+
+        static Digest hmacSha256(std::string_view key, std::string_view data);
+
+        /**
+         * @brief PBKDF2-HMAC-SHA256 with a 32-byte output
+         */
+        static Key pbkdf2(std::string_view secret, std::string_view salt, uint32_t iterations);
+
+        /**
+         * @brief Encrypt and authenticate @p plaintext, and authenticate @p aad
+         *
+         * @return Ciphertext followed by the 16-byte tag
+         */
+        static std::string seal(const Key &key, const Nonce &nonce, std::string_view aad, std::string_view plaintext);
+
+        /**
+         * @brief Reverse of seal()
+         *
+         * @return The plaintext, or std::nullopt if the tag does not match
+         */
+        static std::optional<std::string> open(const Key &key, const Nonce &nonce, std::string_view aad, std::string_view sealed);
+
+        /**
+         * @brief @p count bytes from the OS random source
+         */
+        static std::string randomBytes(std::size_t count);
+    };
+
+} // namespace byoa
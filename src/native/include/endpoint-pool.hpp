@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "llm.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Balances requests for one logical model over its (endpoint, key) pool
+     *
+     * The members of a config are its primary endpoint plus LLM::Config::pool.
+     * Selection follows the config's poolPolicy:
+     * - "round-robin" (default) cycles through the members;
+     * - "least-outstanding" picks the member with the fewest requests in flight;
+     * - "ewma-latency" picks the member with the lowest exponentially weighted latency.
+     *
+     * Members are ejected after repeated failures or a 429, for a backoff that
+     * doubles with every ejection, and are only picked while ejected when every
+     * member is. Per-member counters are exposed through statsJson().
+     */
+    class EndpointPool {
+      public:
+        enum class Policy {
+            ROUND_ROBIN,
+            LEAST_OUTSTANDING,
+            EWMA_LATENCY,
+        };
+
+        /**
+         * @brief A selected member; must be handed back to release()
+         */
+        struct Lease {
+            std::string poolKey;
+            // Members the pool had when this was handed out; release() ignores leases from an older pool
+            uint64_t membership = 0;
+            std::size_t member  = 0;
+            LLM::Endpoint endpoint;
+            std::chrono::steady_clock::time_point started;
+        };
+
+        static Policy parsePolicy(const std::string &policy);
+
+        /**
+         * @brief Pick a member of @p config's pool for the next request
+         */
+        static Lease acquire(const LLM::Config &config);
+
+        /**
+         * @brief Report the outcome of a request made with @p lease
+         *
+         * @param status HTTP status, 0 for transport errors
+         */
+        static void release(const Lease &lease, int status);
+
+        /**
+         * @brief Per-member metrics of every pool as a JSON string
+         */
+        static std::string statsJson();
+
+      private:
+        static constexpr double EWMA_ALPHA                 = 0.3;
+        static constexpr int FAILURES_BEFORE_EJECTION      = 3;
+        static constexpr std::chrono::seconds BASE_EJECTION = std::chrono::seconds(10);
+        static constexpr std::chrono::seconds MAX_EJECTION  = std::chrono::minutes(5);
+    };
+
+} // namespace byoa
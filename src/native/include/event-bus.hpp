@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "event-registry.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Routes events to the webviews that listen for them
+     *
+     * Each webview attaches an endpoint and tells the bus which events its
+     * page has listeners for (the page does so as listeners come and go).
+     * An event reaches only the endpoints subscribed to it; one nobody listens
+     * for is dropped before any script is built or evaluated.
+     *
+     * Until its page has started and sent its whole subscription set with
+     * resubscribe(), an endpoint holds the events published to it (the newest
+     * HELD_LIMIT), and delivers the ones the page listens for in order then.
+     * A new page load puts it back in that state with reset().
+     */
+    class EventBus {
+      public:
+        static constexpr std::size_t HELD_LIMIT = 64;
+
+        /**
+         * @brief Hands an event to a webview (its EventQueue); called with the bus locked, so it must not block
+         */
+        using Deliver = std::function<void(EventId id, std::string data)>;
+
+        /**
+         * @return Endpoint id for subscribe(), send() and detach()
+         */
+        static uint64_t attach(Deliver deliver);
+
+        /**
+         * @brief Stop delivering to @p endpoint; no delivery is running once this returns
+         */
+        static void detach(uint64_t endpoint);
+
+        static void subscribe(uint64_t endpoint, EventId id, bool listening);
+
+        /**
+         * @brief Replace the subscriptions of @p endpoint with @p ids and deliver what it held for them
+         */
+        static void resubscribe(uint64_t endpoint, const std::vector<EventId> &ids);
+
+        /**
+         * @brief The page of @p endpoint is being replaced: drop its subscriptions and hold events until resubscribe()
+         */
+        static void reset(uint64_t endpoint);
+
+        /**
+         * @brief Deliver @p data to every endpoint subscribed to @p id
+         *
+         * @return Number of endpoints it was delivered to
+         */
+        static std::size_t publish(EventId id, const std::string &data);
+
+        /**
+         * @brief Deliver @p data to @p endpoint only, if it is subscribed to @p id
+         */
+        static bool send(uint64_t endpoint, EventId id, const std::string &data);
+
+        template <typename Event>
+        static std::size_t publish(const Event &event) {
+            // Checked first so an event nobody listens for isn't even serialized
+            return unheard(0, Event::ID) ? 0 : publish(Event::ID, event.json());
+        }
+
+        template <typename Event>
+        static bool send(uint64_t endpoint, const Event &event) {
+            return !unheard(endpoint, Event::ID) && send(endpoint, Event::ID, event.json());
+        }
+
+        /**
+         * @brief Per-event published/delivered/held/dropped counts and each endpoint's subscriptions, as JSON
+         */
+        static std::string statsJson();
+
+      private:
+        struct State;
+        static State &state();
+
+        /**
+         * @brief Whether nothing listens for @p id at @p endpoint (0: at any endpoint); counts the drop if so
+         */
+        static bool unheard(uint64_t endpoint, EventId id);
+    };
+
+} // namespace byoa
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace byoa {
+
+    /**
+     * @brief Batches native-to-webview events into one script per frame
+     *
+     * push() only appends to the queue. A delivery thread turns everything
+     * queued into a single script calling window.__nativeCallback once per
+     * event, in order, and hands it to the sink at most once per interval.
+     * An event arriving after a quiet period goes out at once; a burst of
+     * streaming deltas goes out ~60 times a second however many arrive.
+     */
+    class EventQueue {
+      public:
+        /**
+         * @brief Runs a script in the webview without waiting for it
+         */
+        using Sink = std::function<void(std::string script)>;
+
+        static constexpr std::chrono::milliseconds FRAME{16};
+
+        explicit EventQueue(Sink sink, std::chrono::milliseconds interval = FRAME);
+
+        /**
+         * @brief Deliver what is still queued, then stop the delivery thread
+         */
+        ~EventQueue();
+
+        EventQueue(const EventQueue &)            = delete;
+        EventQueue &operator=(const EventQueue &) = delete;
+
+        /**
+         * @brief Queue @p data (JSON text, or any string) for the "@p name" listeners
+         */
+        void push(std::string name, std::string data);
+
+        /**
+         * @brief Current and peak depth, batch sizes and bytes delivered, as JSON
+         */
+        std::string statsJson();
+
+        /**
+         * @brief The script delivering @p events, built with a single allocation
+         */
+        static std::string script(const std::vector<std::pair<std::string, std::string>> &events);
+
+      private:
+        void loop();
+
+        Sink _sink;
+        std::chrono::milliseconds _interval;
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::vector<std::pair<std::string, std::string>> _queue;
+        bool _stopping = false;
+
+        uint64_t _events       = 0;
+        uint64_t _batches      = 0;
+        uint64_t _bytes        = 0;
+        std::size_t _maxQueued = 0;
+        std::size_t _maxBatch  = 0;
+
+        // Last, so the thread starts after everything it uses
+        std::thread _thread;
+    };
+
+} // namespace byoa
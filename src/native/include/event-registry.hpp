@@ -0,0 +1,207 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace byoa {
+
+    /**
+     * @brief Every event exchanged with the webviews; mirrors EventMap in src/web/utils/events.ts
+     *
+     * The order matches EventRegistry::TYPES, which is checked at compile time.
+     * Events raised by the webviews come first, then the ones raised natively.
+     */
+    enum class EventId : uint8_t {
+        SETTINGS_THEME_CHANGED,
+        SETTINGS_LLM_CONFIGS_CHANGED,
+        SETTINGS_ACTIONS_CHANGED,
+        SETTINGS_LLM_ENABLED_CHANGED,
+        SETTINGS_ACTION_ENABLED_CHANGED,
+        ASSISTANT_REQUEST_REFRESH,
+        ASSISTANT_CLIPBOARD_CHANGED,
+        NETWORK_WS_DELTA,
+        PIPELINE_PROGRESS,
+        SETTINGS_PATCH,
+        APP_FOCUS_CHANGED,
+        VAULT_STATUS,
+        COUNT,
+    };
+
+    namespace events {
+
+        // Raised by one webview for the other; native code only routes them. event_trigger checks
+        // that a payload is a JSON object, but its fields are typed on the TypeScript side only.
+
+        struct ThemeChanged {
+            static constexpr EventId ID            = EventId::SETTINGS_THEME_CHANGED;
+            static constexpr std::string_view NAME = "settings:theme-changed";
+        };
+
+        struct LlmConfigsChanged {
+            static constexpr EventId ID            = EventId::SETTINGS_LLM_CONFIGS_CHANGED;
+            static constexpr std::string_view NAME = "settings:llm-configs-changed";
+        };
+
+        struct ActionsChanged {
+            static constexpr EventId ID            = EventId::SETTINGS_ACTIONS_CHANGED;
+            static constexpr std::string_view NAME = "settings:actions-changed";
+        };
+
+        struct LlmEnabledChanged {
+            static constexpr EventId ID            = EventId::SETTINGS_LLM_ENABLED_CHANGED;
+            static constexpr std::string_view NAME = "settings:llm-enabled-changed";
+        };
+
+        struct ActionEnabledChanged {
+            static constexpr EventId ID            = EventId::SETTINGS_ACTION_ENABLED_CHANGED;
+            static constexpr std::string_view NAME = "settings:action-enabled-changed";
+        };
+
+        struct RequestRefresh {
+            static constexpr EventId ID            = EventId::ASSISTANT_REQUEST_REFRESH;
+            static constexpr std::string_view NAME = "assistant:request-refresh";
+        };
+
+        struct ClipboardChanged {
+            static constexpr EventId ID            = EventId::ASSISTANT_CLIPBOARD_CHANGED;
+            static constexpr std::string_view NAME = "assistant:clipboard-changed";
+        };
+
+        // Raised natively; json() gives the payload EventMap expects
+
+        /**
+         * @brief { requestId: string; message: string }
+         */
+        struct WsDelta {
+            static constexpr EventId ID            = EventId::NETWORK_WS_DELTA;
+            static constexpr std::string_view NAME = "network:ws-delta";
+
+            std::string_view requestId;
+            std::string_view message;
+
+            std::string json() const;
+        };
+
+        /**
+         * @brief { runId: string; stage: number; delta: string; done: boolean }
+         */
+        struct PipelineProgress {
+            static constexpr EventId ID            = EventId::PIPELINE_PROGRESS;
+            static constexpr std::string_view NAME = "pipeline:progress";
+
+            std::string_view runId;
+            std::size_t stage;
+            std::string_view delta;
+            bool done;
+
+            std::string json() const;
+        };
+
+        /**
+         * @brief { version: number; patch: PatchOperation[] }, already serialized by SharedSettings
+         */
+        struct SettingsPatch {
+            static constexpr EventId ID            = EventId::SETTINGS_PATCH;
+            static constexpr std::string_view NAME = "settings:patch";
+
+            std::string_view delta;
+
+            std::string json() const {
+                return std::string(delta);
+            }
+        };
+
+        /**
+         * @brief { focused: boolean }
+         */
+        struct FocusChanged {
+            static constexpr EventId ID            = EventId::APP_FOCUS_CHANGED;
+            static constexpr std::string_view NAME = "app:focus-changed";
+
+            bool focused;
+
+            std::string json() const {
+                return focused ? R"({"focused":true})" : R"({"focused":false})";
+            }
+        };
+
+        /**
+         * @brief { pending: number; failed: Record<string, string>; unavailable?: string }, serialized by Vault::statusJson()
+         */
+        struct VaultStatus {
+            static constexpr EventId ID            = EventId::VAULT_STATUS;
+            static constexpr std::string_view NAME = "vault:status";
+
+            std::string_view status;
+
+            std::string json() const {
+                return std::string(status);
+            }
+        };
+
+    } // namespace events
+
+    namespace detail {
+
+        template <typename... Events>
+        constexpr std::array<std::string_view, sizeof...(Events)> eventTable() {
+            std::size_t index = 0;
+            // Each type's id must be its position, so ids index the table directly
+            bool ordered = ((static_cast<std::size_t>(Events::ID) == index++) && ...);
+            if (!ordered) {
+                throw "EventId order does not match the event table";
+            }
+            return {Events::NAME...};
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Compile-time table from EventId to name and back
+     */
+    class EventRegistry {
+      public:
+        static constexpr std::size_t COUNT = static_cast<std::size_t>(EventId::COUNT);
+
+        static constexpr std::array<std::string_view, COUNT> TYPES =
+            detail::eventTable<events::ThemeChanged, events::LlmConfigsChanged, events::ActionsChanged, events::LlmEnabledChanged,
+                               events::ActionEnabledChanged, events::RequestRefresh, events::ClipboardChanged, events::WsDelta,
+                               events::PipelineProgress, events::SettingsPatch, events::FocusChanged, events::VaultStatus>();
+
+        /**
+         * @brief Name of @p id as used on the TypeScript side
+         */
+        static constexpr std::string_view name(EventId id) {
+            return TYPES[static_cast<std::size_t>(id)];
+        }
+
+        /**
+         * @brief Whether pages may raise @p id through event_trigger; the rest are raised natively only
+         */
+        static constexpr bool raisedByWebview(EventId id) {
+            return id < EventId::NETWORK_WS_DELTA;
+        }
+
+        /**
+         * @brief Id of @p name, or std::nullopt for a name not in the registry
+         */
+        static constexpr std::optional<EventId> find(std::string_view name) {
+            for (std::size_t i = 0; i < COUNT; i++) {
+                if (TYPES[i] == name) {
+                    return static_cast<EventId>(i);
+                }
+            }
+            return std::nullopt;
+        }
+    };
+
+    static_assert(EventRegistry::find("pipeline:progress") == EventId::PIPELINE_PROGRESS);
+    static_assert(EventRegistry::name(EventId::APP_FOCUS_CHANGED) == "app:focus-changed");
+    static_assert(EventRegistry::raisedByWebview(EventId::ASSISTANT_CLIPBOARD_CHANGED) &&
+                  !EventRegistry::raisedByWebview(EventId::NETWORK_WS_DELTA));
+
+} // namespace byoa
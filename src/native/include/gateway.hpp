@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace byoa {
+
+    /**
+     * @brief Local OpenAI-compatible HTTP gateway
+     *
+     * Optional server bound to 127.0.0.1 so other local tools can use the
+     * providers configured in BYOA. It serves GET /v1/models and
+     * POST /v1/chat/completions, including "stream": true as server-sent
+     * events. "model" selects a configured provider by id, name or model name;
+     * "auto" or no model picks the first enabled one. Requests go through
+     * Network::request with the provider's key from Vault, so they share its
+     * connection cache and limits, and through EndpointPool, so a 429 ejects
+     * the member for app and gateway requests alike. There is no request-rate
+     * limit of its own beyond a cap on concurrent clients.
+     *
+     * Clients authenticate with "Authorization: Bearer <token>", where the token
+     * is read from (or created in) gateway-token in the app data dir.
+     */
+    class Gateway {
+      public:
+        /**
+         * @brief Start the gateway if BYOA_GATEWAY_PORT is set
+         */
+        static void configureFromEnvironment();
+
+        /**
+         * @brief Listen on 127.0.0.1:@p port
+         *
+         * @return false if the port can't be bound or the token file can't be kept owner-only
+         */
+        static bool start(uint16_t port);
+
+        /**
+         * @brief Stop accepting connections, close idle ones and wait for requests in flight
+         */
+        static void stop();
+
+      private:
+        /**
+         * @brief The bearer token in the data dir, created owner-only on first use; std::nullopt if it can't be kept private
+         */
+        static std::optional<std::string> loadToken();
+
+        /**
+         * @brief Replace @p path with @p contents through a temporary file readable by the owner only
+         */
+        static bool writeOwnerOnly(const std::filesystem::path &path, const std::string &contents);
+    };
+
+} // namespace byoa
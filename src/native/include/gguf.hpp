@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace byoa {
+
+    /**
+     * @brief Read-only view of a GGUF model file
+     *
+     * The file is memory mapped: metadata is parsed into JSON up front, tensor
+     * data is handed out as pointers into the mapping and only paged in when
+     * the weights are first touched.
+     */
+    class GgufFile {
+      public:
+        /**
+         * @brief ggml tensor types understood by LocalModel
+         */
+        enum class TensorType : uint32_t {
+            F32  = 0,
+            F16  = 1,
+            Q4_0 = 2,
+            Q8_0 = 8,
+            Q4_K = 12,
+            Q6_K = 14,
+        };
+
+        struct Tensor {
+            TensorType type;
+            // ggml order: dims[0] is the contiguous (row) dimension
+            std::vector<uint64_t> dims;
+            const uint8_t *data = nullptr;
+            std::size_t rowBytes = 0;
+        };
+
+        /**
+         * @brief Map and parse @p path
+         *
+         * @return The file, or nullptr if it cannot be mapped, is not GGUF v2/v3 or uses unsupported tensor types
+         */
+        static std::unique_ptr<GgufFile> open(const std::filesystem::path &path);
+
+        ~GgufFile();
+
+        GgufFile(const GgufFile &)            = delete;
+        GgufFile &operator=(const GgufFile &) = delete;
+
+        const nlohmann::json &metadata() const {
+            return _metadata;
+        }
+
+        /**
+         * @brief Tensor called @p name, or nullptr
+         */
+        const Tensor *tensor(const std::string &name) const;
+
+        /**
+         * @brief Bytes taken by @p elements values of @p type, or 0 if @p elements is not a whole number of blocks
+         */
+        static std::size_t bytesFor(TensorType type, uint64_t elements);
+
+      private:
+        GgufFile() = default;
+
+        bool parse();
+
+        const uint8_t *_data = nullptr;
+        std::size_t _size    = 0;
+        void *_mapping       = nullptr;
+        nlohmann::json _metadata;
+        std::unordered_map<std::string, Tensor> _tensors;
+    };
+
+} // namespace byoa
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <coco/promise/promise.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llm.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Paragraph-level incremental re-processing of action inputs
+     *
+     * Inputs are split into paragraphs and fingerprinted. Paragraphs whose
+     * fingerprint was already processed by the same action are served from the
+     * cache of the previous run. Only changed ones are sent, concurrently, and
+     * the results are stitched back together with the original separators.
+     */
+    class Incremental {
+      public:
+        /**
+         * @brief A paragraph and the blank-line separator that follows it
+         */
+        struct Segment {
+            std::string text;
+            std::string separator;
+            uint64_t fingerprint = 0;
+        };
+
+        /**
+         * @brief Outcome of an incremental run
+         */
+        struct Result {
+            bool ok = false;
+            std::string content;
+            std::string error;
+            std::size_t segments = 0;
+            std::size_t sent     = 0;
+        };
+
+        using Processor = std::function<LLM::Completion(const std::string &segment)>;
+
+        /**
+         * @brief Split text into paragraphs separated by blank lines
+         */
+        static std::vector<Segment> split(const std::string &text);
+
+        /**
+         * @brief 64-bit FNV-1a fingerprint
+         */
+        static uint64_t fingerprint(std::string_view text);
+
+        /**
+         * @brief Process @p input, re-running @p process only for paragraphs not cached under @p cacheKey
+         */
+        static Result run(const std::string &cacheKey, const std::string &input, const Processor &process);
+
+        /**
+         * @brief Bridge entry point: incremental chat completion on a background thread
+         *
+         * @param configJson LLMConfig JSON object
+         * @param actionKey Identifies the action whose previous results may be reused
+         * @param systemContent System message
+         * @param userContent Full input text
+         * @return coco::future resolving to a JSON string {ok, content, error, segments, sent}
+         */
+        static coco::future<std::string> invokeAsync(const std::string &configJson, const std::string &actionKey,
+                                                     const std::string &systemContent, const std::string &userContent);
+
+      private:
+        static constexpr std::size_t MAX_CONCURRENCY    = 6;
+        static constexpr std::size_t MAX_CACHED_ACTIONS = 16;
+    };
+
+} // namespace byoa
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace byoa {
+
+    /**
+     * @brief Helpers for writing JSON string literals into pre-sized buffers
+     *
+     * Callers first sum up escapedLength() for everything they are going to
+     * emit, size their output once, and then write() into it, so building a
+     * JSON document costs a single allocation.
+     *
+     * Ill-formed UTF-8 is written as U+FFFD, like json::dump with
+     * error_handler_t::replace, so the output is always valid JSON.
+     */
+    class JsonEscape {
+      public:
+        /**
+         * @brief Number of bytes @p input occupies once escaped (without surrounding quotes)
+         */
+        static std::size_t escapedLength(std::string_view input);
+
+        /**
+         * @brief Write the escaped form of @p input to @p out
+         *
+         * @return Pointer one past the last byte written
+         */
+        static char *write(char *out, std::string_view input);
+    };
+
+} // namespace byoa
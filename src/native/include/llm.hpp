@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "network.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Native chat completion client for OpenAI-compatible providers
+     *
+     * Builds the request and parses the response natively, so features that
+     * fan out several requests per user action don't have to round-trip each
+     * one through the webview.
+     */
+    class LLM {
+      public:
+        /**
+         * @brief One (endpoint, key) pair able to serve a model
+         */
+        struct Endpoint {
+            std::string baseURL;
+            std::string apiKey;
+            // Optional Unix domain socket of a local server; baseURL then only supplies the path
+            std::string socketPath;
+        };
+
+        /**
+         * @brief Mirror of the LLMConfig type stored by the web frontend
+         */
+        struct Config {
+            std::string id;
+            std::string name;
+            std::string modelName;
+            std::string baseURL;
+            std::string apiKey;
+            std::string socketPath;
+            // Further endpoints for the same model, balanced by EndpointPool together with the one above
+            std::vector<Endpoint> pool;
+            std::string poolPolicy;
+            // Context window in tokens, 0 if unknown; used by Router
+            std::size_t contextTokens = 0;
+            // "off", "anthropic" or "openai" cache markers; empty guesses from baseURL
+            std::string promptCache;
+        };
+
+        /**
+         * @brief Result of a single completion request
+         */
+        struct Completion {
+            bool ok    = false;
+            int status = 0;
+            std::string content;
+            std::string error;
+            // Timing of the last attempt, measured from sending the request
+            int64_t firstByteMicros = 0;
+            int64_t totalMicros     = 0;
+            // Reported by the provider in "usage", 0 if absent
+            std::size_t outputTokens = 0;
+            // Prompt tokens served from the provider's prompt cache
+            uint64_t cachedTokens = 0;
+        };
+
+        /**
+         * @brief Parse an LLMConfig JSON object
+         *
+         * @return The config, or std::nullopt if the JSON is invalid or has no baseURL
+         */
+        static std::optional<Config> parseConfig(const std::string &configJson);
+
+        /**
+         * @brief Run a chat completion (blocking)
+         *
+         * @param config Provider configuration
+         * @param systemContent System message
+         * @param userContent User message
+         */
+        static Completion complete(const Config &config, const std::string &systemContent, const std::string &userContent);
+
+        /**
+         * @brief Bridge entry point: complete() on a background thread
+         *
+         * @param configJson LLMConfig JSON object
+         * @return coco::future resolving to a JSON string {ok, status, content, error}
+         */
+        static coco::future<std::string> completeAsync(const std::string &configJson, const std::string &systemContent,
+                                                       const std::string &userContent);
+
+        using DeltaCallback = std::function<void(const std::string &delta)>;
+
+        /**
+         * @brief Run a streaming chat completion (blocking), reporting content deltas as they arrive
+         *
+         * Falls back to the regular response shape if the server ignores "stream".
+         * The returned Completion holds the full content.
+         *
+         * @param cancelled Optional flag; once set, the transfer is aborted at the next chunk
+         */
+        static Completion stream(const Config &config, const std::string &systemContent, const std::string &userContent,
+                                 const DeltaCallback &onDelta, const std::atomic<bool> *cancelled = nullptr);
+
+        /**
+         * @brief Normalize a base URL to its /chat/completions endpoint
+         */
+        static std::string completionsURL(const std::string &baseURL);
+
+      private:
+        /**
+         * @brief Send a chat completion request for @p body; @p onData receives the raw response stream
+         */
+        static Completion send(const Config &config, const std::string &body, const Network::DataCallback &onData,
+                               const std::atomic<bool> *cancelled = nullptr);
+    };
+
+} // namespace byoa
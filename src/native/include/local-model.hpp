@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "llm.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief In-process CPU inference for small local models
+     *
+     * Configs whose baseURL is "local:<path to .gguf>" are served here instead
+     * of over the network. Llama-architecture models with a SentencePiece
+     * vocabulary are supported, quantised as F32, F16, Q4_0, Q8_0, Q4_K or Q6_K.
+     * The weights are memory mapped, matrix-vector products use SIMD dot
+     * products split across worker threads, and the KV cache of the previous
+     * prompt is reused up to the first differing token, so repeated runs of
+     * the same action only evaluate the new input. Decoding is greedy.
+     */
+    class LocalModel {
+      public:
+        static constexpr std::string_view SCHEME = "local:";
+
+        static bool isLocal(const std::string &baseURL) {
+            return baseURL.starts_with(SCHEME);
+        }
+
+        /**
+         * @brief Generate a chat reply (blocking), reporting text deltas as tokens are produced
+         *
+         * @return The completion, with tokens/sec of prompt evaluation and generation logged
+         */
+        static LLM::Completion generate(const LLM::Config &config, const std::string &systemContent, const std::string &userContent,
+                                        const LLM::DeltaCallback &onDelta);
+
+        /**
+         * @brief Release the loaded model, if any
+         */
+        static void unload();
+
+      private:
+        class Engine;
+        struct Registry;
+
+        static Registry &registry();
+
+        /**
+         * @brief Engine for @p path, loading it (and dropping the previous one) if needed
+         */
+        static std::shared_ptr<Engine> engineFor(const std::string &path);
+
+        static constexpr std::size_t MAX_CONTEXT    = 4096;
+        static constexpr std::size_t MAX_NEW_TOKENS = 1024;
+        // Prompt tokens evaluated per forward pass, so each weight row is read once per batch
+        static constexpr std::size_t PROMPT_BATCH = 32;
+        static constexpr std::size_t MAX_THREADS  = 8;
+    };
+
+} // namespace byoa
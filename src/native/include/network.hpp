@@ -1,9 +1,16 @@
 #pragma once
 
 #include <coco/promise/promise.hpp>
+#include <functional>
 #include <future>
 #include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "attachments.hpp"
+#include "spill-file.hpp"
 
 namespace byoa {
 
@@ -15,29 +22,88 @@ namespace byoa {
      */
     class Network {
       public:
+        /**
+         * @brief Orders header names case-insensitively, so "content-type" and "Content-Type" are one entry
+         */
+        struct HeaderLess {
+            using is_transparent = void;
+
+            bool operator()(std::string_view a, std::string_view b) const;
+        };
+
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+        using HeaderMap      = std::pmr::map<std::pmr::string, std::pmr::string, HeaderLess>;
+        using DataCallback   = std::function<bool(std::string_view chunk)>;
+
+        static constexpr std::size_t DEFAULT_MEMORY_LIMIT  = 8 * 1024 * 1024;
+        static constexpr std::size_t DEFAULT_MAX_BODY_SIZE = 256 * 1024 * 1024;
+
+        // fetch() returns the body inlined in JSON (and the bridge copies it again), so it never spills there
+        static constexpr std::size_t MAX_FETCH_BODY_SIZE = DEFAULT_MEMORY_LIMIT;
+
+        /**
+         * @brief An attachment spliced into the body at a given offset
+         */
+        struct AttachmentSlot {
+            std::size_t offset = 0;
+            Attachments::Encoding encoding;
+            std::shared_ptr<const Attachments::Attachment> attachment;
+        };
+
         /**
          * @brief Structure to hold fetch request options
+         *
+         * All members allocate from the given allocator, so a request can keep its
+         * whole lifecycle on a RequestArena.
          */
         struct FetchOptions {
-            std::string method = "GET";
-            std::map<std::string, std::string> headers;
-            std::string body;
+            explicit FetchOptions(allocator_type alloc = {})
+                : method("GET", alloc), headers(alloc), body(alloc), attachments(alloc), unixSocket(alloc) {}
+
+            std::pmr::string method;
+            HeaderMap headers;
+            std::pmr::string body;
+            // Filled from "bodyParts"; expanded into body by assembleBody()
+            std::pmr::vector<AttachmentSlot> attachments;
+            // Unix domain socket to connect through instead of TCP (no proxy)
+            std::pmr::string unixSocket;
+            // Sees every body chunk as it arrives (e.g. server-sent events); returning false aborts
+            DataCallback onData;
+            // Bodies larger than this spill to a temporary mapped file
+            std::size_t memoryLimit = DEFAULT_MEMORY_LIMIT;
+            // Transfers whose body exceeds this are aborted
+            std::size_t maxBodySize = DEFAULT_MAX_BODY_SIZE;
         };
 
         /**
          * @brief Structure to hold fetch response
          */
         struct FetchResponse {
+            explicit FetchResponse(allocator_type alloc = {}) : statusText(alloc), headers(alloc), body(alloc) {}
+
+            /**
+             * @brief The response body, wherever it ended up
+             */
+            std::string_view bodyView() const {
+                return spill ? spill->view() : std::string_view(body);
+            }
+
             int status = 0;
-            std::string statusText;
-            std::map<std::string, std::string> headers;
-            std::string body;
-            bool ok = false;
+            std::pmr::string statusText;
+            HeaderMap headers;
+            // In-memory body; empty once the body spilled over FetchOptions::memoryLimit
+            std::pmr::string body;
+            std::shared_ptr<SpillFile> spill;
+            bool ok       = false;
+            bool tooLarge = false;
         };
 
         /**
          * @brief Make an HTTP request asynchronously (fetch-like API) - returns coco::future
          *
+         * The body is returned inline, so memoryLimit and maxBodySize are capped at
+         * MAX_FETCH_BODY_SIZE and larger responses fail as "Response Too Large".
+         *
          * @param url The URL to fetch
          * @param options JSON string containing method, headers, and body
          * @return coco::future that can be co_awaited without blocking
@@ -45,7 +111,7 @@ namespace byoa {
         static coco::future<std::string> fetchAsync(const std::string &url, const std::string &options);
 
         /**
-         * @brief Make an HTTP request synchronously (fetch-like API)
+         * @brief Make an HTTP request synchronously (fetch-like API), with the same body limits as fetchAsync()
          *
          * @param url The URL to fetch
          * @param options JSON string containing method, headers, and body
@@ -53,6 +119,29 @@ namespace byoa {
          */
         static std::string fetch(const std::string &url, const std::string &options);
 
+        /**
+         * @brief Perform an HTTP request natively (blocking)
+         *
+         * Response headers and body are written straight into @p response through curl
+         * callbacks, using the response's own allocator.
+         *
+         * URLs of the form "unix:<socket path>[:<http path>]", e.g.
+         * "unix:/tmp/llama.sock:/v1/chat/completions", and requests with
+         * FetchOptions::unixSocket set go over a Unix domain socket and skip proxy
+         * resolution.
+         *
+         * Buffered requests time out after 30 s in total. Requests with
+         * FetchOptions::onData only fail once nothing arrives for 30 s. A transfer
+         * that does not complete (timeout, dropped connection, onData returning
+         * false) comes back with ok=false and the curl error as its body, whatever
+         * the status line said.
+         *
+         * @param url The URL to fetch
+         * @param options Method, headers, and body
+         * @param response Receives status, headers, and body
+         */
+        static void request(const std::string &url, const FetchOptions &options, FetchResponse &response);
+
       private:
         /**
          * @brief Internal fetch implementation (synchronous)
@@ -60,15 +149,44 @@ namespace byoa {
         static std::string fetchImpl(const std::string &url, const std::string &options);
 
         /**
-         * @brief Parse JSON options string to FetchOptions struct
+         * @brief Parse JSON options string into a FetchOptions struct (SAX, no DOM)
+         */
+        static void parseOptions(const std::string &optionsJson, FetchOptions &options);
+
+        /**
+         * @brief Expand attachment slots into a single, exactly sized body buffer
+         */
+        static void assembleBody(FetchOptions &options);
+
+        /**
+         * @brief Add a body chunk to @p response, honouring the memory limit and maximum size
+         *
+         * @return false if the transfer must be aborted
          */
-        static FetchOptions parseOptions(const std::string &optionsJson);
+        static bool appendBody(const FetchOptions &options, FetchResponse &response, std::string_view data);
+
+        /**
+         * @brief Settle the body once the transfer ended: report oversize aborts, map spilled bodies
+         */
+        static void finishBody(const FetchOptions &options, FetchResponse &response);
+
+        /**
+         * @brief Serve a request from the loaded recording instead of the network
+         */
+        static void replay(const std::string &url, const FetchOptions &options, FetchResponse &response);
 
         /**
          * @brief Convert FetchResponse to JSON string
          */
         static std::string responseToJson(const FetchResponse &response);
 
+        static constexpr std::string_view UNIX_SCHEME = "unix:";
+
+        /**
+         * @brief Split a "unix:<socket path>[:<http path>]" URL into an http://localhost URL and the socket path
+         */
+        static void splitUnixURL(const std::string &url, std::string &httpUrl, std::string &socketPath);
+
         /**
          * @brief Get system proxy configuration
          * @return Proxy URL string (empty if no proxy configured)
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <coco/promise/promise.hpp>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llm.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Multi-stage action pipelines (e.g. translate, then summarise, then fix tone)
+     *
+     * Each stage runs on its own thread. A streamable stage starts as soon as the
+     * previous stage has produced a complete sentence: it takes all complete
+     * sentences available so far, processes them with a streaming completion
+     * and forwards its own output downstream as it arrives. Other stages wait
+     * for their whole input. Every finished stage output is cached under the
+     * input and the chain of prompts that produced it, so a re-run resumes
+     * after the last cached stage.
+     */
+    class Pipeline {
+      public:
+        /**
+         * @brief One step of a pipeline
+         */
+        struct Stage {
+            std::string id;
+            std::string prompt;
+            // Sentences can be processed independently, so the stage may start on partial input
+            bool streamable = false;
+        };
+
+        /**
+         * @brief Outcome of a pipeline run
+         */
+        struct Result {
+            bool ok = false;
+            std::string content;
+            std::string error;
+            // Output of each stage, cached or fresh; empty for stages that did not finish
+            std::vector<std::string> outputs;
+            std::size_t resumedFrom = 0;
+        };
+
+        using ProgressCallback = std::function<void(std::size_t stage, const std::string &delta, bool done)>;
+
+        /**
+         * @brief Length of the prefix of @p text that ends on a complete sentence (0 if none)
+         */
+        static std::size_t sentenceBoundary(std::string_view text);
+
+        /**
+         * @brief Run @p stages over @p input (blocking)
+         *
+         * @param fromStage First stage to re-run even if cached; earlier stages come from the
+         *                  cache when possible. Pass stages.size() to reuse everything cached.
+         * @param onProgress Invoked from stage threads with every output delta and when a stage finishes
+         */
+        static Result run(const LLM::Config &config, const std::vector<Stage> &stages, const std::string &input, std::size_t fromStage,
+                          const ProgressCallback &onProgress);
+
+        /**
+         * @brief Bridge entry point: run a pipeline on a background thread
+         *
+         * @param configJson LLMConfig JSON object
+         * @param stagesJson JSON array of {id, prompt, streamable}
+         * @param input Text fed to the first stage
+         * @param fromStage First stage to re-run; negative to reuse everything cached
+         * @param onProgress See run()
+         * @return coco::future resolving to a JSON string {ok, content, error, outputs, resumedFrom}
+         */
+        static coco::future<std::string> runAsync(const std::string &configJson, const std::string &stagesJson, const std::string &input,
+                                                  int fromStage, ProgressCallback onProgress);
+
+      private:
+        static constexpr std::size_t MAX_CACHED_OUTPUTS = 64;
+    };
+
+} // namespace byoa
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "llm.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Lays out chat requests for provider prompt caching and tracks the hits
+     *
+     * Requests always carry the stable part first (the system prompt, identical
+     * for every run of an action) so automatic prefix caching can match it.
+     * Providers with explicit caching get their markers:
+     * - Anthropic-style "cache_control" on the system block;
+     * - OpenAI's "prompt_cache_key", which keeps requests sharing a prefix on the same cache.
+     *
+     * Cached prompt tokens reported in "usage" are accumulated per config,
+     * together with the time to first byte of hits and misses.
+     */
+    class PromptCache {
+      public:
+        enum class Markers {
+            NONE,
+            ANTHROPIC,
+            OPENAI,
+        };
+
+        /**
+         * @brief Markers for @p config: its "promptCache" setting, else guessed from the base URL
+         */
+        static Markers markersFor(const LLM::Config &config);
+
+        /**
+         * @brief Build the chat completion body for @p config, stable prefix first
+         */
+        static nlohmann::json requestBody(const LLM::Config &config, const std::string &systemContent, const std::string &userContent);
+
+        /**
+         * @brief Record the "usage" object of a response to a request of @p configId
+         *
+         * @return Number of prompt tokens the provider served from its cache
+         */
+        static uint64_t observe(const std::string &configId, const nlohmann::json &usage, int64_t firstByteMicros);
+
+        /**
+         * @brief Per-config cache statistics as a JSON string
+         */
+        static std::string statsJson();
+    };
+
+} // namespace byoa
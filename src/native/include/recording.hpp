@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace byoa {
+
+    /**
+     * @brief Record-and-replay of Network exchanges
+     *
+     * While recording, every request made through Network::request is appended
+     * to a JSON-lines file: method, URL, headers and body on both sides, plus the
+     * time to the response headers and the offset and size of every body chunk.
+     * Credentials are redacted before anything is written (auth headers, key-like
+     * query parameters and key/token/secret/password fields of JSON bodies).
+     *
+     * While replaying, Network::request doesn't touch the network. It serves the
+     * next recorded exchange with the same method and (redacted) URL, and
+     * reproduces the original header delay and chunk timing. Exchanges for the
+     * same URL are served in recorded order and wrap around.
+     */
+    class Recording {
+      public:
+        using HeaderList = std::map<std::string, std::string>;
+
+        /**
+         * @brief A body chunk as it arrived: offset from the start of the request and size
+         */
+        struct Chunk {
+            int64_t offsetMicros = 0;
+            std::size_t size     = 0;
+        };
+
+        /**
+         * @brief One request/response pair
+         */
+        struct Exchange {
+            std::string method;
+            std::string url;
+            HeaderList requestHeaders;
+            std::string requestBody;
+
+            int status = 0;
+            std::string statusText;
+            HeaderList responseHeaders;
+            int64_t headersMicros = 0;
+            std::vector<Chunk> chunks;
+            std::string responseBody;
+        };
+
+        /**
+         * @brief Start recording or replaying from BYOA_RECORD_FILE / BYOA_REPLAY_FILE if set
+         */
+        static void configureFromEnvironment();
+
+        /**
+         * @brief Append exchanges to @p file from now on
+         */
+        static bool startRecording(const std::filesystem::path &file);
+
+        static void stopRecording();
+
+        static bool isRecording();
+
+        /**
+         * @brief Redact and append @p exchange to the recording file
+         */
+        static void record(Exchange exchange);
+
+        /**
+         * @brief Serve requests from the exchanges in @p file from now on
+         */
+        static bool startReplay(const std::filesystem::path &file);
+
+        static bool isReplaying();
+
+        /**
+         * @brief Next recorded exchange for @p method and @p url, if any
+         */
+        static std::optional<Exchange> nextReplay(const std::string &method, const std::string &url);
+
+        /**
+         * @brief @p url with credential-like query parameter values replaced
+         */
+        static std::string redactURL(const std::string &url);
+
+      private:
+        static void redact(Exchange &exchange);
+    };
+
+} // namespace byoa
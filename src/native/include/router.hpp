@@ -0,0 +1,86 @@
+#pragma once
+
+#include <coco/promise/promise.hpp>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llm.hpp"
+
+namespace byoa {
+
+    /**
+     * @brief Picks the model for an action from the enabled configs
+     *
+     * Every completion is observed to keep a per-config history of time to
+     * first byte and output throughput. A route predicts each candidate's
+     * latency for the input's estimated token count, drops candidates whose
+     * context window is too small, and takes the first candidate (in the
+     * action's preference order) predicted to meet the latency target, or
+     * the fastest one if none does or no target is set. The rest become the
+     * fallback chain, and every decision carries a human-readable reason.
+     */
+    class Router {
+      public:
+        /**
+         * @brief Per-action routing policy, mirror of Action.routing
+         */
+        struct Policy {
+            // Config ids in order of preference; empty means every enabled config
+            std::vector<std::string> models;
+            // 0 means "as fast as possible"
+            double latencyTargetMs = 0;
+        };
+
+        struct Prediction {
+            std::string configId;
+            double latencyMs = 0;
+            bool fits        = true;
+            // False while the config has no history and priors are used
+            bool observed = false;
+        };
+
+        struct Route {
+            std::vector<std::string> chain;
+            std::size_t inputTokens = 0;
+            std::vector<Prediction> predictions;
+            std::string reason;
+        };
+
+        /**
+         * @brief Rough token count (4 bytes per token), good enough to compare models
+         */
+        static std::size_t estimateTokens(std::string_view text);
+
+        /**
+         * @brief Record the timing of a successful completion of @p configId
+         *
+         * @param streamed Whether the body arrived incrementally, i.e. whether firstByteMicros is a real TTFB
+         */
+        static void observe(const std::string &configId, const LLM::Completion &completion, bool streamed);
+
+        /**
+         * @brief Choose the chain of configs to try for @p input
+         */
+        static Route route(const std::vector<LLM::Config> &configs, const Policy &policy, std::string_view input);
+
+        /**
+         * @brief Bridge entry point: route, then complete along the chain on a background thread
+         *
+         * @param configsJson Array of enabled LLMConfig objects
+         * @param policyJson Action.routing object
+         * @return coco::future resolving to a JSON string {ok, content, error, configId, reason, attempts}
+         */
+        static coco::future<std::string> invokeAsync(const std::string &configsJson, const std::string &policyJson,
+                                                     const std::string &systemContent, const std::string &userContent);
+
+      private:
+        static constexpr double EWMA_ALPHA = 0.3;
+        // Assumed until a config has been observed
+        static constexpr double PRIOR_TTFB_MS         = 800;
+        static constexpr double PRIOR_TOKENS_PER_SEC  = 40;
+        static constexpr std::size_t MIN_OUTPUT_TOKENS = 32;
+    };
+
+} // namespace byoa
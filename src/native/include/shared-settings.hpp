@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace byoa {
+
+    /**
+     * @brief Authoritative copy of the settings shared by all windows
+     *
+     * Holds ConfigStore::SNAPSHOT_KEYS as one JSON document with a version
+     * counter. Windows change it with JSON patches (RFC 6902) against the
+     * version they last saw; each accepted change is applied here, persisted
+     * for the top-level keys it touches and sent as {version, patch} to every
+     * other subscribed window, so toggling one action costs a few bytes
+     * instead of every window reloading every setting.
+     */
+    class SharedSettings {
+      public:
+        using Listener = std::function<void(const std::string &deltaJson)>;
+
+        /**
+         * @brief Current document as JSON {version, state}
+         */
+        static std::string snapshotJson();
+
+        /**
+         * @brief Apply a JSON patch made against @p baseVersion
+         *
+         * Ops must target a top-level key or below it; one on the root ("") is rejected.
+         *
+         * @param origin Subscription of the window sending it, which is not sent the delta back; 0 for none
+         * @return JSON {ok, version}; ok is false with "conflict" set if @p baseVersion is not the current version
+         */
+        static std::string applyJson(const std::string &patchJson, uint64_t baseVersion, uint64_t origin);
+
+        /**
+         * @brief Replace top-level @p key with @p valueJson, broadcasting the difference to every subscriber
+         */
+        static bool set(const std::string &key, const std::string &valueJson);
+
+        /**
+         * @brief Remove top-level @p key
+         */
+        static bool remove(const std::string &key);
+
+        /**
+         * @brief Receive deltas; @p listener runs on the thread that applied the change
+         *
+         * @return Subscription id for unsubscribe() and applyJson()
+         */
+        static uint64_t subscribe(Listener listener);
+
+        static void unsubscribe(uint64_t id);
+
+      private:
+        struct State;
+        static State &state();
+    };
+
+} // namespace byoa
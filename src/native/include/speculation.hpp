@@ -0,0 +1,74 @@
+#pragma once
+
+#include <coco/promise/promise.hpp>
+#include <cstddef>
+#include <string>
+
+namespace byoa {
+
+    /**
+     * @brief Starts the most likely action before the user picks it
+     *
+     * Which action users run is counted per (source app, content type) and
+     * persisted in the app data directory. When the assistant popup opens,
+     * begin() predicts the action for the current source and, if the
+     * prediction is confident and the input is within the cost cap, runs the
+     * request the action sent last time on the new input. A claim() for the
+     * same action, config, prompt and input attaches to that request, running
+     * or finished; a claim for another action cancels it. Hits, misses and the
+     * latency saved are exposed through statsJson().
+     */
+    class Speculation {
+      public:
+        /**
+         * @brief Called when the popup opens; may start a speculative request
+         *
+         * @param sourceApp Identifier of the app the content was copied from, empty if unknown
+         * @param content Clipboard text
+         */
+        static void begin(const std::string &sourceApp, const std::string &content);
+
+        /**
+         * @brief Cancel the pending speculative request, if nobody claimed it
+         */
+        static void cancel();
+
+        /**
+         * @brief Bridge entry point: take over the speculative result for this request, if it matches
+         *
+         * A claim for the same action with another config, prompt or input neither hits nor
+         * cancels, so the claim of each enabled model can run against the same flight.
+         *
+         * @param configJson LLMConfig JSON object
+         * @param recordUsage Count the action as used for the current source and remember the request
+         *                    so it can be speculated next time; set on one claim per click
+         * @return coco::future resolving to a JSON string {hit, ok, content, error, savedMs}
+         */
+        static coco::future<std::string> claimAsync(const std::string &actionId, const std::string &configJson,
+                                                    const std::string &systemContent, const std::string &userContent,
+                                                    bool recordUsage);
+
+        /**
+         * @brief Prediction, hit rate and latency saved as a JSON string
+         */
+        static std::string statsJson();
+
+        /**
+         * @brief Persist the usage counts
+         */
+        static void save();
+
+        /**
+         * @brief Coarse content type used as part of the statistics key
+         */
+        static std::string contentType(const std::string &content);
+
+      private:
+        // Predict only with enough history and a clear favourite
+        static constexpr uint64_t MIN_SAMPLES     = 3;
+        static constexpr double MIN_CONFIDENCE    = 0.5;
+        // Cost cap: prompt plus input, in estimated tokens
+        static constexpr std::size_t MAX_TOKENS = 2000;
+    };
+
+} // namespace byoa
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+
+namespace byoa {
+
+    /**
+     * @brief Anonymous temporary file that response bodies overflow into
+     *
+     * Data is appended while the transfer runs; finish() then maps the file
+     * read-only so the body can be handed out as a view without ever being
+     * held in memory as a whole. The file is deleted when the object goes away.
+     */
+    class SpillFile {
+      public:
+        /**
+         * @brief Create an empty spill file
+         *
+         * @return The file, or nullptr if no temporary file could be created
+         */
+        static std::unique_ptr<SpillFile> create();
+
+        ~SpillFile();
+
+        SpillFile(const SpillFile &)            = delete;
+        SpillFile &operator=(const SpillFile &) = delete;
+
+        /**
+         * @brief Append @p data; only valid before finish()
+         */
+        bool append(std::string_view data);
+
+        /**
+         * @brief Stop writing and map the contents for reading
+         */
+        bool finish();
+
+        /**
+         * @brief Mapped contents (empty before finish())
+         */
+        std::string_view view() const;
+
+        std::size_t size() const {
+            return _size;
+        }
+
+      private:
+        explicit SpillFile(std::FILE *file) : _file(file) {}
+
+        std::FILE *_file    = nullptr;
+        std::size_t _size   = 0;
+        const char *_data   = nullptr;
+        void *_mapping      = nullptr;
+    };
+
+} // namespace byoa
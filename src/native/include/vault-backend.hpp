@@ -0,0 +1,71 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace byoa {
+
+    /**
+     * @brief Storage behind Vault
+     *
+     * The OS credential store is the default. The encrypted file backend is
+     * for machines without one (headless Linux, CI), and the in-memory
+     * backend for benchmarks and throwaway runs.
+     */
+    class VaultBackend {
+      public:
+        enum class Status { OK, NOT_FOUND, FAILED };
+
+        struct Result {
+            Status status = Status::OK;
+            std::string value;
+            std::string error;
+        };
+
+        virtual ~VaultBackend() = default;
+
+        virtual const char *name() const = 0;
+
+        /**
+         * @brief Why every call is bound to fail, or empty if the store can be used
+         */
+        virtual std::string unusable() const {
+            return {};
+        }
+
+        virtual Result get(const std::string &key) = 0;
+
+        virtual Result set(const std::string &key, const std::string &value) = 0;
+
+        /**
+         * @brief Delete @p key; NOT_FOUND if it was not stored
+         */
+        virtual Result remove(const std::string &key) = 0;
+
+        /**
+         * @brief OS credential store (macOS Keychain, Windows Credential Manager, Secret Service)
+         */
+        static std::unique_ptr<VaultBackend> keychain(const std::string &package, const std::string &service);
+
+        /**
+         * @brief All entries in one ChaCha20-Poly1305 sealed file, rewritten atomically on every change
+         *
+         * @param path The vault file
+         * @param secret Passphrase the key is derived from (PBKDF2-HMAC-SHA256 with a per-file salt)
+         * @return The backend, or nullptr if @p path exists but cannot be opened with @p secret
+         */
+        static std::unique_ptr<VaultBackend> encryptedFile(const std::filesystem::path &path, const std::string &secret);
+
+        /**
+         * @brief Process-local map, gone at exit
+         */
+        static std::unique_ptr<VaultBackend> memory();
+
+        /**
+         * @brief Store that fails every call with @p reason, for when the configured one can't be used
+         */
+        static std::unique_ptr<VaultBackend> unavailable(const std::string &reason);
+    };
+
+} // namespace byoa
@@ -1,15 +1,47 @@
 #pragma once
 
+#include <chrono>
+#include <coco/promise/promise.hpp>
+#include <functional>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace byoa {
 
+    class VaultBackend;
+
     /**
      * @brief Helper class for managing vault operations
      *
      * This class provides a simplified interface to the vault library
      * for storing and retrieving credentials securely.
+     *
+     * Reads are served from an in-memory cache, filled on first read
+     * (including "not found") and kept current by storeData()/deleteData(),
+     * so the OS credential store is only hit on a cold start. Values changed
+     * outside the app are picked up by invalidate() or, if a revalidation
+     * interval is set, by re-reading entries older than the interval.
+     *
+     * The methods above block on the credential store, which may be slow or
+     * show a prompt. The *Async variants run them on one serial worker
+     * thread instead, so operations complete in the order they were queued;
+     * a read of a cached key with nothing queued for it resolves at once.
+     *
+     * storeDeferred()/deleteDeferred() don't wait for the store at all: the
+     * change is kept pending, reads see it at once, and repeated changes to a
+     * key within the write-behind delay reach the store as one write. Pending
+     * changes are flushed on a timer, when a window hides and at shutdown.
+     * Changes the store rejects stay pending and are retried every
+     * RETRY_DELAY; until one goes through its key is listed as failed by
+     * statusJson() and the status listener is told. storeDataAsync() and
+     * friends defer the same way but resolve only once the store took the
+     * change, or rejected it.
+     *
+     * The store itself is a VaultBackend: the OS credential store unless
+     * configured otherwise.
      */
     class Vault {
       public:
@@ -46,9 +78,182 @@ namespace byoa {
          */
         static bool hasData(const std::string &key);
 
+        using Values = std::map<std::string, std::optional<std::string>>;
+
+        /**
+         * @brief Retrieve several values at once; keys not cached yet are read in a single pass
+         *
+         * @return Every requested key, mapped to std::nullopt if not found
+         */
+        static Values getMany(const std::vector<std::string> &keys);
+
+        /**
+         * @brief Store several values at once
+         *
+         * @return true if all were stored
+         */
+        static bool setMany(const std::map<std::string, std::string> &values);
+
+        /**
+         * @brief getData() on the worker; resolves to "" if not found
+         */
+        static coco::future<std::string> getDataAsync(const std::string &key);
+
+        /**
+         * @brief storeDeferred(), resolving once the change (or a later one to @p key) reached the store
+         *
+         * @return coco::future resolving to false if the store rejected it; it stays pending and is retried
+         */
+        static coco::future<bool> storeDataAsync(const std::string &key, const std::string &value);
+
+        /**
+         * @brief deleteDeferred(), resolving like storeDataAsync()
+         */
+        static coco::future<bool> deleteDataAsync(const std::string &key);
+
+        /**
+         * @brief hasData() on the worker
+         */
+        static coco::future<bool> hasDataAsync(const std::string &key);
+
+        /**
+         * @brief getMany() on the worker
+         */
+        static coco::future<Values> getManyAsync(const std::vector<std::string> &keys);
+
+        /**
+         * @brief storeDataAsync() for several values; resolves to true once all of them reached the store
+         */
+        static coco::future<bool> setManyAsync(const std::map<std::string, std::string> &values);
+
+        /**
+         * @brief Store @p value in the background, coalescing with other changes to @p key
+         *
+         * @return false if the store can't be used at all (see statusJson()); the change is then dropped
+         *         rather than served until exit and lost
+         */
+        static bool storeDeferred(const std::string &key, const std::string &value);
+
+        /**
+         * @brief Delete @p key in the background, coalescing with other changes to it
+         *
+         * @return false if the store can't be used at all, like storeDeferred()
+         */
+        static bool deleteDeferred(const std::string &key);
+
+        /**
+         * @brief Write every pending deferred change to the store on the calling thread
+         *
+         * Changes the store rejects stay pending, are listed as failed by statusJson() and are retried by the next flush.
+         *
+         * @return true if nothing is left pending
+         */
+        static bool flush();
+
+        /**
+         * @brief flush() on the worker, after everything queued before it
+         */
+        static coco::future<bool> flushAsync();
+
+        /**
+         * @brief Queue flush() on the worker without waiting for it
+         */
+        static void scheduleFlush();
+
+        /**
+         * @brief How long a deferred change may wait for others to coalesce with; zero flushes each one right away
+         */
+        static void setWriteBehindDelay(std::chrono::milliseconds delay);
+
+        /**
+         * @brief Run @p job on the worker after everything queued before it that touches @p keys
+         *
+         * @param keys Keys the job reads or writes; empty for any, which orders it after all queued jobs
+         * @param operation Name for the timing stats
+         */
+        template <typename T>
+        static coco::future<T> submit(std::vector<std::string> keys, const char *operation, std::function<T()> job) {
+            auto promise = std::make_shared<coco::promise<T>>();
+            auto future  = promise->get_future();
+            enqueue(std::move(keys), operation, [promise, job = std::move(job)]() { promise->set_value(job()); });
+            return future;
+        }
+
+        /**
+         * @brief Worker queue depth and per-operation wait/run times as JSON
+         */
+        static std::string workerStatsJson();
+
+        /**
+         * @brief Deferred changes not in the store yet, and the error of each key the store rejected, as JSON
+         *
+         * @return {"pending": number, "failed": {key: error}}, plus "unavailable": reason if the store can't be used
+         */
+        static std::string statusJson();
+
+        using StatusListener = std::function<void(const std::string &statusJson)>;
+
+        /**
+         * @brief Call @p listener with statusJson() whenever a key fails to reach the store or stops failing
+         *
+         * It runs on the thread that wrote to the store, usually the worker.
+         */
+        static void setStatusListener(StatusListener listener);
+
+        /**
+         * @brief Drop @p key from the cache, or every key if empty, so the next read goes to the store
+         */
+        static void invalidate(const std::string &key = "");
+
+        /**
+         * @brief Re-read cached entries older than @p interval; zero (the default) trusts the cache forever
+         */
+        static void setRevalidateInterval(std::chrono::seconds interval);
+
+        /**
+         * @brief Replace the store behind the vault; the cache starts empty
+         */
+        static void setBackend(std::unique_ptr<VaultBackend> backend);
+
+        /**
+         * @brief Apply BYOA_VAULT_REVALIDATE_SECONDS, BYOA_VAULT_WRITE_BEHIND_MS and BYOA_VAULT_BACKEND, if set
+         *
+         * BYOA_VAULT_BACKEND is keychain (default), file or memory. The file store is
+         * vault.bin in the data directory, keyed by BYOA_VAULT_SECRET or else by a
+         * random vault.key created next to it. If it can't be opened every read and
+         * write fails, rather than going to a store the keys would be lost from:
+         * deferred writes are refused at once and statusJson() names the reason.
+         */
+        static void configureFromEnvironment();
+
       private:
+        static std::shared_ptr<VaultBackend> backend();
+
+        struct Worker;
+        static Worker &worker();
+
+        struct Flusher;
+        static Flusher &flusher();
+
+        /**
+         * @param written Told whether the change, or one that replaced it, reached the store
+         * @return false if the store can't be used; @p written is told so at once
+         */
+        static bool defer(const std::string &key, std::optional<std::string> value, std::function<void(bool)> written = nullptr);
+
+        static void enqueue(std::vector<std::string> keys, const char *operation, std::function<void()> job);
+
+        /**
+         * @brief Cached value of @p key if it is fresh and no queued job touches it
+         */
+        static std::optional<std::optional<std::string>> settled(const std::string &key);
+
         static constexpr const char *PACKAGE_NAME = "com.byoa.assistant";
         static constexpr const char *SERVICE_NAME = "vault";
+        // Jobs running longer than this are logged; the store is probably prompting
+        static constexpr std::chrono::milliseconds SLOW_OPERATION{100};
+        // How soon a flush the store rejected is tried again
+        static constexpr std::chrono::seconds RETRY_DELAY{10};
     };
 
 } // namespace byoa
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <coco/promise/promise.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace byoa {
+
+    /**
+     * @brief Persistent WebSocket transport for realtime-style provider APIs
+     *
+     * Keeps one long-lived connection per provider URL on its own thread, with
+     * ping heartbeats and reconnects using exponential backoff. Requests are
+     * multiplexed over that connection. Inbound messages are routed to the
+     * request whose id they carry ("request_id", "event_id" or "id"), and to
+     * the oldest in-flight request otherwise. A request completes on a
+     * "response.done" or "error" message, or on one with "done": true.
+     */
+    class WebSocket {
+      public:
+        using DeltaCallback = std::function<void(const std::string &message)>;
+
+        /**
+         * @brief Send a message and stream back everything the provider answers to it
+         *
+         * @param url ws:// or wss:// endpoint; one connection is kept per URL
+         * @param headersJson JSON object of handshake headers (e.g. Authorization)
+         * @param requestId Caller-chosen id used to correlate deltas; a request whose id is still pending on the
+         *                  same connection is rejected with ok=false instead of replacing the earlier one
+         * @param payload Text frame to send
+         * @param onDelta Invoked on the connection thread for every message routed to this request
+         * @return coco::future resolving to a JSON string {ok, error, message} where message is the final frame
+         */
+        static coco::future<std::string> sendAsync(const std::string &url, const std::string &headersJson, const std::string &requestId,
+                                                   const std::string &payload, DeltaCallback onDelta);
+
+        /**
+         * @brief Close every connection and fail outstanding requests (call on shutdown)
+         */
+        static void closeAll();
+
+      private:
+        class Connection;
+        struct Registry;
+
+        static Registry &registry();
+        static std::shared_ptr<Connection> connectionFor(const std::string &url);
+    };
+
+} // namespace byoa
@@ -1,17 +1,40 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <saucer/smartview.hpp>
 #include <saucer/window.hpp>
 #include <string>
 
+#include "event-bus.hpp"
+#include "event-queue.hpp"
+
 class WebviewWrapper {
   public:
     WebviewWrapper(std::shared_ptr<saucer::window> window);
+    ~WebviewWrapper();
     bool init(const std::string &viewURL);
-    void triggerEvent(const std::string &eventName, const std::string &data);
+    /**
+     * @brief Queue @p event for this webview, if its page listens for it; delivered with others in the next frame
+     */
+    template <typename Event>
+    void triggerEvent(const Event &event) {
+        byoa::EventBus::send(_endpoint, event);
+    }
 
   private:
+    /**
+     * @brief _webview->expose() with call, latency and payload size stats (BridgeStats) around @p handler
+     */
+    template <typename Handler>
+    void expose(const char *name, Handler handler);
+
     std::optional<saucer::smartview<>> _webview;
+    // SharedSettings subscription, made when the page calls settings_subscribe
+    uint64_t _settingsSubscription = 0;
+    // Declared after _webview, so it delivers what is left and stops before the webview goes away
+    std::unique_ptr<byoa::EventQueue> _events;
+    // EventBus endpoint feeding _events
+    uint64_t _endpoint = 0;
 };
@@ -19,7 +19,12 @@ class WindowWrapper {
     void hide();
     void move();
     void resize(const int &width, const int &height, const bool &animate = false);
-    void sendEventToWebview(const std::string &eventName, const std::string &data);
+    template <typename Event>
+    void sendEventToWebview(const Event &event) {
+        if (_webview) {
+            _webview->triggerEvent(event);
+        }
+    }
 #ifdef _WIN32
     HWND getWindowHandle();
 #endif
@@ -8,9 +8,14 @@
 
 #include "app-controller.hpp"
 #include "clipboard.hpp"
+#include "connection-cache.hpp"
+#include "gateway.hpp"
 #include "logger.hpp"
 #include "menubar-controller.hpp"
 #include "shortcut.hpp"
+#include "speculation.hpp"
+#include "vault.hpp"
+#include "websocket.hpp"
 #include "window-wrapper.hpp"
 
 using namespace std;
@@ -202,6 +207,12 @@ int AppController::start() {
             }
 
             _assistantWindow->show();
+
+            // Start the action this app's content usually gets while the user is still choosing
+            if (hasString) {
+                NSString *bundleId = focusedApp.bundleIdentifier;
+                byoa::Speculation::begin(bundleId ? [bundleId UTF8String] : "", Clipboard::getInstance().getString());
+            }
         } else {
             _assistantWindow->move();
         }
@@ -216,6 +227,12 @@ int AppController::start() {
 
 int AppController::stop() {
     Logger::getInstance().info("AppController::stop: start");
+    byoa::Gateway::stop();
+    byoa::WebSocket::closeAll();
+    byoa::ConnectionCache::save();
+    byoa::Speculation::save();
+    // On the worker, so the flush can't interleave with a keychain call still running there
+    byoa::Vault::flushAsync().get();
     [NSApp terminate:nil];
     return 0;
 }
@@ -98,6 +98,31 @@ std::string Clipboard::readText() {
     }
 }
 
+std::string Clipboard::readImage() {
+    @autoreleasepool {
+        NSPasteboard *pasteboard = [NSPasteboard generalPasteboard];
+
+        // Prefer PNG as-is, otherwise re-encode whatever bitmap is available
+        NSData *data = [pasteboard dataForType:NSPasteboardTypePNG];
+        if (!data) {
+            NSData *tiff = [pasteboard dataForType:NSPasteboardTypeTIFF];
+            if (!tiff) {
+                NSImage *image = [[NSImage alloc] initWithPasteboard:pasteboard];
+                tiff           = image ? [image TIFFRepresentation] : nil;
+            }
+            if (tiff) {
+                NSBitmapImageRep *rep = [NSBitmapImageRep imageRepWithData:tiff];
+                data                  = [rep representationUsingType:NSBitmapImageFileTypePNG properties:@{}];
+            }
+        }
+
+        if (!data) {
+            return std::string();
+        }
+        return std::string(static_cast<const char *>([data bytes]), [data length]);
+    }
+}
+
 void Clipboard::clear() {
     @autoreleasepool {
         NSPasteboard *pasteboard = [NSPasteboard generalPasteboard];
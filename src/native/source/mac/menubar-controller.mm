@@ -126,7 +126,8 @@ void MenubarController::showSettings() {
 
 - (void)quitApp:(id)sender {
     Logger::getInstance().info("MenubarController::quitApp: start");
-    [NSApp terminate:nil];
+    // Same shutdown as Windows: save caches and flush deferred Vault writes before terminating
+    AppController::getInstance().stop();
 }
 
 @end
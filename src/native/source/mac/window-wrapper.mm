@@ -6,6 +6,8 @@
 
 #include "app-controller.hpp"
 #include "logger.hpp"
+#include "speculation.hpp"
+#include "vault.hpp"
 #include "webview-wrapper.hpp"
 #include "window-wrapper.hpp"
 
@@ -51,16 +53,16 @@ WindowWrapper::WindowWrapper(saucer::application *app, WINDOW_TYPE windowType) :
         _window->on<saucer::window::event::focus>([&](bool status) {
             if (status) {
                 _isWindowVisible = true;
-                // Call native callback if registered
-                sendEventToWebview("on-focus-change", "true");
+                // Delivered only if the page listens for it
+                sendEventToWebview(byoa::events::FocusChanged{true});
             } else {
                 if (!_isWindowVisible) {
                     return;
                 }
                 hide();
                 _isWindowVisible = false;
-                // Call native callback if registered
-                sendEventToWebview("on-focus-change", "false");
+                // Delivered only if the page listens for it
+                sendEventToWebview(byoa::events::FocusChanged{false});
                 // Note: Don't hide here as this might fire too aggressively
             }
         });
@@ -114,6 +116,14 @@ void WindowWrapper::hide() {
     _isWindowVisible = false;
     _window->hide();
 
+    if (_windowType == WINDOW_TYPE::POPUP) {
+        // Closed without running the predicted action
+        byoa::Speculation::cancel();
+    }
+
+    // Settings changed in this window shouldn't wait for the write-behind timer
+    byoa::Vault::scheduleFlush();
+
     // If the main window is not visible, hide the application to bring the next App into focus
     if (!AppController::getInstance().getMainWindow()->isVisible()) {
         [[NSApplication sharedApplication] hide:nil];
@@ -226,12 +236,6 @@ void WindowWrapper::resize(const int &width, const int &height, const bool &anim
     _window->set_position({(int)newFrame.origin.x, (int)newFrame.origin.y});
 }
 
-void WindowWrapper::sendEventToWebview(const std::string &eventName, const std::string &data) {
-    if (_webview) {
-        _webview->triggerEvent(eventName, data);
-    }
-}
-
 std::string WindowWrapper::_getViewURL(const string &workflow /* = ""*/) {
     @autoreleasepool {
 #ifdef DEBUG
@@ -3,10 +3,15 @@
 
 #include "app-controller.hpp"
 #include "clipboard.hpp"
+#include "connection-cache.hpp"
+#include "gateway.hpp"
 #include "logger.hpp"
 #include "menubar-controller.hpp"
 #include "resource-loader.hpp"
 #include "shortcut.hpp"
+#include "speculation.hpp"
+#include "vault.hpp"
+#include "websocket.hpp"
 #include "window-wrapper.hpp"
 
 using namespace std;
@@ -102,6 +107,11 @@ int AppController::start() {
                 }
 
                 _assistantWindow->show();
+
+                // Start the action this content usually gets while the user is still choosing
+                if (hasString) {
+                    byoa::Speculation::begin("", Clipboard::getInstance().getString());
+                }
             } else {
                 _assistantWindow->move();
             }
@@ -122,6 +132,13 @@ int AppController::start() {
 int AppController::stop() {
     Logger::getInstance().info("AppController::stop: start");
 
+    byoa::Gateway::stop();
+    byoa::WebSocket::closeAll();
+    byoa::ConnectionCache::save();
+    byoa::Speculation::save();
+    // On the worker, so the flush can't interleave with a keychain call still running there
+    byoa::Vault::flushAsync().get();
+
     // Clean up embedded resources
     ResourceLoader::cleanup();
 
@@ -1,9 +1,93 @@
 #include "clipboard.hpp"
 #include "logger.hpp"
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <windows.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+    // Offset of the pixel bits in a packed DIB: header, then BI_BITFIELDS masks, then the color table
+    DWORD dibBitsOffset(const BITMAPINFOHEADER &header) {
+        DWORD offset = header.biSize;
+        if (header.biSize == sizeof(BITMAPINFOHEADER) && header.biCompression == BI_BITFIELDS) {
+            offset += 3 * sizeof(DWORD);
+        }
+        DWORD colors = header.biClrUsed;
+        if (colors == 0 && header.biBitCount <= 8) {
+            colors = 1u << header.biBitCount;
+        }
+        return offset + colors * sizeof(RGBQUAD);
+    }
+
+    // Re-encode a packed CF_DIB as PNG with WIC: prefixing a BITMAPFILEHEADER turns it into a .bmp
+    // that WIC's BMP decoder reads, whatever the bit depth, masks or row order
+    std::string dibToPng(const BYTE *dib, SIZE_T size) {
+        if (size < sizeof(BITMAPINFOHEADER)) {
+            return "";
+        }
+        BITMAPINFOHEADER header;
+        memcpy(&header, dib, sizeof(header));
+
+        BITMAPFILEHEADER file{};
+        file.bfType    = 0x4D42; // "BM"
+        file.bfSize    = static_cast<DWORD>(sizeof(file) + size);
+        file.bfOffBits = static_cast<DWORD>(sizeof(file) + dibBitsOffset(header));
+
+        std::vector<BYTE> bmp(sizeof(file) + size);
+        memcpy(bmp.data(), &file, sizeof(file));
+        memcpy(bmp.data() + sizeof(file), dib, size);
+
+        // The bridge thread may already be in an apartment; only undo what we did
+        HRESULT init = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        std::string png;
+        ComPtr<IWICImagingFactory> factory;
+        ComPtr<IWICStream> input;
+        ComPtr<IWICBitmapDecoder> decoder;
+        ComPtr<IWICBitmapFrameDecode> frame;
+        ComPtr<IStream> output;
+        ComPtr<IWICBitmapEncoder> encoder;
+        ComPtr<IWICBitmapFrameEncode> target;
+        HGLOBAL global = nullptr;
+        STATSTG stat{};
+        if (SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory))) &&
+            SUCCEEDED(factory->CreateStream(&input)) &&
+            SUCCEEDED(input->InitializeFromMemory(bmp.data(), static_cast<DWORD>(bmp.size()))) &&
+            SUCCEEDED(factory->CreateDecoderFromStream(input.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder)) &&
+            SUCCEEDED(decoder->GetFrame(0, &frame)) && SUCCEEDED(CreateStreamOnHGlobal(nullptr, TRUE, &output)) &&
+            SUCCEEDED(factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, &encoder)) &&
+            SUCCEEDED(encoder->Initialize(output.Get(), WICBitmapEncoderNoCache)) &&
+            SUCCEEDED(encoder->CreateNewFrame(&target, nullptr)) && SUCCEEDED(target->Initialize(nullptr)) &&
+            SUCCEEDED(target->WriteSource(frame.Get(), nullptr)) && SUCCEEDED(target->Commit()) && SUCCEEDED(encoder->Commit()) &&
+            SUCCEEDED(GetHGlobalFromStream(output.Get(), &global)) && SUCCEEDED(output->Stat(&stat, STATFLAG_NONAME))) {
+            const char *data = static_cast<const char *>(GlobalLock(global));
+            if (data) {
+                png.assign(data, static_cast<size_t>(stat.cbSize.QuadPart));
+                GlobalUnlock(global);
+            }
+        }
+
+        // Release the COM objects before leaving the apartment
+        target.Reset();
+        encoder.Reset();
+        output.Reset();
+        frame.Reset();
+        decoder.Reset();
+        input.Reset();
+        factory.Reset();
+        if (SUCCEEDED(init)) {
+            CoUninitialize();
+        }
+        return png;
+    }
+
+} // namespace
 
 Clipboard &Clipboard::getInstance() {
     static Clipboard instance;
@@ -155,6 +239,48 @@ bool Clipboard::writeText(const std::string &text) {
     return false;
 }
 
+std::string Clipboard::readImage() {
+    Logger::getInstance().info("Clipboard::readImage: start");
+
+    if (!OpenClipboard(NULL)) {
+        Logger::getInstance().warn("Clipboard::readImage: failed to open clipboard");
+        return "";
+    }
+
+    std::string result;
+
+    // Browsers and most editors publish a registered "PNG" format next to CF_DIB
+    static UINT pngFormat = RegisterClipboardFormat(L"PNG");
+    if (pngFormat != 0 && IsClipboardFormatAvailable(pngFormat)) {
+        HANDLE hClipboard = GetClipboardData(pngFormat);
+        if (hClipboard) {
+            const char *data = static_cast<const char *>(GlobalLock(hClipboard));
+            if (data) {
+                result.assign(data, GlobalSize(hClipboard));
+                GlobalUnlock(hClipboard);
+            }
+        }
+    } else if (IsClipboardFormatAvailable(CF_DIB)) {
+        // Screenshots and most apps only publish a bitmap (Windows synthesizes CF_DIB from the others)
+        HANDLE hClipboard = GetClipboardData(CF_DIB);
+        if (hClipboard) {
+            const BYTE *dib = static_cast<const BYTE *>(GlobalLock(hClipboard));
+            if (dib) {
+                result = dibToPng(dib, GlobalSize(hClipboard));
+                GlobalUnlock(hClipboard);
+            }
+        }
+        if (result.empty()) {
+            Logger::getInstance().warn("Clipboard::readImage: failed to encode the clipboard bitmap as PNG");
+        }
+    }
+
+    CloseClipboard();
+
+    Logger::getInstance().info("Clipboard::readImage: complete, length: {}", result.length());
+    return result;
+}
+
 std::string Clipboard::readText() {
     Logger::getInstance().info("Clipboard::readText: start");
 
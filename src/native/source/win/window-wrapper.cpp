@@ -4,6 +4,8 @@
 #include "menubar-controller.hpp"
 #include "resource-loader.hpp"
 #include "shortcut.hpp"
+#include "speculation.hpp"
+#include "vault.hpp"
 #include <saucer/window.hpp>
 #include <unordered_map>
 #include <windows.h>
@@ -61,16 +63,16 @@ WindowWrapper::WindowWrapper(saucer::application *app, WINDOW_TYPE windowType) :
         _window->on<saucer::window::event::focus>([&](bool status) {
             if (status) {
                 _isWindowVisible = true;
-                // Call native callback if registered
-                sendEventToWebview("on-focus-change", "true");
+                // Delivered only if the page listens for it
+                sendEventToWebview(byoa::events::FocusChanged{true});
             } else {
                 if (!_isWindowVisible) {
                     return;
                 }
                 hide();
                 _isWindowVisible = false;
-                // Call native callback if registered
-                sendEventToWebview("on-focus-change", "false");
+                // Delivered only if the page listens for it
+                sendEventToWebview(byoa::events::FocusChanged{false});
                 // Note: Don't hide here as this might fire too aggressively
             }
         });
@@ -146,6 +148,14 @@ void WindowWrapper::hide() {
             uninstallKeyboardHook();
         }
 #endif // _WIN32
+
+        if (_windowType == WINDOW_TYPE::POPUP) {
+            // Closed without running the predicted action
+            byoa::Speculation::cancel();
+        }
+
+        // Settings changed in this window shouldn't wait for the write-behind timer
+        byoa::Vault::scheduleFlush();
     }
 }
 
@@ -207,12 +217,6 @@ void WindowWrapper::resize(const int &width, const int &height, const bool &anim
     }
 }
 
-void WindowWrapper::sendEventToWebview(const std::string &eventName, const std::string &data) {
-    if (_webview) {
-        _webview->triggerEvent(eventName, data);
-    }
-}
-
 bool WindowWrapper::isVisible() {
     return _isWindowVisible;
 }
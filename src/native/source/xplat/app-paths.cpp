@@ -0,0 +1,39 @@
+#include <cstdlib>
+#include <system_error>
+
+#include "app-paths.hpp"
+#include "logger.hpp"
+
+namespace byoa {
+
+    namespace {
+
+        std::filesystem::path fromEnv(const char *name) {
+            const char *value = std::getenv(name);
+            return value && *value ? std::filesystem::path(value) : std::filesystem::path();
+        }
+
+    } // namespace
+
+    std::filesystem::path AppPaths::dataDir() {
+        static const std::filesystem::path dir = []() {
+            std::filesystem::path path;
+#if defined(__APPLE__)
+            path = fromEnv("HOME") / "Library" / "Application Support" / "com.byoa.assistant";
+#elif defined(_WIN32)
+            path = fromEnv("APPDATA") / "BYOA";
+#else
+            path = fromEnv("XDG_DATA_HOME");
+            path = path.empty() ? fromEnv("HOME") / ".local" / "share" / "byoa" : path / "byoa";
+#endif
+            std::error_code ec;
+            std::filesystem::create_directories(path, ec);
+            if (ec) {
+                Logger::getInstance().error("AppPaths::dataDir: Failed to create {}: {}", path.string(), ec.message());
+            }
+            return path;
+        }();
+        return dir;
+    }
+
+} // namespace byoa
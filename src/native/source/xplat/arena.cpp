@@ -0,0 +1,29 @@
+#include "arena.hpp"
+
+namespace byoa {
+
+    RequestArena::RequestArena() : _resource(_inline.data(), _inline.size(), &_upstream) {}
+
+    std::pmr::memory_resource *RequestArena::resource() {
+        return &_resource;
+    }
+
+    RequestArena::Stats RequestArena::stats() const {
+        return _upstream.stats;
+    }
+
+    void *RequestArena::CountingResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+        stats.upstreamAllocations++;
+        stats.upstreamBytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void RequestArena::CountingResource::do_deallocate(void *p, std::size_t bytes, std::size_t alignment) {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool RequestArena::CountingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+        return this == &other;
+    }
+
+} // namespace byoa
@@ -0,0 +1,131 @@
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "attachments.hpp"
+#include "base64.hpp"
+#include "json-escape.hpp"
+#include "logger.hpp"
+
+namespace byoa {
+
+    namespace {
+
+        struct Store {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::shared_ptr<const Attachments::Attachment>> entries;
+            std::deque<std::string> order;
+            std::size_t totalBytes = 0;
+            std::atomic<uint64_t> nextId{1};
+        };
+
+        Store &store() {
+            static Store instance;
+            return instance;
+        }
+
+        constexpr std::string_view DATA_URL_PREFIX = "data:";
+        constexpr std::string_view DATA_URL_SUFFIX = ";base64,";
+
+    } // namespace
+
+    std::string Attachments::put(std::string mimeType, std::string data) {
+        auto &s            = store();
+        std::string handle = "att-" + std::to_string(s.nextId++);
+        auto attachment    = std::make_shared<const Attachment>(Attachment{std::move(mimeType), std::move(data)});
+        std::size_t size   = attachment->data.size();
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        while (!s.order.empty() && s.totalBytes + size > MAX_TOTAL_BYTES) {
+            auto it = s.entries.find(s.order.front());
+            if (it != s.entries.end()) {
+                Logger::getInstance().warn("Attachments::put: Evicting {}", it->first);
+                s.totalBytes -= it->second->data.size();
+                s.entries.erase(it);
+            }
+            s.order.pop_front();
+        }
+
+        s.entries.emplace(handle, std::move(attachment));
+        s.order.push_back(handle);
+        s.totalBytes += size;
+
+        Logger::getInstance().info("Attachments::put: {} ({} bytes)", handle, size);
+        return handle;
+    }
+
+    std::shared_ptr<const Attachments::Attachment> Attachments::get(const std::string &handle) {
+        auto &s = store();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.entries.find(handle);
+        return it != s.entries.end() ? it->second : nullptr;
+    }
+
+    bool Attachments::release(const std::string &handle) {
+        auto &s = store();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.entries.find(handle);
+        if (it == s.entries.end()) {
+            return false;
+        }
+
+        s.totalBytes -= it->second->data.size();
+        s.entries.erase(it);
+        std::erase(s.order, handle);
+        return true;
+    }
+
+    std::optional<Attachments::Encoding> Attachments::parseEncoding(std::string_view name) {
+        if (name == "raw") {
+            return Encoding::RAW;
+        } else if (name == "json") {
+            return Encoding::JSON;
+        } else if (name == "base64") {
+            return Encoding::BASE64;
+        } else if (name == "dataUrl") {
+            return Encoding::DATA_URL;
+        }
+        return std::nullopt;
+    }
+
+    std::size_t Attachments::encodedLength(const Attachment &attachment, Encoding encoding) {
+        switch (encoding) {
+        case Encoding::RAW:
+            return attachment.data.size();
+        case Encoding::JSON:
+            return JsonEscape::escapedLength(attachment.data);
+        case Encoding::BASE64:
+            return Base64::encodedLength(attachment.data.size());
+        case Encoding::DATA_URL:
+            return DATA_URL_PREFIX.size() + attachment.mimeType.size() + DATA_URL_SUFFIX.size() +
+                   Base64::encodedLength(attachment.data.size());
+        }
+        return 0;
+    }
+
+    char *Attachments::write(char *out, const Attachment &attachment, Encoding encoding) {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(attachment.data.data());
+
+        switch (encoding) {
+        case Encoding::RAW:
+            std::memcpy(out, attachment.data.data(), attachment.data.size());
+            return out + attachment.data.size();
+        case Encoding::JSON:
+            return JsonEscape::write(out, attachment.data);
+        case Encoding::BASE64:
+            return Base64::encode(out, bytes, attachment.data.size());
+        case Encoding::DATA_URL:
+            std::memcpy(out, DATA_URL_PREFIX.data(), DATA_URL_PREFIX.size());
+            out += DATA_URL_PREFIX.size();
+            std::memcpy(out, attachment.mimeType.data(), attachment.mimeType.size());
+            out += attachment.mimeType.size();
+            std::memcpy(out, DATA_URL_SUFFIX.data(), DATA_URL_SUFFIX.size());
+            out += DATA_URL_SUFFIX.size();
+            return Base64::encode(out, bytes, attachment.data.size());
+        }
+        return out;
+    }
+
+} // namespace byoa
@@ -0,0 +1,139 @@
+#include <array>
+#include <cstring>
+
+#include "base64.hpp"
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define BYOA_BASE64_NEON 1
+#elif defined(__x86_64__) || defined(_M_X64)
+// SSSE3 is not part of the x86-64 baseline (MSVC has no flag-free macro for it), so it is
+// compiled in per function and picked at runtime
+#include <immintrin.h>
+#define BYOA_BASE64_SSSE3 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BYOA_TARGET_SSSE3
+#else
+#define BYOA_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+namespace byoa {
+
+    namespace {
+
+        constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        // Every 12-bit value mapped to its two output characters
+        constexpr std::array<char, 8192> makePairTable() {
+            std::array<char, 8192> table{};
+            for (std::size_t i = 0; i < 4096; i++) {
+                table[i * 2]     = ALPHABET[i >> 6];
+                table[i * 2 + 1] = ALPHABET[i & 0x3F];
+            }
+            return table;
+        }
+
+        constexpr std::array<char, 8192> PAIRS = makePairTable();
+
+#ifdef BYOA_BASE64_SSSE3
+        bool hasSsse3() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+#else
+            return __builtin_cpu_supports("ssse3");
+#endif
+        }
+
+        const bool SSSE3 = hasSsse3();
+
+        // 12 input bytes per iteration (Mula/Lemire): spread them over 16 lanes, cut the 6-bit
+        // indices out with two multiplies, then turn each index into ASCII by adding an offset
+        // looked up by its range. Loads 16 bytes, so it stops while at least 16 remain.
+        BYOA_TARGET_SSSE3 void encodeSsse3(char *&out, const unsigned char *&input, std::size_t &length) {
+            const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+            const __m128i offsets =
+                _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                              '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+            while (length >= 16) {
+                __m128i in = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input)), spread);
+
+                const __m128i high    = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+                const __m128i low     = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+                const __m128i indices = _mm_or_si128(high, low);
+
+                // Range of each index: 0 for A-Z, 1 for a-z, 2..11 for digits, 12 for '+', 13 for '/'
+                __m128i range       = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+                const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+                range               = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices));
+
+                input += 12;
+                out += 16;
+                length -= 12;
+            }
+        }
+#endif
+
+    } // namespace
+
+    char *Base64::encode(char *out, const unsigned char *input, std::size_t length) {
+#ifdef BYOA_BASE64_NEON
+        const uint8x16x4_t lut = vld1q_u8_x4(reinterpret_cast<const uint8_t *>(ALPHABET));
+        const uint8x16_t mask  = vdupq_n_u8(0x3F);
+
+        while (length >= 48) {
+            // De-interleave 16 groups of three bytes
+            uint8x16x3_t in = vld3q_u8(input);
+            uint8x16x4_t indices;
+            indices.val[0] = vshrq_n_u8(in.val[0], 2);
+            indices.val[1] = vorrq_u8(vshrq_n_u8(in.val[1], 4), vandq_u8(vshlq_n_u8(in.val[0], 4), mask));
+            indices.val[2] = vorrq_u8(vshrq_n_u8(in.val[2], 6), vandq_u8(vshlq_n_u8(in.val[1], 2), mask));
+            indices.val[3] = vandq_u8(in.val[2], mask);
+
+            uint8x16x4_t encoded;
+            encoded.val[0] = vqtbl4q_u8(lut, indices.val[0]);
+            encoded.val[1] = vqtbl4q_u8(lut, indices.val[1]);
+            encoded.val[2] = vqtbl4q_u8(lut, indices.val[2]);
+            encoded.val[3] = vqtbl4q_u8(lut, indices.val[3]);
+            vst4q_u8(reinterpret_cast<uint8_t *>(out), encoded);
+
+            input += 48;
+            out += 64;
+            length -= 48;
+        }
+#elif defined(BYOA_BASE64_SSSE3)
+        if (SSSE3) {
+            encodeSsse3(out, input, length);
+        }
+#endif
+
+        while (length >= 3) {
+            const unsigned int triple = (input[0] << 16) | (input[1] << 8) | input[2];
+            std::memcpy(out, &PAIRS[(triple >> 12) * 2], 2);
+            std::memcpy(out + 2, &PAIRS[(triple & 0xFFF) * 2], 2);
+            input += 3;
+            out += 4;
+            length -= 3;
+        }
+
+        if (length == 1) {
+            *out++ = ALPHABET[input[0] >> 2];
+            *out++ = ALPHABET[(input[0] & 0x03) << 4];
+            *out++ = '=';
+            *out++ = '=';
+        } else if (length == 2) {
+            *out++ = ALPHABET[input[0] >> 2];
+            *out++ = ALPHABET[((input[0] & 0x03) << 4) | (input[1] >> 4)];
+            *out++ = ALPHABET[(input[1] & 0x0F) << 2];
+            *out++ = '=';
+        }
+
+        return out;
+    }
+
+} // namespace byoa
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "bridge-stats.hpp"
+#include "logger.hpp"
+
+namespace byoa {
+
+    namespace {
+
+        constexpr std::chrono::seconds DEFAULT_DUMP_INTERVAL{300};
+
+        void raiseTo(std::atomic<uint64_t> &target, uint64_t value) {
+            auto current = target.load(std::memory_order_relaxed);
+            while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+            }
+        }
+
+    } // namespace
+
+    void BridgeStats::Histogram::record(uint64_t value) {
+        auto bucket = std::min<std::size_t>(std::bit_width(value), BUCKETS - 1);
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        _total.fetch_add(value, std::memory_order_relaxed);
+        raiseTo(_max, value);
+    }
+
+    nlohmann::json BridgeStats::Histogram::summary() const {
+        std::array<uint64_t, BUCKETS> counts;
+        uint64_t count = 0;
+        for (std::size_t i = 0; i < BUCKETS; i++) {
+            counts[i] = _buckets[i].load(std::memory_order_relaxed);
+            count += counts[i];
+        }
+        auto max = _max.load(std::memory_order_relaxed);
+
+        auto percentile = [&](double fraction) -> uint64_t {
+            auto rank     = static_cast<uint64_t>(fraction * count);
+            uint64_t seen = 0;
+            for (std::size_t i = 0; i < BUCKETS; i++) {
+                seen += counts[i];
+                if (seen > rank) {
+                    return std::min(i == 0 ? 0 : (uint64_t{1} << i) - 1, max);
+                }
+            }
+            return max;
+        };
+
+        return {
+            {"count", count},
+            {"avg", count ? static_cast<double>(_total.load(std::memory_order_relaxed)) / count : 0.0},
+            {"p50", percentile(0.50)},
+            {"p90", percentile(0.90)},
+            {"p99", percentile(0.99)},
+            {"max", max},
+        };
+    }
+
+    BridgeStats::Function::Clock::time_point BridgeStats::Function::begin(std::size_t argumentBytes) {
+        _calls.fetch_add(1, std::memory_order_relaxed);
+        _inFlight.fetch_add(1, std::memory_order_relaxed);
+        _argumentBytes.record(argumentBytes);
+        return Clock::now();
+    }
+
+    void BridgeStats::Function::end(Clock::time_point started, std::size_t resultBytes, bool failed) {
+        _latencyMicros.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count());
+        _inFlight.fetch_sub(1, std::memory_order_relaxed);
+        if (failed) {
+            _failed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            _resultBytes.record(resultBytes);
+        }
+    }
+
+    nlohmann::json BridgeStats::Function::summary() const {
+        return {
+            {"calls", _calls.load(std::memory_order_relaxed)},
+            {"inFlight", _inFlight.load(std::memory_order_relaxed)},
+            {"failed", _failed.load(std::memory_order_relaxed)},
+            {"latencyUs", _latencyMicros.summary()},
+            {"argumentBytes", _argumentBytes.summary()},
+            {"resultBytes", _resultBytes.summary()},
+        };
+    }
+
+    struct BridgeStats::State {
+        std::mutex mutex;
+        // Functions are only added (at expose time), so references handed out stay valid
+        std::map<std::string, std::unique_ptr<Function>> functions;
+
+        std::condition_variable wake;
+        std::chrono::seconds interval = DEFAULT_DUMP_INTERVAL;
+        bool stop                     = false;
+        std::thread dumper;
+
+        ~State() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            wake.notify_one();
+            if (dumper.joinable()) {
+                dumper.join();
+            }
+        }
+    };
+
+    BridgeStats::State &BridgeStats::state() {
+        static State instance;
+        return instance;
+    }
+
+    BridgeStats::Function &BridgeStats::function(const std::string &name) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto &function = s.functions[name];
+        if (!function) {
+            function = std::make_unique<Function>();
+        }
+        return *function;
+    }
+
+    std::string BridgeStats::statsJson() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        nlohmann::json result = nlohmann::json::object();
+        for (const auto &[name, function] : s.functions) {
+            if (function->calls()) {
+                result[name] = function->summary();
+            }
+        }
+        return result.dump();
+    }
+
+    void BridgeStats::logSummary() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto &[name, function] : s.functions) {
+            if (!function->calls()) {
+                continue;
+            }
+            auto summary        = function->summary();
+            const auto &latency = summary["latencyUs"];
+            Logger::getInstance().info("BridgeStats: {} calls={} inFlight={} failed={} p50={}us p99={}us max={}us args~{}B result~{}B",
+                                       name, summary["calls"].dump(), summary["inFlight"].dump(), summary["failed"].dump(),
+                                       latency["p50"].dump(), latency["p99"].dump(), latency["max"].dump(),
+                                       static_cast<uint64_t>(summary["argumentBytes"]["avg"].get<double>()),
+                                       static_cast<uint64_t>(summary["resultBytes"]["avg"].get<double>()));
+        }
+    }
+
+    void BridgeStats::configureFromEnvironment() {
+        auto &s             = state();
+        const char *seconds = std::getenv("BYOA_BRIDGE_STATS_SECONDS");
+        if (seconds && *seconds) {
+            s.interval = std::chrono::seconds(std::strtol(seconds, nullptr, 10));
+        }
+        if (s.interval <= std::chrono::seconds::zero() || s.dumper.joinable()) {
+            return;
+        }
+
+        s.dumper = std::thread([&s] {
+            uint64_t logged = 0;
+            std::unique_lock<std::mutex> lock(s.mutex);
+            while (!s.wake.wait_for(lock, s.interval, [&s] { return s.stop; })) {
+                uint64_t calls = 0;
+                for (const auto &[name, function] : s.functions) {
+                    calls += function->calls();
+                }
+                // Quiet while the app is idle
+                if (calls == logged) {
+                    continue;
+                }
+                logged = calls;
+                lock.unlock();
+                logSummary();
+                lock.lock();
+            }
+        });
+        Logger::getInstance().info("BridgeStats::configureFromEnvironment: Logging bridge stats every {} s", s.interval.count());
+    }
+
+} // namespace byoa
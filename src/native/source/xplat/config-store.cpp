@@ -0,0 +1,651 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "app-paths.hpp"
+#include "config-store.hpp"
+#include "logger.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        constexpr char MAGIC[8] = {'B', 'Y', 'O', 'A', 'C', 'F', 'G', '\0'};
+
+        // Followed by `count` records of [u32 key length][key][u32 value length][value]
+        struct Header {
+            char magic[8];
+            uint32_t format;
+            uint32_t count;
+            uint64_t revision;
+            uint64_t payloadBytes;
+            // FNV-1a of the payload
+            uint64_t checksum;
+        };
+
+        uint64_t fnv1a(std::string_view data) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (unsigned char c : data) {
+                hash = (hash ^ c) * 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        int64_t microsSince(Clock::time_point started) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+        }
+
+        std::error_code lastError() {
+#ifdef _WIN32
+            return {static_cast<int>(GetLastError()), std::system_category()};
+#else
+            return {errno, std::generic_category()};
+#endif
+        }
+
+        // Write @p bytes to a new @p path and flush them to the disk
+        std::error_code writeDurably(const std::filesystem::path &path, std::string_view bytes) {
+#ifdef _WIN32
+            HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                return lastError();
+            }
+            DWORD written = 0;
+            bool ok       = WriteFile(file, bytes.data(), static_cast<DWORD>(bytes.size()), &written, nullptr) && written == bytes.size();
+            ok            = ok && FlushFileBuffers(file);
+            auto error    = ok ? std::error_code() : lastError();
+            CloseHandle(file);
+            return error;
+#else
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                return lastError();
+            }
+            std::error_code error;
+            while (!bytes.empty() && !error) {
+                auto written = ::write(fd, bytes.data(), bytes.size());
+                if (written > 0) {
+                    bytes.remove_prefix(static_cast<std::size_t>(written));
+                } else if (written == 0 || errno != EINTR) {
+                    error = written == 0 ? std::make_error_code(std::errc::io_error) : lastError();
+                }
+            }
+            if (!error && ::fsync(fd) != 0) {
+                error = lastError();
+            }
+            if (::close(fd) != 0 && !error) {
+                error = lastError();
+            }
+            return error;
+#endif
+        }
+
+        // Rename @p from over @p to, and only return once the rename itself survives a crash
+        std::error_code replaceDurably(const std::filesystem::path &from, const std::filesystem::path &to) {
+#ifdef _WIN32
+            if (!MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+                return lastError();
+            }
+            return {};
+#else
+            if (std::rename(from.c_str(), to.c_str()) != 0) {
+                return lastError();
+            }
+            // The new directory entry is only on disk once the directory is flushed too
+            int dir = ::open(to.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (dir < 0) {
+                return lastError();
+            }
+            auto error = ::fsync(dir) == 0 ? std::error_code() : lastError();
+            ::close(dir);
+            return error;
+#endif
+        }
+
+        // Read-only mapping of a whole file; empty if it doesn't exist
+        class Mapping {
+          public:
+            explicit Mapping(const std::filesystem::path &path) {
+#ifdef _WIN32
+                HANDLE handle =
+                    CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (handle == INVALID_HANDLE_VALUE) {
+                    return;
+                }
+                _opened = true;
+                LARGE_INTEGER size;
+                GetFileSizeEx(handle, &size);
+                _size = static_cast<std::size_t>(size.QuadPart);
+                if (_size) {
+                    _mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                }
+                CloseHandle(handle);
+                if (_mapping) {
+                    _data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+                }
+#else
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return;
+                }
+                _opened = true;
+                struct stat info {};
+                fstat(fd, &info);
+                _size      = static_cast<std::size_t>(info.st_size);
+                void *data = _size ? mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+                ::close(fd);
+                _data = data == MAP_FAILED ? nullptr : static_cast<const char *>(data);
+#endif
+                if (!_data) {
+                    _size = 0;
+                }
+            }
+
+            ~Mapping() {
+#ifdef _WIN32
+                if (_data) {
+                    UnmapViewOfFile(_data);
+                }
+                if (_mapping) {
+                    CloseHandle(_mapping);
+                }
+#else
+                if (_data) {
+                    munmap(const_cast<char *>(_data), _size);
+                }
+#endif
+            }
+
+            Mapping(const Mapping &)            = delete;
+            Mapping &operator=(const Mapping &) = delete;
+
+            // Whether the file exists, even if it is empty
+            bool opened() const {
+                return _opened;
+            }
+
+            std::string_view view() const {
+                return {_data ? _data : "", _size};
+            }
+
+          private:
+            const char *_data = nullptr;
+            std::size_t _size = 0;
+            void *_mapping    = nullptr;
+            bool _opened      = false;
+        };
+
+        // What a generation of the settings file turned out to hold
+        enum class Generation { Missing, Decoded, Corrupt, Newer };
+
+        Generation decode(std::string_view file, uint32_t formatVersion, uint64_t &revision,
+                          std::unordered_map<std::string, std::string> &values, std::string &error) {
+            Header header;
+            if (file.empty()) {
+                // What a crash before the data reached the disk leaves behind
+                error = "empty file";
+                return Generation::Corrupt;
+            }
+            if (file.size() < sizeof(header)) {
+                error = "truncated header";
+                return Generation::Corrupt;
+            }
+            std::memcpy(&header, file.data(), sizeof(header));
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+                error = "not a settings file";
+                return Generation::Corrupt;
+            }
+            if (header.format > formatVersion) {
+                error = "written by a newer version (format " + std::to_string(header.format) + ")";
+                return Generation::Newer;
+            }
+
+            auto payload = file.substr(sizeof(header));
+            if (payload.size() != header.payloadBytes || fnv1a(payload) != header.checksum) {
+                error = "checksum mismatch";
+                return Generation::Corrupt;
+            }
+
+            auto take = [&](std::string_view &out) {
+                uint32_t length;
+                if (payload.size() < sizeof(length)) {
+                    return false;
+                }
+                std::memcpy(&length, payload.data(), sizeof(length));
+                payload.remove_prefix(sizeof(length));
+                if (payload.size() < length) {
+                    return false;
+                }
+                out = payload.substr(0, length);
+                payload.remove_prefix(length);
+                return true;
+            };
+
+            values.reserve(header.count);
+            for (uint32_t i = 0; i < header.count; i++) {
+                std::string_view key, value;
+                if (!take(key) || !take(value)) {
+                    error = "truncated record";
+                    return Generation::Corrupt;
+                }
+                values.emplace(key, value);
+            }
+            revision = header.revision;
+            return Generation::Decoded;
+        }
+
+        // Map and decode the file at @p path; values and revision are left empty unless it decoded
+        Generation read(const std::filesystem::path &path, uint32_t formatVersion, uint64_t &revision,
+                        std::unordered_map<std::string, std::string> &values, std::size_t &bytes) {
+            Mapping mapping(path);
+            if (!mapping.opened()) {
+                return Generation::Missing;
+            }
+            auto file = mapping.view();
+            bytes     = file.size();
+
+            std::string error;
+            auto generation = decode(file, formatVersion, revision, values, error);
+            if (generation != Generation::Decoded) {
+                Logger::getInstance().error("ConfigStore::load: Ignoring {}: {}", path.string(), error);
+                values.clear();
+                revision = 0;
+            }
+            return generation;
+        }
+
+        std::string encode(const std::unordered_map<std::string, std::string> &values, uint32_t formatVersion, uint64_t revision) {
+            std::size_t size = sizeof(Header);
+            for (const auto &[key, value] : values) {
+                size += 2 * sizeof(uint32_t) + key.size() + value.size();
+            }
+
+            std::string bytes(sizeof(Header), '\0');
+            bytes.reserve(size);
+            auto put = [&](std::string_view data) {
+                auto length = static_cast<uint32_t>(data.size());
+                bytes.append(reinterpret_cast<const char *>(&length), sizeof(length));
+                bytes.append(data);
+            };
+            for (const auto &[key, value] : values) {
+                put(key);
+                put(value);
+            }
+
+            Header header;
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.format       = formatVersion;
+            header.count        = static_cast<uint32_t>(values.size());
+            header.revision     = revision;
+            header.payloadBytes = bytes.size() - sizeof(Header);
+            header.checksum     = fnv1a(std::string_view(bytes).substr(sizeof(Header)));
+            std::memcpy(bytes.data(), &header, sizeof(header));
+            return bytes;
+        }
+
+        // Vault holds a config's keys as {"apiKey": ..., "pool": [...]}
+        json secretsOf(json &config) {
+            json secrets = json::object();
+            if (config.contains("apiKey") && config["apiKey"].is_string() && !config["apiKey"].get_ref<const std::string &>().empty()) {
+                secrets["apiKey"] = std::exchange(config["apiKey"], "");
+            }
+            if (config.contains("pool") && config["pool"].is_array()) {
+                json pool = json::array();
+                bool any  = false;
+                for (auto &endpoint : config["pool"]) {
+                    if (endpoint.is_object() && endpoint.contains("apiKey") && endpoint["apiKey"].is_string()) {
+                        any |= !endpoint["apiKey"].get_ref<const std::string &>().empty();
+                        pool.push_back(std::exchange(endpoint["apiKey"], ""));
+                    } else {
+                        pool.push_back("");
+                    }
+                }
+                if (any) {
+                    secrets["pool"] = std::move(pool);
+                }
+            }
+            return secrets;
+        }
+
+        // Configs normally carry an id; fall back to the position for ones that don't
+        std::string idOf(const json &config, std::size_t index) {
+            auto id = config.value("id", std::string());
+            return id.empty() ? "#" + std::to_string(index) : id;
+        }
+
+    } // namespace
+
+    struct ConfigStore::Store {
+        std::mutex mutex;
+        bool loaded = false;
+        // Set when the file can't be understood; writes would destroy it
+        bool readOnly = false;
+        // Set when the file was unusable and the backup was loaded instead; the next write must not rotate it over the backup
+        bool keepBackup = false;
+        std::unordered_map<std::string, std::string> values;
+        uint64_t revision = 0;
+
+        // Serialises file writes, so an older snapshot never replaces a newer one
+        std::mutex writeMutex;
+        uint64_t written = 0;
+
+        // Callers hold the mutex
+        void loadLocked() {
+            if (loaded) {
+                return;
+            }
+            loaded = true;
+
+            auto started      = Clock::now();
+            auto path         = AppPaths::dataDir() / FILE_NAME;
+            std::size_t bytes = 0;
+            auto current      = read(path, FORMAT_VERSION, revision, values, bytes);
+            if (current == Generation::Newer) {
+                readOnly = true;
+                return;
+            }
+            if (current != Generation::Decoded) {
+                // A crash can leave the file empty, or missing between the two renames of a commit
+                auto backup = path;
+                backup += BACKUP_SUFFIX;
+                std::size_t backupBytes = 0;
+                if (read(backup, FORMAT_VERSION, revision, values, backupBytes) == Generation::Decoded) {
+                    Logger::getInstance().warn("ConfigStore::load: Recovered revision {} from {}", revision, backup.string());
+                    bytes      = backupBytes;
+                    keepBackup = current == Generation::Corrupt;
+                } else if (current == Generation::Corrupt && bytes > 0) {
+                    readOnly = true;
+                    return;
+                } else {
+                    // Nothing was ever completely written
+                    return;
+                }
+            }
+            written = revision;
+            Logger::getInstance().info("ConfigStore::load: Loaded {} settings ({} bytes, revision {}) in {} us", values.size(), bytes,
+                                       revision, microsSince(started));
+        }
+    };
+
+    ConfigStore::Store &ConfigStore::store() {
+        static Store instance;
+        return instance;
+    }
+
+    bool ConfigStore::commit(const Values &values) {
+        auto &s = store();
+        std::string bytes;
+        uint64_t revision;
+        bool rotate;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.loadLocked();
+            if (s.readOnly) {
+                Logger::getInstance().error("ConfigStore::commit: Settings file is unreadable, not overwriting it");
+                return false;
+            }
+            for (const auto &[key, value] : values) {
+                if (value) {
+                    s.values[key] = *value;
+                } else {
+                    s.values.erase(key);
+                }
+            }
+            revision = ++s.revision;
+            bytes    = encode(s.values, FORMAT_VERSION, revision);
+            rotate   = !s.keepBackup;
+        }
+
+        std::lock_guard<std::mutex> lock(s.writeMutex);
+        if (revision <= s.written) {
+            return true;
+        }
+
+        // Temporary file and rename like the connection cache, but flushed: otherwise the rename can reach the
+        // disk before the data, and a crash leaves an empty file
+        auto started   = Clock::now();
+        auto path      = AppPaths::dataDir() / FILE_NAME;
+        auto temporary = path;
+        temporary += ".tmp";
+        auto backup = path;
+        backup += BACKUP_SUFFIX;
+        std::error_code ec;
+        if (auto error = writeDurably(temporary, bytes)) {
+            Logger::getInstance().error("ConfigStore::commit: Failed to write {}: {}", temporary.string(), error.message());
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+
+        // The generation being replaced stays as the fallback for a file that turns out unusable
+        if (rotate && std::filesystem::exists(path, ec)) {
+            if (auto error = replaceDurably(path, backup)) {
+                Logger::getInstance().error("ConfigStore::commit: Failed to keep {}: {}", backup.string(), error.message());
+                std::filesystem::remove(temporary, ec);
+                return false;
+            }
+        }
+        if (auto error = replaceDurably(temporary, path)) {
+            Logger::getInstance().error("ConfigStore::commit: Failed to replace {}: {}", path.string(), error.message());
+            return false;
+        }
+        s.written = revision;
+        {
+            std::lock_guard<std::mutex> stateLock(s.mutex);
+            s.keepBackup = false;
+        }
+        Logger::getInstance().info("ConfigStore::commit: Wrote revision {} ({} bytes) in {} us", revision, bytes.size(),
+                                   microsSince(started));
+        return true;
+    }
+
+    std::optional<std::string> ConfigStore::stored(const std::string &key) {
+        auto &s = store();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.loadLocked();
+        auto it = s.values.find(key);
+        return it == s.values.end() ? std::nullopt : std::optional<std::string>(it->second);
+    }
+
+    std::optional<std::string> ConfigStore::get(const std::string &key) {
+        auto value = stored(key);
+        if (value && key == LLM_CONFIGS_KEY) {
+            value = loadSecrets(*value);
+        }
+        return value;
+    }
+
+    bool ConfigStore::set(const std::string &key, const std::string &value) {
+        return setMany({{key, value}});
+    }
+
+    bool ConfigStore::remove(const std::string &key) {
+        if (key == LLM_CONFIGS_KEY && !storeSecrets("[]", stored(key))) {
+            return false;
+        }
+        return commit({{key, std::nullopt}});
+    }
+
+    ConfigStore::Values ConfigStore::getMany(const std::vector<std::string> &keys) {
+        Values values;
+        for (const auto &key : keys) {
+            values[key] = get(key);
+        }
+        return values;
+    }
+
+    bool ConfigStore::setMany(const std::map<std::string, std::string> &values) {
+        Values updates;
+        for (const auto &[key, value] : values) {
+            if (key == LLM_CONFIGS_KEY) {
+                // Saving configs whose keys went nowhere would look fine until the next launch
+                auto withoutKeys = storeSecrets(value, stored(key));
+                if (!withoutKeys) {
+                    Logger::getInstance().error("ConfigStore::setMany: The vault refused the API keys, not saving {}", key);
+                    return false;
+                }
+                updates[key] = std::move(*withoutKeys);
+            } else {
+                updates[key] = value;
+            }
+        }
+        return commit(updates);
+    }
+
+    ConfigStore::Values ConfigStore::snapshot() {
+        return getMany(std::vector<std::string>(SNAPSHOT_KEYS.begin(), SNAPSHOT_KEYS.end()));
+    }
+
+    uint64_t ConfigStore::revision() {
+        auto &s = store();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.loadLocked();
+        return s.revision;
+    }
+
+    std::optional<std::string> ConfigStore::storeSecrets(const std::string &configsJson, const std::optional<std::string> &previous) {
+        json configs = json::parse(configsJson, nullptr, false);
+        if (!configs.is_array()) {
+            return configsJson;
+        }
+
+        std::unordered_set<std::string> accounts;
+        for (std::size_t i = 0; i < configs.size(); i++) {
+            auto &config = configs[i];
+            if (!config.is_object()) {
+                continue;
+            }
+            auto account = SECRETS_PREFIX + idOf(config, i);
+            auto secrets = secretsOf(config);
+            accounts.insert(account);
+
+            // Vault reads are cached, so unchanged keys cost no credential store write, and changed
+            // ones are deferred so typing an API key doesn't wait on the store for every keystroke.
+            // One the store rejects is retried and reported through Vault::statusJson()
+            auto stored = Vault::getData(account);
+            if (secrets.empty()) {
+                if (stored && !Vault::deleteDeferred(account)) {
+                    return std::nullopt;
+                }
+                continue;
+            }
+            auto text = secrets.dump();
+            if (stored != text && !Vault::storeDeferred(account, text)) {
+                return std::nullopt;
+            }
+        }
+
+        // Keys of configs that were removed
+        json before = previous ? json::parse(*previous, nullptr, false) : json();
+        if (before.is_array()) {
+            for (std::size_t i = 0; i < before.size(); i++) {
+                if (!before[i].is_object()) {
+                    continue;
+                }
+                auto account = SECRETS_PREFIX + idOf(before[i], i);
+                if (!accounts.contains(account) && Vault::hasData(account) && !Vault::deleteDeferred(account)) {
+                    return std::nullopt;
+                }
+            }
+        }
+        return configs.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+
+    std::string ConfigStore::loadSecrets(const std::string &configsJson) {
+        json configs = json::parse(configsJson, nullptr, false);
+        if (!configs.is_array()) {
+            return configsJson;
+        }
+
+        std::vector<std::string> accounts;
+        for (std::size_t i = 0; i < configs.size(); i++) {
+            accounts.push_back(configs[i].is_object() ? SECRETS_PREFIX + idOf(configs[i], i) : std::string());
+        }
+        auto secrets = Vault::getMany(accounts);
+
+        for (std::size_t i = 0; i < configs.size(); i++) {
+            auto it = secrets.find(accounts[i]);
+            if (accounts[i].empty() || it == secrets.end() || !it->second) {
+                continue;
+            }
+            json stored = json::parse(*it->second, nullptr, false);
+            if (!stored.is_object()) {
+                continue;
+            }
+            auto &config = configs[i];
+            if (stored.contains("apiKey")) {
+                config["apiKey"] = stored["apiKey"];
+            }
+            if (stored.contains("pool") && stored["pool"].is_array() && config.contains("pool") && config["pool"].is_array()) {
+                auto &pool = config["pool"];
+                for (std::size_t p = 0; p < pool.size() && p < stored["pool"].size(); p++) {
+                    if (pool[p].is_object()) {
+                        pool[p]["apiKey"] = stored["pool"][p];
+                    }
+                }
+            }
+        }
+        return configs.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+
+    void ConfigStore::migrateFromVault() {
+        {
+            // Every write bumps the revision, so 0 means no generation was ever completely written, even if
+            // a crash left an empty file behind
+            auto &s = store();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.loadLocked();
+            if (s.revision > 0 || s.readOnly) {
+                return;
+            }
+        }
+
+        auto started = Clock::now();
+        std::map<std::string, std::string> found;
+        for (auto &[key, value] : Vault::getMany(std::vector<std::string>(SNAPSHOT_KEYS.begin(), SNAPSHOT_KEYS.end()))) {
+            if (value) {
+                found[key] = std::move(*value);
+            }
+        }
+
+        // Writes the file even with nothing to move, which marks the migration done
+        if (!setMany(found)) {
+            Logger::getInstance().error("ConfigStore::migrateFromVault: Failed to save settings, leaving them in the vault");
+            return;
+        }
+
+        // setMany only queued the llm_secrets:* items; the old blobs hold the only stored copy of the keys until they land
+        if (!Vault::flushAsync().get()) {
+            Logger::getInstance().error("ConfigStore::migrateFromVault: Failed to store API keys, leaving settings in the vault");
+            // Without the file the migration runs again on the next launch
+            std::error_code ec;
+            std::filesystem::remove(AppPaths::dataDir() / FILE_NAME, ec);
+            return;
+        }
+        for (const auto &[key, value] : found) {
+            Vault::deleteData(key);
+        }
+        Logger::getInstance().info("ConfigStore::migrateFromVault: Moved {} settings out of the vault in {} us", found.size(),
+                                   microsSince(started));
+    }
+
+} // namespace byoa
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <set>
+#include <system_error>
+
+#include "app-paths.hpp"
+#include "connection-cache.hpp"
+#include "logger.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        // How long a persisted address is trusted after it was last connected to
+        constexpr std::chrono::seconds ADDRESS_TTL = std::chrono::minutes(30);
+        constexpr const char *CACHE_FILE           = "connection-cache.json";
+
+        struct Address {
+            std::string ip;
+            int64_t expires = 0;
+        };
+
+        struct State {
+            CURLSH *share = nullptr;
+            std::array<std::mutex, CURL_LOCK_DATA_LAST> locks;
+
+            std::mutex mutex;
+            // "host:port" -> last address connected to
+            std::map<std::string, Address> addresses;
+            // Hosts whose persisted address was already handed to curl this run
+            std::set<std::string> injected;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        int64_t unixNow() {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        void lockShare(CURL *, curl_lock_data data, curl_lock_access, void *) {
+            state().locks[data].lock();
+        }
+
+        void unlockShare(CURL *, curl_lock_data data, void *) {
+            state().locks[data].unlock();
+        }
+
+        std::string toHex(const unsigned char *data, std::size_t length) {
+            static constexpr char digits[] = "0123456789abcdef";
+            std::string hex(length * 2, '\0');
+            for (std::size_t i = 0; i < length; i++) {
+                hex[i * 2]     = digits[data[i] >> 4];
+                hex[i * 2 + 1] = digits[data[i] & 0x0f];
+            }
+            return hex;
+        }
+
+        std::string fromHex(const std::string &hex) {
+            auto nibble = [](char c) -> int {
+                if (c >= '0' && c <= '9') {
+                    return c - '0';
+                }
+                if (c >= 'a' && c <= 'f') {
+                    return c - 'a' + 10;
+                }
+                return -1;
+            };
+
+            std::string data(hex.size() / 2, '\0');
+            for (std::size_t i = 0; i < data.size(); i++) {
+                int high = nibble(hex[i * 2]);
+                int low  = nibble(hex[i * 2 + 1]);
+                if (high < 0 || low < 0) {
+                    return "";
+                }
+                data[i] = static_cast<char>((high << 4) | low);
+            }
+            return data;
+        }
+
+        // "host:port" as used by CURLOPT_RESOLVE, with the scheme's default port filled in
+        std::optional<std::string> hostKey(const std::string &url) {
+            CURLU *parsed = curl_url();
+            std::optional<std::string> key;
+            char *host = nullptr;
+            char *port = nullptr;
+            if (curl_url_set(parsed, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+                curl_url_get(parsed, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+                curl_url_get(parsed, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK) {
+                key = std::string(host) + ":" + port;
+            }
+            curl_free(host);
+            curl_free(port);
+            curl_url_cleanup(parsed);
+            return key;
+        }
+
+        CURLcode exportSession(CURL *, void *userptr, const char *sessionKey, const unsigned char *shmac, size_t shmacLength,
+                               const unsigned char *sdata, size_t sdataLength, curl_off_t validUntil, int, const char *, size_t) {
+            if (validUntil <= unixNow()) {
+                return CURLE_OK;
+            }
+
+            auto &sessions = *static_cast<json *>(userptr);
+            sessions.push_back({
+                {"key", sessionKey},
+                {"shmac", toHex(shmac, shmacLength)},
+                {"data", toHex(sdata, sdataLength)},
+                {"validUntil", static_cast<int64_t>(validUntil)},
+            });
+            return CURLE_OK;
+        }
+
+    } // namespace
+
+    void ConnectionCache::load() {
+        auto &s = state();
+        if (s.share) {
+            return;
+        }
+
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        s.share = curl_share_init();
+        curl_share_setopt(s.share, CURLSHOPT_LOCKFUNC, lockShare);
+        curl_share_setopt(s.share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+        curl_share_setopt(s.share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(s.share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+
+        std::ifstream file(AppPaths::dataDir() / CACHE_FILE);
+        if (!file) {
+            Logger::getInstance().info("ConnectionCache::load: No cache file, starting cold");
+            return;
+        }
+
+        std::size_t addressCount = 0;
+        std::size_t sessionCount = 0;
+        try {
+            json j      = json::parse(file);
+            int64_t now = unixNow();
+
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                for (const auto &entry : j.value("addresses", json::array())) {
+                    Address address{entry.value("ip", ""), entry.value("expires", int64_t{0})};
+                    if (!address.ip.empty() && address.expires > now) {
+                        s.addresses[entry.value("host", "")] = std::move(address);
+                        addressCount++;
+                    }
+                }
+            }
+
+            CURL *handle = curl_easy_init();
+            curl_easy_setopt(handle, CURLOPT_SHARE, s.share);
+            for (const auto &entry : j.value("sessions", json::array())) {
+                if (entry.value("validUntil", int64_t{0}) <= now) {
+                    continue;
+                }
+
+                std::string key   = entry.value("key", "");
+                std::string shmac = fromHex(entry.value("shmac", ""));
+                std::string data  = fromHex(entry.value("data", ""));
+                CURLcode rc       = curl_easy_ssls_import(handle, key.c_str(), reinterpret_cast<const unsigned char *>(shmac.data()),
+                                                          shmac.size(), reinterpret_cast<const unsigned char *>(data.data()), data.size());
+                if (rc == CURLE_NOT_BUILT_IN) {
+                    Logger::getInstance().warn("ConnectionCache::load: TLS session import not supported by this curl build");
+                    break;
+                }
+                if (rc == CURLE_OK) {
+                    sessionCount++;
+                }
+            }
+            curl_easy_cleanup(handle);
+        } catch (const json::exception &e) {
+            Logger::getInstance().error("ConnectionCache::load: JSON parse error: {}", e.what());
+        }
+
+        Logger::getInstance().info("ConnectionCache::load: {} addresses, {} TLS sessions", addressCount, sessionCount);
+    }
+
+    void ConnectionCache::save() {
+        auto &s = state();
+        if (!s.share) {
+            return;
+        }
+
+        json sessions = json::array();
+        CURL *handle  = curl_easy_init();
+        curl_easy_setopt(handle, CURLOPT_SHARE, s.share);
+        CURLcode rc = curl_easy_ssls_export(handle, exportSession, &sessions);
+        curl_easy_cleanup(handle);
+        if (rc != CURLE_OK) {
+            Logger::getInstance().warn("ConnectionCache::save: TLS session export failed: {}", curl_easy_strerror(rc));
+        }
+
+        json addresses = json::array();
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            int64_t now = unixNow();
+            for (const auto &[host, address] : s.addresses) {
+                if (address.expires > now) {
+                    addresses.push_back({{"host", host}, {"ip", address.ip}, {"expires", address.expires}});
+                }
+            }
+        }
+
+        // Write to a temporary file first so a crash never leaves a truncated cache behind
+        auto path      = AppPaths::dataDir() / CACHE_FILE;
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            file << json{{"addresses", addresses}, {"sessions", sessions}}.dump();
+            if (!file) {
+                Logger::getInstance().error("ConnectionCache::save: Failed to write {}", temporary.string());
+                return;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temporary, path, ec);
+        if (ec) {
+            Logger::getInstance().error("ConnectionCache::save: Failed to replace {}: {}", path.string(), ec.message());
+            return;
+        }
+
+        Logger::getInstance().info("ConnectionCache::save: {} addresses, {} TLS sessions", addresses.size(), sessions.size());
+    }
+
+    ConnectionCache::ResolveList ConnectionCache::attach(CURL *handle, const std::string &url) {
+        ResolveList resolve{nullptr, curl_slist_free_all};
+
+        auto &s = state();
+        if (!s.share) {
+            return resolve;
+        }
+        curl_easy_setopt(handle, CURLOPT_SHARE, s.share);
+
+        auto key = hostKey(url);
+        if (!key) {
+            return resolve;
+        }
+
+        std::string entry;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto it = s.addresses.find(*key);
+            if (it == s.addresses.end() || it->second.expires <= unixNow() || !s.injected.insert(*key).second) {
+                return resolve;
+            }
+
+            const std::string &ip = it->second.ip;
+            // '+' makes the entry age out of curl's DNS cache like a regular lookup
+            entry = "+" + *key + ":" + (ip.find(':') != std::string::npos ? "[" + ip + "]" : ip);
+        }
+
+        resolve.reset(curl_slist_append(nullptr, entry.c_str()));
+        curl_easy_setopt(handle, CURLOPT_RESOLVE, resolve.get());
+        Logger::getInstance().info("ConnectionCache::attach: Using persisted address for {}", *key);
+        return resolve;
+    }
+
+    void ConnectionCache::record(CURL *handle, const std::string &url) {
+        char *ip = nullptr;
+        if (curl_easy_getinfo(handle, CURLINFO_PRIMARY_IP, &ip) != CURLE_OK || !ip || !*ip) {
+            return;
+        }
+
+        auto key = hostKey(url);
+        if (!key) {
+            return;
+        }
+
+        curl_off_t lookup     = 0;
+        curl_off_t connect    = 0;
+        curl_off_t appConnect = 0;
+        curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &lookup);
+        curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+        Logger::getInstance().info("ConnectionCache::record: {} dns: {} us, tcp: {} us, tls: {} us", *key, lookup,
+                                   std::max<curl_off_t>(connect - lookup, 0), std::max<curl_off_t>(appConnect - connect, 0));
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.addresses[*key] = Address{ip, unixNow() + ADDRESS_TTL.count()};
+    }
+
+} // namespace byoa
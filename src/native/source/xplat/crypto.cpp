@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include "crypto.hpp"
+
+namespace byoa {
+
+    namespace {
+
+        uint32_t load32le(const uint8_t *p) {
+            return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+        }
+
+        void store32le(uint8_t *p, uint32_t v) {
+            p[0] = uint8_t(v);
+            p[1] = uint8_t(v >> 8);
+            p[2] = uint8_t(v >> 16);
+            p[3] = uint8_t(v >> 24);
+        }
+
+        uint32_t rotl(uint32_t v, int n) {
+            return (v << n) | (v >> (32 - n));
+        }
+
+        uint32_t rotr(uint32_t v, int n) {
+            return (v >> n) | (v << (32 - n));
+        }
+
+        // ===== SHA-256 =====
+
+        constexpr uint32_t SHA256_K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+            0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+            0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+            0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+            0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+            0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        class Sha256 {
+          public:
+            void update(std::string_view data) {
+                auto *p = reinterpret_cast<const uint8_t *>(data.data());
+                auto n  = data.size();
+                _length += n;
+                while (n > 0) {
+                    auto take = std::min<std::size_t>(n, 64 - _used);
+                    std::memcpy(_block + _used, p, take);
+                    _used += take;
+                    p += take;
+                    n -= take;
+                    if (_used == 64) {
+                        compress();
+                        _used = 0;
+                    }
+                }
+            }
+
+            Crypto::Digest finish() {
+                uint64_t bits = _length * 8;
+                _block[_used++] = 0x80;
+                if (_used > 56) {
+                    std::memset(_block + _used, 0, 64 - _used);
+                    compress();
+                    _used = 0;
+                }
+                std::memset(_block + _used, 0, 56 - _used);
+                for (int i = 0; i < 8; i++) {
+                    _block[63 - i] = uint8_t(bits >> (8 * i));
+                }
+                compress();
+
+                Crypto::Digest digest;
+                for (int i = 0; i < 8; i++) {
+                    digest[4 * i]     = uint8_t(_h[i] >> 24);
+                    digest[4 * i + 1] = uint8_t(_h[i] >> 16);
+                    digest[4 * i + 2] = uint8_t(_h[i] >> 8);
+                    digest[4 * i + 3] = uint8_t(_h[i]);
+                }
+                return digest;
+            }
+
+          private:
+            void compress() {
+                uint32_t w[64];
+                for (int i = 0; i < 16; i++) {
+                    w[i] = uint32_t(_block[4 * i]) << 24 | uint32_t(_block[4 * i + 1]) << 16 | uint32_t(_block[4 * i + 2]) << 8 |
+                           uint32_t(_block[4 * i + 3]);
+                }
+                for (int i = 16; i < 64; i++) {
+                    auto s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                    auto s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                    w[i]    = w[i - 16] + s0 + w[i - 7] + s1;
+                }
+
+                uint32_t a = _h[0], b = _h[1], c = _h[2], d = _h[3], e = _h[4], f = _h[5], g = _h[6], h = _h[7];
+                for (int i = 0; i < 64; i++) {
+                    auto t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+                    auto t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                    h       = g;
+                    g       = f;
+                    f       = e;
+                    e       = d + t1;
+                    d       = c;
+                    c       = b;
+                    b       = a;
+                    a       = t1 + t2;
+                }
+                _h[0] += a;
+                _h[1] += b;
+                _h[2] += c;
+                _h[3] += d;
+                _h[4] += e;
+                _h[5] += f;
+                _h[6] += g;
+                _h[7] += h;
+            }
+
+            uint32_t _h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+            uint8_t _block[64];
+            std::size_t _used = 0;
+            uint64_t _length  = 0;
+        };
+
+        std::string_view view(const Crypto::Digest &digest) {
+            return {reinterpret_cast<const char *>(digest.data()), digest.size()};
+        }
+
+        // ===== ChaCha20 =====
+
+        void quarterRound(uint32_t *x, int a, int b, int c, int d) {
+            x[a] += x[b];
+            x[d] = rotl(x[d] ^ x[a], 16);
+            x[c] += x[d];
+            x[b] = rotl(x[b] ^ x[c], 12);
+            x[a] += x[b];
+            x[d] = rotl(x[d] ^ x[a], 8);
+            x[c] += x[d];
+            x[b] = rotl(x[b] ^ x[c], 7);
+        }
+
+        void chachaBlock(const Crypto::Key &key, uint32_t counter, const Crypto::Nonce &nonce, uint8_t out[64]) {
+            uint32_t state[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+            for (int i = 0; i < 8; i++) {
+                state[4 + i] = load32le(key.data() + 4 * i);
+            }
+            state[12] = counter;
+            for (int i = 0; i < 3; i++) {
+                state[13 + i] = load32le(nonce.data() + 4 * i);
+            }
+
+            uint32_t x[16];
+            std::memcpy(x, state, sizeof(x));
+            for (int round = 0; round < 10; round++) {
+                quarterRound(x, 0, 4, 8, 12);
+                quarterRound(x, 1, 5, 9, 13);
+                quarterRound(x, 2, 6, 10, 14);
+                quarterRound(x, 3, 7, 11, 15);
+                quarterRound(x, 0, 5, 10, 15);
+                quarterRound(x, 1, 6, 11, 12);
+                quarterRound(x, 2, 7, 8, 13);
+                quarterRound(x, 3, 4, 9, 14);
+            }
+            for (int i = 0; i < 16; i++) {
+                store32le(out + 4 * i, x[i] + state[i]);
+            }
+        }
+
+        void chachaXor(const Crypto::Key &key, uint32_t counter, const Crypto::Nonce &nonce, const uint8_t *in, uint8_t *out,
+                       std::size_t size) {
+            uint8_t stream[64];
+            for (std::size_t offset = 0; offset < size; offset += 64, counter++) {
+                chachaBlock(key, counter, nonce, stream);
+                auto n = std::min<std::size_t>(64, size - offset);
+                for (std::size_t i = 0; i < n; i++) {
+                    out[offset + i] = in[offset + i] ^ stream[i];
+                }
+            }
+        }
+
+        // ===== Poly1305 (26-bit limbs, so only 64-bit products are needed) =====
+
+        class Poly1305 {
+          public:
+            explicit Poly1305(const uint8_t key[32]) {
+                _r[0] = load32le(key) & 0x3ffffff;
+                _r[1] = (load32le(key + 3) >> 2) & 0x3ffff03;
+                _r[2] = (load32le(key + 6) >> 4) & 0x3ffc0ff;
+                _r[3] = (load32le(key + 9) >> 6) & 0x3f03fff;
+                _r[4] = (load32le(key + 12) >> 8) & 0x00fffff;
+                for (int i = 0; i < 4; i++) {
+                    _pad[i] = load32le(key + 16 + 4 * i);
+                }
+            }
+
+            // Whole 16-byte blocks; the AEAD construction zero-pads its inputs
+            void update(const uint8_t *data, std::size_t size) {
+                uint8_t block[16];
+                for (std::size_t offset = 0; offset < size; offset += 16) {
+                    auto n = std::min<std::size_t>(16, size - offset);
+                    std::memset(block, 0, sizeof(block));
+                    std::memcpy(block, data + offset, n);
+                    process(block);
+                }
+            }
+
+            void finish(uint8_t tag[16]) {
+                constexpr uint32_t MASK = 0x3ffffff;
+                uint32_t h0 = _h[0], h1 = _h[1], h2 = _h[2], h3 = _h[3], h4 = _h[4];
+
+                uint32_t c = h1 >> 26;
+                h1 &= MASK;
+                h2 += c;
+                c = h2 >> 26;
+                h2 &= MASK;
+                h3 += c;
+                c = h3 >> 26;
+                h3 &= MASK;
+                h4 += c;
+                c = h4 >> 26;
+                h4 &= MASK;
+                h0 += c * 5;
+                c = h0 >> 26;
+                h0 &= MASK;
+                h1 += c;
+
+                // h - p, kept if it did not go negative
+                uint32_t g0 = h0 + 5;
+                c           = g0 >> 26;
+                g0 &= MASK;
+                uint32_t g1 = h1 + c;
+                c           = g1 >> 26;
+                g1 &= MASK;
+                uint32_t g2 = h2 + c;
+                c           = g2 >> 26;
+                g2 &= MASK;
+                uint32_t g3 = h3 + c;
+                c           = g3 >> 26;
+                g3 &= MASK;
+                uint32_t g4 = h4 + c - (1u << 26);
+
+                uint32_t select = (g4 >> 31) - 1;
+                h0              = (h0 & ~select) | (g0 & select);
+                h1              = (h1 & ~select) | (g1 & select);
+                h2              = (h2 & ~select) | (g2 & select);
+                h3              = (h3 & ~select) | (g3 & select);
+                h4              = (h4 & ~select) | (g4 & select);
+
+                uint32_t w0 = h0 | (h1 << 26);
+                uint32_t w1 = (h1 >> 6) | (h2 << 20);
+                uint32_t w2 = (h2 >> 12) | (h3 << 14);
+                uint32_t w3 = (h3 >> 18) | (h4 << 8);
+
+                uint64_t f = uint64_t(w0) + _pad[0];
+                store32le(tag, uint32_t(f));
+                f = uint64_t(w1) + _pad[1] + (f >> 32);
+                store32le(tag + 4, uint32_t(f));
+                f = uint64_t(w2) + _pad[2] + (f >> 32);
+                store32le(tag + 8, uint32_t(f));
+                f = uint64_t(w3) + _pad[3] + (f >> 32);
+                store32le(tag + 12, uint32_t(f));
+            }
+
+          private:
+            void process(const uint8_t block[16]) {
+                constexpr uint32_t MASK = 0x3ffffff;
+                uint32_t r0 = _r[0], r1 = _r[1], r2 = _r[2], r3 = _r[3], r4 = _r[4];
+                uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+
+                uint32_t h0 = _h[0] + (load32le(block) & MASK);
+                uint32_t h1 = _h[1] + ((load32le(block + 3) >> 2) & MASK);
+                uint32_t h2 = _h[2] + ((load32le(block + 6) >> 4) & MASK);
+                uint32_t h3 = _h[3] + ((load32le(block + 9) >> 6) & MASK);
+                uint32_t h4 = _h[4] + ((load32le(block + 12) >> 8) | (1u << 24));
+
+                uint64_t d0 = uint64_t(h0) * r0 + uint64_t(h1) * s4 + uint64_t(h2) * s3 + uint64_t(h3) * s2 + uint64_t(h4) * s1;
+                uint64_t d1 = uint64_t(h0) * r1 + uint64_t(h1) * r0 + uint64_t(h2) * s4 + uint64_t(h3) * s3 + uint64_t(h4) * s2;
+                uint64_t d2 = uint64_t(h0) * r2 + uint64_t(h1) * r1 + uint64_t(h2) * r0 + uint64_t(h3) * s4 + uint64_t(h4) * s3;
+                uint64_t d3 = uint64_t(h0) * r3 + uint64_t(h1) * r2 + uint64_t(h2) * r1 + uint64_t(h3) * r0 + uint64_t(h4) * s4;
+                uint64_t d4 = uint64_t(h0) * r4 + uint64_t(h1) * r3 + uint64_t(h2) * r2 + uint64_t(h3) * r1 + uint64_t(h4) * r0;
+
+                uint64_t c = d0 >> 26;
+                h0         = uint32_t(d0) & MASK;
+                d1 += c;
+                c  = d1 >> 26;
+                h1 = uint32_t(d1) & MASK;
+                d2 += c;
+                c  = d2 >> 26;
+                h2 = uint32_t(d2) & MASK;
+                d3 += c;
+                c  = d3 >> 26;
+                h3 = uint32_t(d3) & MASK;
+                d4 += c;
+                c  = d4 >> 26;
+                h4 = uint32_t(d4) & MASK;
+                h0 += uint32_t(c) * 5;
+                h1 += h0 >> 26;
+                h0 &= MASK;
+
+                _h[0] = h0;
+                _h[1] = h1;
+                _h[2] = h2;
+                _h[3] = h3;
+                _h[4] = h4;
+            }
+
+            uint32_t _r[5];
+            uint32_t _h[5] = {};
+            uint32_t _pad[4];
+        };
+
+        void aeadTag(const Crypto::Key &key, const Crypto::Nonce &nonce, std::string_view aad, const uint8_t *ciphertext, std::size_t size,
+                     uint8_t tag[16]) {
+            uint8_t block[64];
+            chachaBlock(key, 0, nonce, block);
+            Poly1305 poly(block);
+            poly.update(reinterpret_cast<const uint8_t *>(aad.data()), aad.size());
+            poly.update(ciphertext, size);
+            uint8_t lengths[16];
+            for (int i = 0; i < 8; i++) {
+                lengths[i]     = uint8_t(uint64_t(aad.size()) >> (8 * i));
+                lengths[8 + i] = uint8_t(uint64_t(size) >> (8 * i));
+            }
+            poly.update(lengths, sizeof(lengths));
+            poly.finish(tag);
+        }
+
+    } // namespace
+
+    Crypto::Digest Crypto::sha256(std::string_view data) {
+        Sha256 hash;
+        hash.update(data);
+        return hash.finish();
+    }
+
+    Crypto::Digest Crypto::hmacSha256(std::string_view key, std::string_view data) {
+        uint8_t block[64] = {};
+        if (key.size() > sizeof(block)) {
+            auto digest = sha256(key);
+            std::memcpy(block, digest.data(), digest.size());
+        } else {
+            std::memcpy(block, key.data(), key.size());
+        }
+
+        char inner[64], outer[64];
+        for (int i = 0; i < 64; i++) {
+            inner[i] = char(block[i] ^ 0x36);
+            outer[i] = char(block[i] ^ 0x5c);
+        }
+        Sha256 first;
+        first.update({inner, sizeof(inner)});
+        first.update(data);
+        auto innerDigest = first.finish();
+
+        Sha256 second;
+        second.update({outer, sizeof(outer)});
+        second.update(view(innerDigest));
+        return second.finish();
+    }
+
+    Crypto::Key Crypto::pbkdf2(std::string_view secret, std::string_view salt, uint32_t iterations) {
+        // One output block is enough for a 32-byte key
+        std::string first(salt);
+        first += std::string("\0\0\0\1", 4);
+        auto u      = hmacSha256(secret, first);
+        Key derived = u;
+        for (uint32_t i = 1; i < iterations; i++) {
+            u = hmacSha256(secret, view(u));
+            for (std::size_t j = 0; j < derived.size(); j++) {
+                derived[j] ^= u[j];
+            }
+        }
+        return derived;
+    }
+
+    std::string Crypto::seal(const Key &key, const Nonce &nonce, std::string_view aad, std::string_view plaintext) {
+        std::string sealed(plaintext.size() + TAG_SIZE, '\0');
+        auto *out = reinterpret_cast<uint8_t *>(sealed.data());
+        chachaXor(key, 1, nonce, reinterpret_cast<const uint8_t *>(plaintext.data()), out, plaintext.size());
+        aeadTag(key, nonce, aad, out, plaintext.size(), out + plaintext.size());
+        return sealed;
+    }
+
+    std::optional<std::string> Crypto::open(const Key &key, const Nonce &nonce, std::string_view aad, std::string_view sealed) {
+        if (sealed.size() < TAG_SIZE) {
+            return std::nullopt;
+        }
+        auto size      = sealed.size() - TAG_SIZE;
+        const auto *in = reinterpret_cast<const uint8_t *>(sealed.data());
+
+        uint8_t tag[16];
+        aeadTag(key, nonce, aad, in, size, tag);
+        // Constant time, so the comparison leaks nothing about the expected tag
+        uint8_t difference = 0;
+        for (std::size_t i = 0; i < TAG_SIZE; i++) {
+            difference |= tag[i] ^ in[size + i];
+        }
+        if (difference != 0) {
+            return std::nullopt;
+        }
+
+        std::string plaintext(size, '\0');
+        chachaXor(key, 1, nonce, in, reinterpret_cast<uint8_t *>(plaintext.data()), size);
+        return plaintext;
+    }
+
+    std::string Crypto::randomBytes(std::size_t count) {
+        // Backed by the OS CSPRNG in libstdc++, libc++ and MSVC
+        std::random_device device;
+        std::string bytes(count, '\0');
+        for (auto &byte : bytes) {
+            byte = char(device() & 0xff);
+        }
+        return bytes;
+    }
+
+} // namespace byoa
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "endpoint-pool.hpp"
+#include "incremental.hpp"
+#include "logger.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Member {
+            LLM::Endpoint endpoint;
+            std::size_t outstanding = 0;
+            uint64_t requests       = 0;
+            uint64_t errors         = 0;
+            uint64_t ejections      = 0;
+            double ewmaMs           = 0;
+            int consecutiveFailures = 0;
+            Clock::duration backoff = Clock::duration::zero();
+            Clock::time_point ejectedUntil;
+        };
+
+        struct Pool {
+            uint64_t membership = 0;
+            std::size_t next    = 0;
+            std::vector<Member> members;
+        };
+
+        struct State {
+            std::mutex mutex;
+            std::map<std::string, Pool> pools;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        std::vector<LLM::Endpoint> membersOf(const LLM::Config &config) {
+            std::vector<LLM::Endpoint> members{{config.baseURL, config.apiKey, config.socketPath}};
+            for (const auto &endpoint : config.pool) {
+                if (!endpoint.baseURL.empty()) {
+                    members.push_back(endpoint);
+                }
+            }
+            return members;
+        }
+
+        uint64_t membershipOf(const std::vector<LLM::Endpoint> &members) {
+            std::string text;
+            for (const auto &endpoint : members) {
+                text += endpoint.baseURL + '\x1f' + endpoint.apiKey + '\x1f' + endpoint.socketPath + '\x1e';
+            }
+            return Incremental::fingerprint(text);
+        }
+
+        // Never log keys: keep the first and last characters only
+        std::string maskKey(const std::string &key) {
+            return key.size() <= 8 ? std::string(key.size(), '*') : key.substr(0, 3) + "..." + key.substr(key.size() - 4);
+        }
+
+    } // namespace
+
+    EndpointPool::Policy EndpointPool::parsePolicy(const std::string &policy) {
+        if (policy == "least-outstanding") {
+            return Policy::LEAST_OUTSTANDING;
+        }
+        if (policy == "ewma-latency") {
+            return Policy::EWMA_LATENCY;
+        }
+        return Policy::ROUND_ROBIN;
+    }
+
+    EndpointPool::Lease EndpointPool::acquire(const LLM::Config &config) {
+        auto members    = membersOf(config);
+        auto membership = membershipOf(members);
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto &pool = s.pools[config.id];
+        if (pool.membership != membership) {
+            // The pool was edited: start over with fresh metrics
+            pool            = Pool{};
+            pool.membership = membership;
+            for (auto &endpoint : members) {
+                Member member;
+                member.endpoint = std::move(endpoint);
+                pool.members.push_back(std::move(member));
+            }
+        }
+
+        auto now   = Clock::now();
+        auto count = pool.members.size();
+        std::vector<std::size_t> candidates;
+        for (std::size_t i = 0; i < count; i++) {
+            if (pool.members[i].ejectedUntil <= now) {
+                candidates.push_back(i);
+            }
+        }
+        if (candidates.empty()) {
+            // Everyone is ejected: use whoever comes back first rather than failing outright
+            auto soonest = std::min_element(pool.members.begin(), pool.members.end(),
+                                            [](const Member &a, const Member &b) { return a.ejectedUntil < b.ejectedUntil; });
+            candidates.push_back(static_cast<std::size_t>(soonest - pool.members.begin()));
+        }
+
+        std::size_t chosen = candidates.front();
+        switch (parsePolicy(config.poolPolicy)) {
+        case Policy::ROUND_ROBIN: {
+            // First available member at or after the cursor
+            auto it = std::find_if(candidates.begin(), candidates.end(), [&](std::size_t i) { return i >= pool.next % count; });
+            chosen  = it != candidates.end() ? *it : candidates.front();
+            break;
+        }
+        case Policy::LEAST_OUTSTANDING:
+            chosen = *std::min_element(candidates.begin(), candidates.end(), [&](std::size_t a, std::size_t b) {
+                return pool.members[a].outstanding < pool.members[b].outstanding;
+            });
+            break;
+        case Policy::EWMA_LATENCY:
+            // Members without samples score 0, so each one gets tried before latencies are compared
+            chosen = *std::min_element(candidates.begin(), candidates.end(), [&](std::size_t a, std::size_t b) {
+                return pool.members[a].ewmaMs < pool.members[b].ewmaMs;
+            });
+            break;
+        }
+
+        pool.next = chosen + 1;
+        auto &member = pool.members[chosen];
+        member.outstanding++;
+        member.requests++;
+
+        return Lease{config.id, pool.membership, chosen, member.endpoint, now};
+    }
+
+    void EndpointPool::release(const Lease &lease, int status) {
+        auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - lease.started).count();
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.pools.find(lease.poolKey);
+        if (it == s.pools.end() || it->second.membership != lease.membership || lease.member >= it->second.members.size()) {
+            // The pool was rebuilt while the request was in flight; its members start from zero
+            return;
+        }
+
+        auto &member = it->second.members[lease.member];
+        if (member.outstanding > 0) {
+            member.outstanding--;
+        }
+
+        bool failed = status == 0 || status == 429 || status >= 500;
+        if (!failed) {
+            member.ewmaMs              = member.ewmaMs == 0 ? elapsed : EWMA_ALPHA * elapsed + (1 - EWMA_ALPHA) * member.ewmaMs;
+            member.consecutiveFailures = 0;
+            member.backoff             = Clock::duration::zero();
+            return;
+        }
+
+        member.errors++;
+        member.consecutiveFailures++;
+        if (status == 429 || member.consecutiveFailures >= FAILURES_BEFORE_EJECTION) {
+            member.backoff      = member.backoff == Clock::duration::zero() ? Clock::duration(BASE_EJECTION)
+                                                                            : std::min<Clock::duration>(member.backoff * 2, MAX_EJECTION);
+            member.ejectedUntil = Clock::now() + member.backoff;
+            member.ejections++;
+            member.consecutiveFailures = 0;
+            Logger::getInstance().warn("EndpointPool::release: Ejecting {} ({}) for {} s after status {}", member.endpoint.baseURL,
+                                       maskKey(member.endpoint.apiKey),
+                                       std::chrono::duration_cast<std::chrono::seconds>(member.backoff).count(), status);
+        }
+    }
+
+    std::string EndpointPool::statsJson() {
+        auto now = Clock::now();
+        json pools = json::object();
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto &[key, pool] : s.pools) {
+            json members = json::array();
+            for (const auto &member : pool.members) {
+                auto ejectedFor = member.ejectedUntil > now ? member.ejectedUntil - now : Clock::duration::zero();
+                members.push_back({
+                    {"baseURL", member.endpoint.baseURL},
+                    {"key", maskKey(member.endpoint.apiKey)},
+                    {"requests", member.requests},
+                    {"errors", member.errors},
+                    {"outstanding", member.outstanding},
+                    {"ewmaMs", member.ewmaMs},
+                    {"ejections", member.ejections},
+                    {"ejectedForMs", std::chrono::duration_cast<std::chrono::milliseconds>(ejectedFor).count()},
+                });
+            }
+            pools[key] = members;
+        }
+        return pools.dump();
+    }
+
+} // namespace byoa
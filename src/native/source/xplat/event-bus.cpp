@@ -0,0 +1,216 @@
+#include <array>
+#include <bitset>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+#include "event-bus.hpp"
+#include "json-escape.hpp"
+
+namespace byoa {
+
+    namespace events {
+
+        namespace {
+
+            std::string quoted(std::string_view text) {
+                std::string result(JsonEscape::escapedLength(text) + 2, '"');
+                JsonEscape::write(result.data() + 1, text);
+                return result;
+            }
+
+        } // namespace
+
+        std::string WsDelta::json() const {
+            return R"({"requestId":)" + quoted(requestId) + R"(,"message":)" + quoted(message) + "}";
+        }
+
+        std::string PipelineProgress::json() const {
+            return R"({"runId":)" + quoted(runId) + R"(,"stage":)" + std::to_string(stage) + R"(,"delta":)" + quoted(delta) +
+                   R"(,"done":)" + (done ? "true" : "false") + "}";
+        }
+
+    } // namespace events
+
+    struct EventBus::State {
+        struct Endpoint {
+            Deliver deliver;
+            std::bitset<EventRegistry::COUNT> subscriptions;
+            // Set by resubscribe(); until then events are held, the page may not be listening yet
+            bool ready = false;
+            std::deque<std::pair<EventId, std::string>> held;
+        };
+
+        struct Counts {
+            uint64_t published = 0;
+            uint64_t delivered = 0;
+            // Kept for an endpoint whose page had not started yet
+            uint64_t held = 0;
+            // Published with no endpoint listening, or held and never listened for
+            uint64_t dropped = 0;
+        };
+
+        std::mutex mutex;
+        uint64_t nextEndpoint = 1;
+        std::map<uint64_t, Endpoint> endpoints;
+        std::array<Counts, EventRegistry::COUNT> counts;
+
+        // Keep @p data for @p target until its page is ready, dropping the oldest past HELD_LIMIT; called locked
+        void hold(Endpoint &target, EventId id, const std::string &data) {
+            if (target.held.size() == HELD_LIMIT) {
+                counts[static_cast<std::size_t>(target.held.front().first)].dropped++;
+                target.held.pop_front();
+            }
+            target.held.emplace_back(id, data);
+            counts[static_cast<std::size_t>(id)].held++;
+        }
+    };
+
+    EventBus::State &EventBus::state() {
+        static State instance;
+        return instance;
+    }
+
+    uint64_t EventBus::attach(Deliver deliver) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto id = s.nextEndpoint++;
+        s.endpoints[id].deliver = std::move(deliver);
+        return id;
+    }
+
+    void EventBus::detach(uint64_t endpoint) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.endpoints.erase(endpoint);
+    }
+
+    void EventBus::subscribe(uint64_t endpoint, EventId id, bool listening) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.endpoints.find(endpoint);
+        if (it != s.endpoints.end()) {
+            it->second.subscriptions.set(static_cast<std::size_t>(id), listening);
+        }
+    }
+
+    void EventBus::resubscribe(uint64_t endpoint, const std::vector<EventId> &ids) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.endpoints.find(endpoint);
+        if (it == s.endpoints.end()) {
+            return;
+        }
+        auto &target = it->second;
+        target.subscriptions.reset();
+        for (auto id : ids) {
+            target.subscriptions.set(static_cast<std::size_t>(id));
+        }
+        target.ready = true;
+        for (auto &[id, data] : target.held) {
+            auto &counts = s.counts[static_cast<std::size_t>(id)];
+            if (target.subscriptions.test(static_cast<std::size_t>(id))) {
+                target.deliver(id, std::move(data));
+                counts.delivered++;
+            } else {
+                counts.dropped++;
+            }
+        }
+        target.held.clear();
+    }
+
+    void EventBus::reset(uint64_t endpoint) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.endpoints.find(endpoint);
+        if (it != s.endpoints.end()) {
+            it->second.subscriptions.reset();
+            it->second.ready = false;
+        }
+    }
+
+    bool EventBus::unheard(uint64_t endpoint, EventId id) {
+        auto index = static_cast<std::size_t>(id);
+        auto &s    = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto &[key, target] : s.endpoints) {
+            if ((endpoint == 0 || key == endpoint) && (!target.ready || target.subscriptions.test(index))) {
+                return false;
+            }
+        }
+        s.counts[index].published++;
+        s.counts[index].dropped++;
+        return true;
+    }
+
+    std::size_t EventBus::publish(EventId id, const std::string &data) {
+        auto index = static_cast<std::size_t>(id);
+        auto &s    = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto &counts = s.counts[index];
+        counts.published++;
+        std::size_t delivered = 0;
+        bool held             = false;
+        for (auto &[endpoint, target] : s.endpoints) {
+            if (!target.ready) {
+                s.hold(target, id, data);
+                held = true;
+            } else if (target.subscriptions.test(index)) {
+                target.deliver(id, data);
+                delivered++;
+            }
+        }
+        counts.delivered += delivered;
+        counts.dropped += delivered == 0 && !held;
+        return delivered;
+    }
+
+    bool EventBus::send(uint64_t endpoint, EventId id, const std::string &data) {
+        auto index = static_cast<std::size_t>(id);
+        auto &s    = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto &counts = s.counts[index];
+        counts.published++;
+        auto it = s.endpoints.find(endpoint);
+        if (it != s.endpoints.end() && !it->second.ready) {
+            s.hold(it->second, id, data);
+            return false;
+        }
+        if (it == s.endpoints.end() || !it->second.subscriptions.test(index)) {
+            counts.dropped++;
+            return false;
+        }
+        it->second.deliver(id, data);
+        counts.delivered++;
+        return true;
+    }
+
+    std::string EventBus::statsJson() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        nlohmann::json events = nlohmann::json::object();
+        for (std::size_t i = 0; i < EventRegistry::COUNT; i++) {
+            const auto &counts = s.counts[i];
+            if (counts.published) {
+                events[std::string(EventRegistry::TYPES[i])] = {
+                    {"published", counts.published},
+                    {"delivered", counts.delivered},
+                    {"held", counts.held},
+                    {"dropped", counts.dropped},
+                };
+            }
+        }
+        nlohmann::json endpoints = nlohmann::json::object();
+        for (const auto &[id, endpoint] : s.endpoints) {
+            auto &names = endpoints[std::to_string(id)] = nlohmann::json::array();
+            for (std::size_t i = 0; i < EventRegistry::COUNT; i++) {
+                if (endpoint.subscriptions.test(i)) {
+                    names.push_back(EventRegistry::TYPES[i]);
+                }
+            }
+        }
+        return nlohmann::json{{"events", std::move(events)}, {"endpoints", std::move(endpoints)}}.dump();
+    }
+
+} // namespace byoa
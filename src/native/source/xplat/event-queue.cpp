@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+#include "event-queue.hpp"
+#include "json-escape.hpp"
+#include "logger.hpp"
+
+namespace byoa {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        // A listener throwing must not cost the rest of the batch
+        constexpr std::string_view SCRIPT_HEAD = "(function(){var f=window.__nativeCallback;if(!f)return;var q=[";
+        constexpr std::string_view SCRIPT_TAIL =
+            "];for(var i=0;i<q.length;i++){try{f(q[i][0],q[i][1]);}catch(e){console.error('[Events] Listener failed:',e);}}})()";
+
+        char *append(char *out, std::string_view text) {
+            std::memcpy(out, text.data(), text.size());
+            return out + text.size();
+        }
+
+    } // namespace
+
+    EventQueue::EventQueue(Sink sink, std::chrono::milliseconds interval)
+        : _sink(std::move(sink)), _interval(interval), _thread([this] { loop(); }) {}
+
+    EventQueue::~EventQueue() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    void EventQueue::push(std::string name, std::string data) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopping) {
+                return;
+            }
+            _queue.emplace_back(std::move(name), std::move(data));
+            _maxQueued = std::max(_maxQueued, _queue.size());
+        }
+        _wake.notify_one();
+    }
+
+    std::string EventQueue::script(const std::vector<std::pair<std::string, std::string>> &events) {
+        // ["name","data"], per event
+        std::size_t size = SCRIPT_HEAD.size() + SCRIPT_TAIL.size();
+        for (const auto &[name, data] : events) {
+            size += JsonEscape::escapedLength(name) + JsonEscape::escapedLength(data) + 8;
+        }
+
+        std::string result(size, '\0');
+        char *out = result.data();
+        out       = append(out, SCRIPT_HEAD);
+        for (std::size_t i = 0; i < events.size(); i++) {
+            out = append(out, i ? ",[\"" : "[\"");
+            out = JsonEscape::write(out, events[i].first);
+            out = append(out, "\",\"");
+            out = JsonEscape::write(out, events[i].second);
+            out = append(out, "\"]");
+        }
+        out = append(out, SCRIPT_TAIL);
+        result.resize(out - result.data());
+        return result;
+    }
+
+    std::string EventQueue::statsJson() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        nlohmann::json stats = {
+            {"queued", _queue.size()},
+            {"maxQueued", _maxQueued},
+            {"events", _events},
+            {"batches", _batches},
+            {"maxBatch", _maxBatch},
+            {"avgBatch", _batches ? static_cast<double>(_events) / _batches : 0.0},
+            {"bytes", _bytes},
+        };
+        return stats.dump();
+    }
+
+    void EventQueue::loop() {
+        auto lastDelivery = Clock::now() - _interval;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _wake.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) {
+                return;
+            }
+            // Whatever else arrives before the frame is up joins this batch
+            _wake.wait_until(lock, lastDelivery + _interval, [this] { return _stopping; });
+
+            std::vector<std::pair<std::string, std::string>> batch;
+            batch.swap(_queue);
+            lock.unlock();
+
+            auto code = script(batch);
+            auto size = code.size();
+            try {
+                _sink(std::move(code));
+            } catch (const std::exception &e) {
+                Logger::getInstance().error("EventQueue::loop: Failed to deliver {} events: {}", batch.size(), e.what());
+            }
+            lastDelivery = Clock::now();
+
+            lock.lock();
+            _events += batch.size();
+            _batches++;
+            _bytes += size;
+            _maxBatch = std::max(_maxBatch, batch.size());
+        }
+    }
+
+} // namespace byoa
@@ -0,0 +1,585 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <sddl.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "app-paths.hpp"
+#include "arena.hpp"
+#include "config-store.hpp"
+#include "endpoint-pool.hpp"
+#include "gateway.hpp"
+#include "llm.hpp"
+#include "logger.hpp"
+#include "network.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        constexpr std::size_t MAX_CLIENTS      = 64;
+        constexpr std::size_t MAX_HEADER_BYTES = 64 * 1024;
+        constexpr std::size_t MAX_BODY_BYTES   = 16 * 1024 * 1024;
+
+#ifdef _WIN32
+        using socket_t = SOCKET;
+
+        constexpr socket_t NO_SOCKET = INVALID_SOCKET;
+        constexpr int SEND_FLAGS     = 0;
+
+        void closeSocket(socket_t s) {
+            closesocket(s);
+        }
+
+        void shutdownSocket(socket_t s) {
+            shutdown(s, SD_BOTH);
+        }
+
+        int pollSocket(socket_t s, int timeoutMs) {
+            WSAPOLLFD fd{};
+            fd.fd     = s;
+            fd.events = POLLRDNORM;
+            return WSAPoll(&fd, 1, timeoutMs);
+        }
+#else
+        using socket_t = int;
+
+        constexpr socket_t NO_SOCKET = -1;
+        constexpr int SEND_FLAGS     = MSG_NOSIGNAL;
+
+        void closeSocket(socket_t s) {
+            close(s);
+        }
+
+        void shutdownSocket(socket_t s) {
+            shutdown(s, SHUT_RDWR);
+        }
+
+        int pollSocket(socket_t s, int timeoutMs) {
+            pollfd fd{};
+            fd.fd     = s;
+            fd.events = POLLIN;
+            return poll(&fd, 1, timeoutMs);
+        }
+#endif
+
+        struct State {
+            std::mutex mutex;
+            std::atomic<bool> running{false};
+            std::atomic<std::size_t> clients{0};
+            socket_t listener = NO_SOCKET;
+            std::thread acceptor;
+            std::string token;
+
+            // Connection threads by client socket, and those that returned but are not joined yet
+            std::mutex clientsMutex;
+            std::map<socket_t, std::thread> clientThreads;
+            std::vector<std::thread> finishedThreads;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        /**
+         * @brief A parsed HTTP/1.1 request
+         */
+        struct HttpRequest {
+            std::string method;
+            std::string path;
+            std::string authorization;
+            std::string body;
+            bool keepAlive = true;
+        };
+
+        bool sendAll(socket_t s, std::string_view data) {
+            while (!data.empty()) {
+                auto sent = send(s, data.data(), static_cast<int>(data.size()), SEND_FLAGS);
+                if (sent <= 0) {
+                    return false;
+                }
+                data.remove_prefix(static_cast<std::size_t>(sent));
+            }
+            return true;
+        }
+
+        const char *reasonPhrase(int status) {
+            switch (status) {
+            case 200:
+                return "OK";
+            case 400:
+                return "Bad Request";
+            case 401:
+                return "Unauthorized";
+            case 404:
+                return "Not Found";
+            case 413:
+                return "Payload Too Large";
+            case 503:
+                return "Service Unavailable";
+            default:
+                return status >= 200 && status < 300 ? "OK" : "Error";
+            }
+        }
+
+        bool sendResponse(socket_t s, int status, std::string_view contentType, std::string_view body, bool keepAlive) {
+            std::string head = fmt::format("HTTP/1.1 {} {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: {}\r\n\r\n", status,
+                                           reasonPhrase(status), contentType, body.size(), keepAlive ? "keep-alive" : "close");
+            return sendAll(s, head) && sendAll(s, body);
+        }
+
+        bool sendError(socket_t s, int status, const std::string &message, bool keepAlive) {
+            json error = {{"error", {{"message", message}, {"type", status == 401 ? "authentication_error" : "invalid_request_error"}}}};
+            return sendResponse(s, status, "application/json", error.dump(), keepAlive);
+        }
+
+        bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+            return a.size() == b.size() &&
+                   std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return std::tolower(x) == std::tolower(y); });
+        }
+
+        /**
+         * @brief Read one request from @p s, keeping bytes of a pipelined next request in @p buffer
+         *
+         * @return std::nullopt when the connection closed; status 0 = parsed, otherwise an HTTP error to answer with
+         */
+        std::optional<int> readRequest(socket_t s, std::string &buffer, HttpRequest &request) {
+            char chunk[16 * 1024];
+            auto fill = [&]() {
+                if (pollSocket(s, 30000) <= 0) {
+                    return false;
+                }
+                auto received = recv(s, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    return false;
+                }
+                buffer.append(chunk, static_cast<std::size_t>(received));
+                return true;
+            };
+
+            std::size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (buffer.size() > MAX_HEADER_BYTES) {
+                    return 413;
+                }
+                if (!fill()) {
+                    return std::nullopt;
+                }
+            }
+
+            std::string_view head(buffer.data(), headerEnd);
+            auto lineEnd = head.find("\r\n");
+            std::string_view requestLine = head.substr(0, lineEnd);
+            auto firstSpace  = requestLine.find(' ');
+            auto secondSpace = requestLine.find(' ', firstSpace + 1);
+            if (firstSpace == std::string_view::npos || secondSpace == std::string_view::npos) {
+                return 400;
+            }
+            request.method    = requestLine.substr(0, firstSpace);
+            request.path      = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+            request.keepAlive = requestLine.substr(secondSpace + 1) != "HTTP/1.0";
+
+            std::size_t contentLength = 0;
+            while (lineEnd != std::string_view::npos) {
+                auto start = lineEnd + 2;
+                lineEnd    = head.find("\r\n", start);
+                std::string_view line = head.substr(start, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - start);
+                auto colon            = line.find(':');
+                if (colon == std::string_view::npos) {
+                    continue;
+                }
+
+                std::string_view name  = line.substr(0, colon);
+                std::string_view value = line.substr(colon + 1);
+                value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+                if (equalsIgnoreCase(name, "content-length")) {
+                    contentLength = std::strtoull(std::string(value).c_str(), nullptr, 10);
+                } else if (equalsIgnoreCase(name, "authorization")) {
+                    request.authorization = value;
+                } else if (equalsIgnoreCase(name, "connection")) {
+                    request.keepAlive = !equalsIgnoreCase(value, "close");
+                } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+                    // Chunked request bodies are not needed by any OpenAI client
+                    return 400;
+                }
+            }
+
+            if (contentLength > MAX_BODY_BYTES) {
+                return 413;
+            }
+
+            std::size_t bodyStart = headerEnd + 4;
+            while (buffer.size() < bodyStart + contentLength) {
+                if (!fill()) {
+                    return std::nullopt;
+                }
+            }
+            request.body = buffer.substr(bodyStart, contentLength);
+            buffer.erase(0, bodyStart + contentLength);
+            return 0;
+        }
+
+        std::vector<LLM::Config> enabledConfigs() {
+            std::vector<LLM::Config> configs;
+            auto stored = ConfigStore::get("llm_configs");
+            if (!stored) {
+                return configs;
+            }
+
+            json list = json::parse(*stored, nullptr, false);
+            if (!list.is_array()) {
+                return configs;
+            }
+            for (const auto &entry : list) {
+                if (!entry.is_object() || !entry.value("enabled", true)) {
+                    continue;
+                }
+                if (auto config = LLM::parseConfig(entry.dump())) {
+                    configs.push_back(std::move(*config));
+                }
+            }
+            return configs;
+        }
+
+        bool handleModels(socket_t s, bool keepAlive) {
+            json data = json::array();
+            for (const auto &config : enabledConfigs()) {
+                data.push_back({{"id", config.name.empty() ? config.id : config.name}, {"object", "model"}, {"owned_by", "byoa"}});
+            }
+            return sendResponse(s, 200, "application/json", json{{"object", "list"}, {"data", data}}.dump(), keepAlive);
+        }
+
+        bool handleCompletions(socket_t s, const HttpRequest &request) {
+            json body = json::parse(request.body, nullptr, false);
+            if (!body.is_object()) {
+                return sendError(s, 400, "Request body must be a JSON object", request.keepAlive);
+            }
+
+            auto configs = enabledConfigs();
+            std::string model;
+            if (body.contains("model") && body["model"].is_string()) {
+                model = body["model"].get<std::string>();
+            }
+            auto config = std::find_if(configs.begin(), configs.end(), [&](const LLM::Config &c) {
+                return model.empty() || model == "auto" || c.id == model || c.name == model || c.modelName == model;
+            });
+            if (config == configs.end()) {
+                return sendError(s, 404, "No enabled provider matches model '" + model + "'", request.keepAlive);
+            }
+            body["model"] = config->modelName;
+            bool stream   = body.value("stream", false);
+            auto lease    = EndpointPool::acquire(*config);
+
+            RequestArena arena;
+            Network::allocator_type alloc{arena.resource()};
+
+            Network::FetchOptions options{alloc};
+            options.method.assign("POST");
+            options.headers[std::pmr::string("Content-Type", alloc)].assign("application/json");
+            options.headers[std::pmr::string("Authorization", alloc)].assign("Bearer " + lease.endpoint.apiKey);
+            options.body.assign(body.dump());
+            options.unixSocket.assign(lease.endpoint.socketPath);
+
+            Network::FetchResponse response{alloc};
+
+            // Successful streams are relayed chunk by chunk; anything else is answered once complete
+            bool streaming    = false;
+            bool clientClosed = false;
+            if (stream) {
+                options.onData = [&](std::string_view chunk) {
+                    if (response.status < 200 || response.status >= 300) {
+                        return true;
+                    }
+                    if (!streaming) {
+                        streaming = true;
+                        if (!sendAll(s, "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+                                        "Transfer-Encoding: chunked\r\n\r\n")) {
+                            clientClosed = true;
+                            return false;
+                        }
+                    }
+                    if (!sendAll(s, fmt::format("{:x}\r\n", chunk.size())) || !sendAll(s, chunk) || !sendAll(s, "\r\n")) {
+                        // Client went away: abort the upstream transfer too
+                        clientClosed = true;
+                        return false;
+                    }
+                    return true;
+                };
+            }
+
+            Network::request(LLM::completionsURL(lease.endpoint.baseURL), options, response);
+            EndpointPool::release(lease, response.status);
+
+            if (clientClosed) {
+                return false;
+            }
+            if (streaming) {
+                if (!response.ok) {
+                    // The upstream stream broke off: close without the final chunk so the client sees it truncated
+                    return false;
+                }
+                return sendAll(s, "0\r\n\r\n") && request.keepAlive;
+            }
+
+            int status = response.status == 0 ? 502 : response.status;
+            return sendResponse(s, status, "application/json", response.bodyView(), request.keepAlive);
+        }
+
+        void serveClient(socket_t s) {
+            auto &st = state();
+            std::string buffer;
+            bool open = true;
+            while (open && st.running) {
+                HttpRequest request;
+                auto parsed = readRequest(s, buffer, request);
+                if (!parsed) {
+                    break;
+                }
+                if (*parsed != 0) {
+                    sendError(s, *parsed, "Malformed or oversized request", false);
+                    break;
+                }
+
+                auto started = std::chrono::steady_clock::now();
+                if (request.authorization != "Bearer " + st.token) {
+                    open = sendError(s, 401, "Missing or invalid gateway token", request.keepAlive) && request.keepAlive;
+                } else if (request.method == "GET" && request.path == "/v1/models") {
+                    open = handleModels(s, request.keepAlive) && request.keepAlive;
+                } else if (request.method == "POST" && request.path == "/v1/chat/completions") {
+                    open = handleCompletions(s, request) && request.keepAlive;
+                } else {
+                    open = sendError(s, 404, "Unknown endpoint " + request.path, request.keepAlive) && request.keepAlive;
+                }
+
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+                Logger::getInstance().info("Gateway: {} {} in {} us, {} clients", request.method, request.path, elapsed.count(),
+                                           st.clients.load());
+            }
+
+            {
+                // Hand our thread over for joining; stop() may already have taken it
+                std::lock_guard<std::mutex> lock(st.clientsMutex);
+                auto it = st.clientThreads.find(s);
+                if (it != st.clientThreads.end()) {
+                    st.finishedThreads.push_back(std::move(it->second));
+                    st.clientThreads.erase(it);
+                }
+            }
+            closeSocket(s);
+            st.clients--;
+        }
+
+    } // namespace
+
+    void Gateway::configureFromEnvironment() {
+        const char *port = std::getenv("BYOA_GATEWAY_PORT");
+        if (port && *port) {
+            start(static_cast<uint16_t>(std::strtoul(port, nullptr, 10)));
+        }
+    }
+
+    bool Gateway::writeOwnerOnly(const std::filesystem::path &path, const std::string &contents) {
+        // Created owner-only rather than restricted afterwards, so no other user can open it in between
+        auto temporary = path;
+        temporary += ".tmp";
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+
+#ifdef _WIN32
+        // Protected DACL: full access for the owner and SYSTEM, nothing inherited
+        PSECURITY_DESCRIPTOR descriptor = nullptr;
+        if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(L"D:P(A;;FA;;;OW)(A;;FA;;;SY)", SDDL_REVISION_1, &descriptor, nullptr)) {
+            return false;
+        }
+        SECURITY_ATTRIBUTES attributes{sizeof(attributes), descriptor, FALSE};
+        HANDLE file = CreateFileW(temporary.c_str(), GENERIC_WRITE, 0, &attributes, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LocalFree(descriptor);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        DWORD written = 0;
+        bool ok       = WriteFile(file, contents.data(), static_cast<DWORD>(contents.size()), &written, nullptr);
+        ok            = ok && written == contents.size() && FlushFileBuffers(file);
+        CloseHandle(file);
+        ok = ok && MoveFileExW(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = ::write(fd, contents.data(), contents.size()) == static_cast<ssize_t>(contents.size()) && ::fsync(fd) == 0;
+        ok      = ::close(fd) == 0 && ok;
+        ok      = ok && std::rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+        if (!ok) {
+            std::filesystem::remove(temporary, ec);
+        }
+        return ok;
+    }
+
+    std::optional<std::string> Gateway::loadToken() {
+        auto path = AppPaths::dataDir() / "gateway-token";
+
+        std::string token;
+        std::ifstream(path) >> token;
+        if (!token.empty()) {
+#ifndef _WIN32
+            // Files written by older versions got the default umask
+            std::error_code ec;
+            std::filesystem::permissions(path, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+                                         std::filesystem::perm_options::replace, ec);
+            if (ec) {
+                Logger::getInstance().error("Gateway::loadToken: Failed to restrict {}: {}", path.string(), ec.message());
+                return std::nullopt;
+            }
+#endif
+            return token;
+        }
+
+        std::random_device random;
+        for (int i = 0; i < 4; i++) {
+            token += fmt::format("{:08x}", random());
+        }
+        if (!writeOwnerOnly(path, token)) {
+            Logger::getInstance().error("Gateway::loadToken: Failed to write {}", path.string());
+            return std::nullopt;
+        }
+        return token;
+    }
+
+    bool Gateway::start(uint16_t port) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.running) {
+            return true;
+        }
+
+        // Without a token only the user can read, clients could not be told apart from other local users
+        auto token = loadToken();
+        if (!token) {
+            Logger::getInstance().error("Gateway::start: No gateway token, not starting");
+            return false;
+        }
+
+#ifdef _WIN32
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+        s.listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (s.listener == NO_SOCKET) {
+            Logger::getInstance().error("Gateway::start: Failed to create socket");
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(s.listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+        // Loopback only: the gateway hands out the user's provider keys' capabilities
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(s.listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(s.listener, SOMAXCONN) != 0) {
+            Logger::getInstance().error("Gateway::start: Failed to listen on 127.0.0.1:{}", port);
+            closeSocket(s.listener);
+            s.listener = NO_SOCKET;
+            return false;
+        }
+
+        s.token    = std::move(*token);
+        s.running  = true;
+        s.acceptor = std::thread([]() {
+            auto &st = state();
+            while (st.running) {
+                if (pollSocket(st.listener, 200) <= 0) {
+                    continue;
+                }
+                socket_t client = accept(st.listener, nullptr, nullptr);
+                if (client == NO_SOCKET) {
+                    continue;
+                }
+
+                if (st.clients >= MAX_CLIENTS) {
+                    sendError(client, 503, "Too many concurrent clients", false);
+                    closeSocket(client);
+                    continue;
+                }
+                st.clients++;
+
+                std::vector<std::thread> finished;
+                {
+                    std::lock_guard<std::mutex> lock(st.clientsMutex);
+                    finished.swap(st.finishedThreads);
+                    st.clientThreads.emplace(client, std::thread(serveClient, client));
+                }
+                for (auto &thread : finished) {
+                    thread.join();
+                }
+            }
+        });
+
+        Logger::getInstance().info("Gateway::start: Listening on http://127.0.0.1:{}/v1", port);
+        return true;
+    }
+
+    void Gateway::stop() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.running) {
+            return;
+        }
+
+        s.running = false;
+        if (s.acceptor.joinable()) {
+            s.acceptor.join();
+        }
+        closeSocket(s.listener);
+        s.listener = NO_SOCKET;
+
+        // Wake connections blocked reading the next request; one mid-request stops at its next write
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(s.clientsMutex);
+            for (auto &[client, thread] : s.clientThreads) {
+                shutdownSocket(client);
+                threads.push_back(std::move(thread));
+            }
+            s.clientThreads.clear();
+            for (auto &thread : s.finishedThreads) {
+                threads.push_back(std::move(thread));
+            }
+            s.finishedThreads.clear();
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        Logger::getInstance().info("Gateway::stop: Stopped, {} connections closed", threads.size());
+    }
+
+} // namespace byoa
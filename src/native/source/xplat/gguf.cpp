@@ -0,0 +1,282 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "gguf.hpp"
+#include "logger.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        constexpr uint32_t GGUF_MAGIC            = 0x46554747; // "GGUF" little endian
+        constexpr uint64_t DEFAULT_ALIGNMENT     = 32;
+        constexpr uint64_t MAX_METADATA_ELEMENTS = 1ull << 24;
+
+        enum ValueType : uint32_t {
+            UINT8   = 0,
+            INT8    = 1,
+            UINT16  = 2,
+            INT16   = 3,
+            UINT32  = 4,
+            INT32   = 5,
+            FLOAT32 = 6,
+            BOOL    = 7,
+            STRING  = 8,
+            ARRAY   = 9,
+            UINT64  = 10,
+            INT64   = 11,
+            FLOAT64 = 12,
+        };
+
+        // Bounds-checked reader over the mapping; throws std::out_of_range on truncated files
+        class Cursor {
+          public:
+            Cursor(const uint8_t *data, std::size_t size) : _data(data), _size(size) {}
+
+            template <typename T> T read() {
+                T value;
+                std::memcpy(&value, take(sizeof(T)), sizeof(T));
+                return value;
+            }
+
+            std::string string() {
+                auto length = read<uint64_t>();
+                return std::string(reinterpret_cast<const char *>(take(length)), length);
+            }
+
+            std::size_t offset() const {
+                return _offset;
+            }
+
+          private:
+            const uint8_t *take(uint64_t count) {
+                if (count > _size - _offset) {
+                    throw std::out_of_range("truncated GGUF file");
+                }
+                auto *at = _data + _offset;
+                _offset += count;
+                return at;
+            }
+
+            const uint8_t *_data;
+            std::size_t _size;
+            std::size_t _offset = 0;
+        };
+
+        json readValue(Cursor &cursor, uint32_t type) {
+            switch (type) {
+            case UINT8:
+                return cursor.read<uint8_t>();
+            case INT8:
+                return cursor.read<int8_t>();
+            case UINT16:
+                return cursor.read<uint16_t>();
+            case INT16:
+                return cursor.read<int16_t>();
+            case UINT32:
+                return cursor.read<uint32_t>();
+            case INT32:
+                return cursor.read<int32_t>();
+            case FLOAT32:
+                return cursor.read<float>();
+            case BOOL:
+                return cursor.read<uint8_t>() != 0;
+            case STRING:
+                return cursor.string();
+            case UINT64:
+                return cursor.read<uint64_t>();
+            case INT64:
+                return cursor.read<int64_t>();
+            case FLOAT64:
+                return cursor.read<double>();
+            case ARRAY: {
+                auto elementType = cursor.read<uint32_t>();
+                auto count       = cursor.read<uint64_t>();
+                if (count > MAX_METADATA_ELEMENTS) {
+                    throw std::out_of_range("metadata array too large");
+                }
+                json array = json::array();
+                array.get_ref<json::array_t &>().reserve(count);
+                for (uint64_t i = 0; i < count; i++) {
+                    array.push_back(readValue(cursor, elementType));
+                }
+                return array;
+            }
+            default:
+                throw std::out_of_range("unknown metadata type " + std::to_string(type));
+            }
+        }
+
+    } // namespace
+
+    std::size_t GgufFile::bytesFor(TensorType type, uint64_t elements) {
+        auto blocks = [&](uint64_t blockSize, std::size_t blockBytes) -> std::size_t {
+            return elements % blockSize == 0 ? elements / blockSize * blockBytes : 0;
+        };
+
+        switch (type) {
+        case TensorType::F32:
+            return elements * 4;
+        case TensorType::F16:
+            return elements * 2;
+        case TensorType::Q4_0:
+            return blocks(32, 18);
+        case TensorType::Q8_0:
+            return blocks(32, 34);
+        case TensorType::Q4_K:
+            return blocks(256, 144);
+        case TensorType::Q6_K:
+            return blocks(256, 210);
+        }
+        return 0;
+    }
+
+    std::unique_ptr<GgufFile> GgufFile::open(const std::filesystem::path &path) {
+        std::unique_ptr<GgufFile> file(new GgufFile());
+
+#ifdef _WIN32
+        HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            Logger::getInstance().error("GgufFile::open: Cannot open {}", path.string());
+            return nullptr;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(handle, &size);
+        file->_size    = static_cast<std::size_t>(size.QuadPart);
+        file->_mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(handle);
+        if (file->_mapping) {
+            file->_data = static_cast<const uint8_t *>(MapViewOfFile(file->_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            Logger::getInstance().error("GgufFile::open: Cannot open {}", path.string());
+            return nullptr;
+        }
+        struct stat info {};
+        fstat(fd, &info);
+        file->_size = static_cast<std::size_t>(info.st_size);
+        void *data  = file->_size ? mmap(nullptr, file->_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        file->_data = data == MAP_FAILED ? nullptr : static_cast<const uint8_t *>(data);
+#endif
+        if (!file->_data) {
+            Logger::getInstance().error("GgufFile::open: Failed to map {} bytes of {}", file->_size, path.string());
+            return nullptr;
+        }
+
+        if (!file->parse()) {
+            return nullptr;
+        }
+        Logger::getInstance().info("GgufFile::open: Mapped {} ({} MB, {} tensors)", path.string(), file->_size >> 20,
+                                   file->_tensors.size());
+        return file;
+    }
+
+    GgufFile::~GgufFile() {
+#ifdef _WIN32
+        if (_data) {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping) {
+            CloseHandle(_mapping);
+        }
+#else
+        if (_data) {
+            munmap(const_cast<uint8_t *>(_data), _size);
+        }
+#endif
+    }
+
+    bool GgufFile::parse() {
+        try {
+            Cursor cursor(_data, _size);
+            if (cursor.read<uint32_t>() != GGUF_MAGIC) {
+                Logger::getInstance().error("GgufFile::parse: Not a GGUF file");
+                return false;
+            }
+            auto version = cursor.read<uint32_t>();
+            if (version < 2 || version > 3) {
+                Logger::getInstance().error("GgufFile::parse: Unsupported GGUF version {}", version);
+                return false;
+            }
+
+            auto tensorCount = cursor.read<uint64_t>();
+            auto kvCount     = cursor.read<uint64_t>();
+
+            _metadata = json::object();
+            for (uint64_t i = 0; i < kvCount; i++) {
+                auto key        = cursor.string();
+                auto type       = cursor.read<uint32_t>();
+                _metadata[key]  = readValue(cursor, type);
+            }
+
+            struct Info {
+                std::string name;
+                Tensor tensor;
+                uint64_t offset;
+            };
+            std::vector<Info> infos;
+            for (uint64_t i = 0; i < tensorCount; i++) {
+                Info info;
+                info.name = cursor.string();
+                auto dims = cursor.read<uint32_t>();
+                if (dims == 0 || dims > 4) {
+                    Logger::getInstance().error("GgufFile::parse: Tensor {} has {} dimensions", info.name, dims);
+                    return false;
+                }
+                for (uint32_t d = 0; d < dims; d++) {
+                    info.tensor.dims.push_back(cursor.read<uint64_t>());
+                }
+                info.tensor.type = static_cast<TensorType>(cursor.read<uint32_t>());
+                info.offset      = cursor.read<uint64_t>();
+                infos.push_back(std::move(info));
+            }
+
+            uint64_t alignment = _metadata.value("general.alignment", DEFAULT_ALIGNMENT);
+            uint64_t start     = (cursor.offset() + alignment - 1) / alignment * alignment;
+
+            for (auto &[name, tensor, offset] : infos) {
+                uint64_t elements = 1;
+                for (auto dim : tensor.dims) {
+                    elements *= dim;
+                }
+                tensor.rowBytes = bytesFor(tensor.type, tensor.dims[0]);
+                auto bytes      = bytesFor(tensor.type, elements);
+                if (tensor.rowBytes == 0 || bytes == 0) {
+                    Logger::getInstance().error("GgufFile::parse: Tensor {} has unsupported type {} or shape",
+                                                name, static_cast<uint32_t>(tensor.type));
+                    return false;
+                }
+                if (start + offset + bytes > _size) {
+                    Logger::getInstance().error("GgufFile::parse: Tensor {} lies beyond the end of the file", name);
+                    return false;
+                }
+                tensor.data = _data + start + offset;
+                _tensors.emplace(std::move(name), std::move(tensor));
+            }
+            return true;
+        } catch (const std::exception &e) {
+            Logger::getInstance().error("GgufFile::parse: {}", e.what());
+            return false;
+        }
+    }
+
+    const GgufFile::Tensor *GgufFile::tensor(const std::string &name) const {
+        auto it = _tensors.find(name);
+        return it == _tensors.end() ? nullptr : &it->second;
+    }
+
+} // namespace byoa
@@ -0,0 +1,240 @@
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+#include "incremental.hpp"
+#include "logger.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        using OutputMap = std::unordered_map<uint64_t, std::string>;
+
+        // Outputs of the last run per cache key, oldest keys evicted first
+        struct Cache {
+            std::mutex mutex;
+            std::unordered_map<std::string, OutputMap> entries;
+            std::deque<std::string> order;
+        };
+
+        Cache &cache() {
+            static Cache instance;
+            return instance;
+        }
+
+        bool isBlank(std::string_view text) {
+            return text.find_first_not_of(" \t\r\n") == std::string_view::npos;
+        }
+
+        std::string trimmed(const std::string &text) {
+            auto begin = text.find_first_not_of(" \t\r\n");
+            if (begin == std::string::npos) {
+                return "";
+            }
+            auto end = text.find_last_not_of(" \t\r\n");
+            return text.substr(begin, end - begin + 1);
+        }
+
+    } // namespace
+
+    uint64_t Incremental::fingerprint(std::string_view text) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::vector<Incremental::Segment> Incremental::split(const std::string &text) {
+        std::vector<Segment> segments;
+
+        std::size_t start = 0;
+        std::size_t i     = 0;
+        while (i < text.size()) {
+            if (text[i] != '\n') {
+                i++;
+                continue;
+            }
+
+            // A separator is a whitespace run containing at least two newlines
+            std::size_t end      = i;
+            std::size_t newlines = 0;
+            while (end < text.size() && (text[end] == '\n' || text[end] == '\r' || text[end] == ' ' || text[end] == '\t')) {
+                newlines += text[end] == '\n' ? 1 : 0;
+                end++;
+            }
+
+            if (newlines >= 2) {
+                Segment segment;
+                segment.text        = text.substr(start, i - start);
+                segment.separator   = text.substr(i, end - i);
+                segment.fingerprint = fingerprint(segment.text);
+                segments.push_back(std::move(segment));
+                start = end;
+            }
+            i = end;
+        }
+
+        if (start < text.size() || segments.empty()) {
+            Segment segment;
+            segment.text        = text.substr(start);
+            segment.fingerprint = fingerprint(segment.text);
+            segments.push_back(std::move(segment));
+        }
+
+        return segments;
+    }
+
+    Incremental::Result Incremental::run(const std::string &cacheKey, const std::string &input, const Processor &process) {
+        Result result;
+        auto segments   = split(input);
+        result.segments = segments.size();
+
+        std::vector<std::optional<std::string>> outputs(segments.size());
+        {
+            auto &c = cache();
+            std::lock_guard<std::mutex> lock(c.mutex);
+            auto it = c.entries.find(cacheKey);
+            for (std::size_t i = 0; i < segments.size(); i++) {
+                if (isBlank(segments[i].text)) {
+                    outputs[i] = segments[i].text;
+                } else if (it != c.entries.end()) {
+                    auto hit = it->second.find(segments[i].fingerprint);
+                    if (hit != it->second.end()) {
+                        outputs[i] = hit->second;
+                    }
+                }
+            }
+        }
+
+        // Changed paragraphs, each distinct fingerprint sent only once
+        std::vector<std::size_t> pending;
+        std::unordered_map<uint64_t, std::size_t> firstIndex;
+        for (std::size_t i = 0; i < segments.size(); i++) {
+            if (!outputs[i] && firstIndex.emplace(segments[i].fingerprint, i).second) {
+                pending.push_back(i);
+            }
+        }
+        result.sent = pending.size();
+
+        std::vector<LLM::Completion> completions(pending.size());
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]() {
+            for (std::size_t n = next++; n < pending.size(); n = next++) {
+                completions[n] = process(segments[pending[n]].text);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        std::size_t workerCount = std::min(MAX_CONCURRENCY, pending.size());
+        for (std::size_t w = 1; w < workerCount; w++) {
+            workers.emplace_back(worker);
+        }
+        if (workerCount > 0) {
+            worker();
+        }
+        for (auto &thread : workers) {
+            thread.join();
+        }
+
+        OutputMap fresh;
+        for (std::size_t n = 0; n < pending.size(); n++) {
+            if (!completions[n].ok) {
+                result.error = completions[n].error;
+                continue;
+            }
+            fresh[segments[pending[n]].fingerprint] = trimmed(completions[n].content);
+        }
+
+        for (std::size_t i = 0; i < segments.size(); i++) {
+            if (!outputs[i]) {
+                auto hit = fresh.find(segments[i].fingerprint);
+                if (hit != fresh.end()) {
+                    outputs[i] = hit->second;
+                }
+            }
+        }
+
+        {
+            auto &c = cache();
+            std::lock_guard<std::mutex> lock(c.mutex);
+            auto [it, inserted] = c.entries.try_emplace(cacheKey);
+            if (inserted) {
+                c.order.push_back(cacheKey);
+                if (c.order.size() > MAX_CACHED_ACTIONS) {
+                    c.entries.erase(c.order.front());
+                    c.order.pop_front();
+                }
+            }
+
+            if (result.error.empty()) {
+                // Keep only the current document so the cache tracks the latest version
+                OutputMap current;
+                for (std::size_t i = 0; i < segments.size(); i++) {
+                    if (!isBlank(segments[i].text)) {
+                        current[segments[i].fingerprint] = *outputs[i];
+                    }
+                }
+                it->second = std::move(current);
+            } else {
+                // Keep the partial progress so a retry only resends what failed
+                it->second.merge(fresh);
+            }
+        }
+
+        if (!result.error.empty()) {
+            return result;
+        }
+
+        for (std::size_t i = 0; i < segments.size(); i++) {
+            result.content += *outputs[i];
+            result.content += segments[i].separator;
+        }
+        result.ok = true;
+
+        Logger::getInstance().info("Incremental::run: {} segments, {} sent", result.segments, result.sent);
+        return result;
+    }
+
+    coco::future<std::string> Incremental::invokeAsync(const std::string &configJson, const std::string &actionKey,
+                                                       const std::string &systemContent, const std::string &userContent) {
+        auto promise = coco::promise<std::string>{};
+        auto future  = promise.get_future();
+
+        std::thread thread{[promise = std::move(promise), configJson, actionKey, systemContent, userContent]() mutable {
+            Result result;
+            auto config = LLM::parseConfig(configJson);
+            if (!config) {
+                result.error = "Invalid LLM configuration";
+            } else {
+                // Results are only reusable for the same model, action and prompt; an edited config keeps its id,
+                // so the endpoint and model name are part of the key too
+                std::string cacheKey = fmt::format("{}\x1f{}\x1f{}\x1f{}\x1f{:x}", config->id, config->baseURL, config->modelName,
+                                                   actionKey, fingerprint(systemContent));
+                result = run(cacheKey, userContent,
+                             [&](const std::string &segment) { return LLM::complete(*config, systemContent, segment); });
+            }
+
+            json j = {
+                {"ok", result.ok},
+                {"content", result.content},
+                {"error", result.error},
+                {"segments", result.segments},
+                {"sent", result.sent},
+            };
+            promise.set_value(j.dump(-1, ' ', false, json::error_handler_t::replace));
+        }};
+        thread.detach();
+
+        return future;
+    }
+
+} // namespace byoa
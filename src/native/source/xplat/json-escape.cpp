@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "json-escape.hpp"
+
+namespace byoa {
+
+    namespace {
+
+        constexpr uint64_t ONES  = 0x0101010101010101ull;
+        constexpr uint64_t HIGHS = 0x8080808080808080ull;
+
+        // Whether any of the 8 bytes in @p word is a control character, '"', '\\' or a non-ASCII
+        // byte that has to be UTF-8 validated (SWAR: no SIMD intrinsics, so it is the same code on
+        // x86-64 and arm64). Exact for ASCII words, never a false negative.
+        inline bool needsScalar(uint64_t word) {
+            uint64_t control   = (word - ONES * 0x20) & ~word;
+            uint64_t quote     = word ^ (ONES * '"');
+            uint64_t backslash = word ^ (ONES * '\\');
+            quote              = (quote - ONES) & ~quote;
+            backslash          = (backslash - ONES) & ~backslash;
+            return ((control | quote | backslash | word) & HIGHS) != 0;
+        }
+
+        inline uint64_t load(const char *data) {
+            uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            return word;
+        }
+
+        // U+FFFD, written for every ill-formed UTF-8 sequence like json::dump with error_handler_t::replace
+        constexpr std::string_view REPLACEMENT = "\xEF\xBF\xBD";
+
+        // Length of the well-formed UTF-8 sequence at the start of @p data (1 for ASCII), or 0 if it is
+        // ill-formed, with @p invalid set to the length of its maximal ill-formed prefix (Unicode table 3-7)
+        inline std::size_t sequenceLength(const unsigned char *data, std::size_t available, std::size_t &invalid) {
+            unsigned char lead = data[0];
+            if (lead < 0x80) {
+                return 1;
+            }
+
+            std::size_t length = 0;
+            unsigned char low  = 0x80;
+            unsigned char high = 0xBF;
+            if (lead >= 0xC2 && lead <= 0xDF) {
+                length = 2;
+            } else if (lead >= 0xE0 && lead <= 0xEF) {
+                length = 3;
+                low    = lead == 0xE0 ? 0xA0 : low;
+                high   = lead == 0xED ? 0x9F : high;
+            } else if (lead >= 0xF0 && lead <= 0xF4) {
+                length = 4;
+                low    = lead == 0xF0 ? 0x90 : low;
+                high   = lead == 0xF4 ? 0x8F : high;
+            } else {
+                invalid = 1;
+                return 0;
+            }
+
+            for (std::size_t k = 1; k < length; k++) {
+                // Only the second byte has a narrowed range
+                if (k >= available || data[k] < (k == 1 ? low : 0x80) || data[k] > (k == 1 ? high : 0xBF)) {
+                    invalid = k;
+                    return 0;
+                }
+            }
+            return length;
+        }
+
+        inline std::size_t extraBytes(unsigned char c) {
+            if (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t' || c == '\b' || c == '\f') {
+                return 1;
+            } else if (c < 0x20) {
+                // \u00XX
+                return 5;
+            }
+            return 0;
+        }
+
+        inline char *writeByte(char *out, unsigned char c) {
+            static constexpr char HEX[] = "0123456789abcdef";
+
+            switch (c) {
+            case '"':
+                *out++ = '\\';
+                *out++ = '"';
+                break;
+            case '\\':
+                *out++ = '\\';
+                *out++ = '\\';
+                break;
+            case '\n':
+                *out++ = '\\';
+                *out++ = 'n';
+                break;
+            case '\r':
+                *out++ = '\\';
+                *out++ = 'r';
+                break;
+            case '\t':
+                *out++ = '\\';
+                *out++ = 't';
+                break;
+            case '\b':
+                *out++ = '\\';
+                *out++ = 'b';
+                break;
+            case '\f':
+                *out++ = '\\';
+                *out++ = 'f';
+                break;
+            default:
+                if (c < 0x20) {
+                    *out++ = '\\';
+                    *out++ = 'u';
+                    *out++ = '0';
+                    *out++ = '0';
+                    *out++ = HEX[c >> 4];
+                    *out++ = HEX[c & 0x0f];
+                } else {
+                    *out++ = static_cast<char>(c);
+                }
+                break;
+            }
+            return out;
+        }
+
+        // Escaped length of the character at @p data[0]; advances @p consumed past it
+        inline std::size_t scalarLength(const unsigned char *data, std::size_t available, std::size_t &consumed) {
+            std::size_t invalid = 0;
+            std::size_t length  = sequenceLength(data, available, invalid);
+            if (length == 0) {
+                consumed = invalid;
+                return REPLACEMENT.size();
+            }
+            consumed = length;
+            return length == 1 ? 1 + extraBytes(data[0]) : length;
+        }
+
+        // Write the character at @p data[0] escaped (or U+FFFD if ill-formed); advances @p consumed past it
+        inline char *writeScalar(char *out, const unsigned char *data, std::size_t available, std::size_t &consumed) {
+            std::size_t invalid = 0;
+            std::size_t length  = sequenceLength(data, available, invalid);
+            if (length == 0) {
+                consumed = invalid;
+                return std::copy(REPLACEMENT.begin(), REPLACEMENT.end(), out);
+            }
+            consumed = length;
+            return length == 1 ? writeByte(out, data[0]) : std::copy(data, data + length, out);
+        }
+
+    } // namespace
+
+    std::size_t JsonEscape::escapedLength(std::string_view input) {
+        const auto *data   = reinterpret_cast<const unsigned char *>(input.data());
+        std::size_t size   = input.size();
+        std::size_t length = 0;
+        std::size_t i      = 0;
+        while (i < size) {
+            if (i + 8 <= size && !needsScalar(load(input.data() + i))) {
+                length += 8;
+                i += 8;
+                continue;
+            }
+            // A multi-byte sequence may run past this word, so go character by character until it is left behind
+            for (std::size_t end = std::min(i + 8, size); i < end;) {
+                std::size_t consumed = 0;
+                length += scalarLength(data + i, size - i, consumed);
+                i += consumed;
+            }
+        }
+        return length;
+    }
+
+    char *JsonEscape::write(char *out, std::string_view input) {
+        const auto *data = reinterpret_cast<const unsigned char *>(input.data());
+        std::size_t size = input.size();
+        std::size_t i    = 0;
+        while (i < size) {
+            // Text is mostly clean ASCII, so runs of clean words are copied with one memcpy
+            std::size_t run = i;
+            while (run + 8 <= size && !needsScalar(load(input.data() + run))) {
+                run += 8;
+            }
+            if (run > i) {
+                std::memcpy(out, input.data() + i, run - i);
+                out += run - i;
+                i = run;
+                continue;
+            }
+            for (std::size_t end = std::min(i + 8, size); i < end;) {
+                std::size_t consumed = 0;
+                out                  = writeScalar(out, data + i, size - i, consumed);
+                i += consumed;
+            }
+        }
+        return out;
+    }
+
+} // namespace byoa
@@ -0,0 +1,278 @@
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+#include "arena.hpp"
+#include "endpoint-pool.hpp"
+#include "llm.hpp"
+#include "local-model.hpp"
+#include "logger.hpp"
+#include "prompt-cache.hpp"
+#include "router.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    std::optional<LLM::Config> LLM::parseConfig(const std::string &configJson) {
+        try {
+            json j = json::parse(configJson);
+
+            Config config;
+            config.id         = j.value("id", "");
+            config.name       = j.value("name", "");
+            config.modelName  = j.value("modelName", "");
+            config.baseURL    = j.value("baseURL", "");
+            config.apiKey     = j.value("apiKey", "");
+            config.socketPath = j.value("socketPath", "");
+            config.poolPolicy    = j.value("poolPolicy", "");
+            config.contextTokens = j.value("contextTokens", std::size_t{0});
+            config.promptCache   = j.value("promptCache", "");
+            for (const auto &member : j.value("pool", json::array())) {
+                config.pool.push_back({member.value("baseURL", ""), member.value("apiKey", ""), member.value("socketPath", "")});
+            }
+
+            if (config.baseURL.empty()) {
+                Logger::getInstance().error("LLM::parseConfig: Missing baseURL");
+                return std::nullopt;
+            }
+            return config;
+        } catch (const json::exception &e) {
+            Logger::getInstance().error("LLM::parseConfig: JSON parse error: {}", e.what());
+            return std::nullopt;
+        }
+    }
+
+    std::string LLM::completionsURL(const std::string &baseURL) {
+        // Remove the trailing slash and '/chat/completions' from the baseURL
+        std::string url = baseURL;
+        if (url.ends_with("/")) {
+            url.pop_back();
+        }
+        if (url.ends_with("/chat/completions")) {
+            url.resize(url.size() - std::string_view("/chat/completions").size());
+        }
+        return url + "/chat/completions";
+    }
+
+    namespace {
+
+        std::string_view trim(std::string_view text) {
+            auto begin = text.find_first_not_of(" \t\r\n");
+            if (begin == std::string_view::npos) {
+                return {};
+            }
+            auto end = text.find_last_not_of(" \t\r\n");
+            return text.substr(begin, end - begin + 1);
+        }
+
+        int64_t elapsedMicros(std::chrono::steady_clock::time_point since) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+        }
+
+        std::size_t outputTokens(const json &usage) {
+            if (!usage.is_object() || !usage.contains("completion_tokens") || !usage["completion_tokens"].is_number_unsigned()) {
+                return 0;
+            }
+            return usage["completion_tokens"].get<std::size_t>();
+        }
+
+    } // namespace
+
+    LLM::Completion LLM::send(const Config &config, const std::string &body, const Network::DataCallback &onData,
+                              const std::atomic<bool> *cancelled) {
+        Completion completion;
+
+        // One retry on another member for retryable failures; streamed responses may already be half delivered
+        int attempts = config.pool.empty() || onData ? 1 : 2;
+        for (int attempt = 0; attempt < attempts; attempt++) {
+            auto lease = EndpointPool::acquire(config);
+
+            RequestArena arena;
+            Network::allocator_type alloc{arena.resource()};
+
+            Network::FetchOptions options{alloc};
+            options.method.assign("POST");
+            options.headers[std::pmr::string("Content-Type", alloc)].assign("application/json");
+            options.headers[std::pmr::string("Authorization", alloc)].assign("Bearer " + lease.endpoint.apiKey);
+            options.body.assign(body);
+            options.unixSocket.assign(lease.endpoint.socketPath);
+
+            // Time to first byte feeds the Router's latency history
+            auto started = std::chrono::steady_clock::now();
+            options.onData = [&](std::string_view chunk) {
+                if (completion.firstByteMicros == 0) {
+                    completion.firstByteMicros = elapsedMicros(started);
+                }
+                if (cancelled && *cancelled) {
+                    return false;
+                }
+                return !onData || onData(chunk);
+            };
+
+            Network::FetchResponse response{alloc};
+            completion.firstByteMicros = 0;
+            Network::request(completionsURL(lease.endpoint.baseURL), options, response);
+            completion.totalMicros = elapsedMicros(started);
+            EndpointPool::release(lease, response.status);
+
+            completion.status = response.status;
+            if (!response.ok) {
+                completion.error =
+                    "HTTP error! status: " + std::to_string(response.status) + ", body: " + std::string(response.bodyView());
+                if (response.status == 0 || response.status == 429 || response.status >= 500) {
+                    continue;
+                }
+                return completion;
+            }
+
+            // Kept for callers that need the raw body; parsed by complete()/stream()
+            completion.content.assign(response.bodyView());
+            completion.ok = true;
+            return completion;
+        }
+        return completion;
+    }
+
+    LLM::Completion LLM::complete(const Config &config, const std::string &systemContent, const std::string &userContent) {
+        if (LocalModel::isLocal(config.baseURL)) {
+            auto completion = LocalModel::generate(config, systemContent, userContent, nullptr);
+            Router::observe(config.id, completion, false);
+            return completion;
+        }
+
+        Completion completion;
+
+        try {
+            completion = send(config, PromptCache::requestBody(config, systemContent, userContent).dump(), nullptr);
+            if (completion.ok) {
+                json data               = json::parse(completion.content);
+                completion.content      = data.at("choices").at(0).at("message").at("content").get<std::string>();
+                json usage              = data.value("usage", json());
+                completion.outputTokens = outputTokens(usage);
+                completion.cachedTokens = PromptCache::observe(config.id, usage, completion.firstByteMicros);
+                Router::observe(config.id, completion, false);
+            }
+        } catch (const std::exception &e) {
+            Logger::getInstance().error("LLM::complete: Exception: {}", e.what());
+            completion.ok    = false;
+            completion.error = e.what();
+        }
+
+        return completion;
+    }
+
+    coco::future<std::string> LLM::completeAsync(const std::string &configJson, const std::string &systemContent,
+                                                 const std::string &userContent) {
+        auto promise = coco::promise<std::string>{};
+        auto future  = promise.get_future();
+
+        std::thread thread{[promise = std::move(promise), configJson, systemContent, userContent]() mutable {
+            Completion completion;
+            auto config = parseConfig(configJson);
+            if (!config) {
+                completion.error = "Invalid LLM configuration";
+            } else {
+                completion = complete(*config, systemContent, userContent);
+            }
+
+            json j = {
+                {"ok", completion.ok},
+                {"status", completion.status},
+                {"content", completion.content},
+                {"error", completion.error},
+            };
+            promise.set_value(j.dump(-1, ' ', false, json::error_handler_t::replace));
+        }};
+        thread.detach();
+
+        return future;
+    }
+
+    LLM::Completion LLM::stream(const Config &config, const std::string &systemContent, const std::string &userContent,
+                                const DeltaCallback &onDelta, const std::atomic<bool> *cancelled) {
+        static const json::json_pointer deltaContent("/choices/0/delta/content");
+
+        if (LocalModel::isLocal(config.baseURL)) {
+            // Tokens are handed to onDelta as they are decoded, like deltas of a network stream
+            auto completion = LocalModel::generate(config, systemContent, userContent, onDelta);
+            Router::observe(config.id, completion, true);
+            return completion;
+        }
+
+        Completion completion;
+        std::string content;
+        bool streamed = false;
+
+        try {
+            json body      = PromptCache::requestBody(config, systemContent, userContent);
+            body["stream"] = true;
+            if (PromptCache::markersFor(config) == PromptCache::Markers::OPENAI) {
+                // Usage, with the cached token count, only comes in a final chunk on request
+                body["stream_options"] = {{"include_usage", true}};
+            }
+            json usage;
+
+            // Server-sent events: one "data: {...}" line per delta, terminated by "data: [DONE]"
+            std::string pending;
+            auto onData = [&](std::string_view chunk) {
+                pending.append(chunk);
+
+                std::size_t start = 0;
+                for (std::size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', start)) {
+                    std::string_view line = trim(std::string_view(pending).substr(start, end - start));
+                    start                 = end + 1;
+                    if (!line.starts_with("data:")) {
+                        continue;
+                    }
+
+                    line = trim(line.substr(5));
+                    if (line == "[DONE]") {
+                        continue;
+                    }
+
+                    json event = json::parse(line, nullptr, false);
+                    if (!event.is_discarded() && event.contains("usage") && event["usage"].is_object()) {
+                        usage = event["usage"];
+                    }
+                    if (event.is_discarded() || !event.contains(deltaContent) || !event[deltaContent].is_string()) {
+                        continue;
+                    }
+
+                    const auto &delta = event[deltaContent].get_ref<const std::string &>();
+                    streamed          = true;
+                    content += delta;
+                    if (onDelta && !delta.empty()) {
+                        onDelta(delta);
+                    }
+                }
+                pending.erase(0, start);
+                return true;
+            };
+
+            completion = send(config, body.dump(), onData, cancelled);
+            if (completion.ok && !streamed) {
+                // The server ignored "stream" and answered in one piece
+                json data = json::parse(completion.content);
+                content   = data.at("choices").at(0).at("message").at("content").get<std::string>();
+                usage     = data.value("usage", json());
+                if (onDelta) {
+                    onDelta(content);
+                }
+            }
+            if (completion.ok) {
+                completion.content      = std::move(content);
+                completion.outputTokens = outputTokens(usage);
+                completion.cachedTokens = PromptCache::observe(config.id, usage, completion.firstByteMicros);
+                Router::observe(config.id, completion, streamed);
+            }
+        } catch (const std::exception &e) {
+            Logger::getInstance().error("LLM::stream: Exception: {}", e.what());
+            completion.ok    = false;
+            completion.error = e.what();
+        }
+
+        return completion;
+    }
+
+} // namespace byoa
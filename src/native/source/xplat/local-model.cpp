@@ -0,0 +1,915 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "gguf.hpp"
+#include "local-model.hpp"
+#include "logger.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        using TensorType = GgufFile::TensorType;
+        using Tensor     = GgufFile::Tensor;
+
+        float halfToFloat(uint16_t half) {
+            uint32_t sign     = (half & 0x8000u) << 16;
+            uint32_t exponent = (half >> 10) & 0x1f;
+            uint32_t mantissa = half & 0x3ffu;
+            uint32_t bits;
+            if (exponent == 0) {
+                if (mantissa == 0) {
+                    bits = sign;
+                } else {
+                    // Subnormal: renormalise
+                    exponent = 127 - 15 + 1;
+                    while (!(mantissa & 0x400u)) {
+                        mantissa <<= 1;
+                        exponent--;
+                    }
+                    bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+                }
+            } else if (exponent == 31) {
+                bits = sign | 0x7f800000u | (mantissa << 13);
+            } else {
+                bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+            }
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        float halfAt(const uint8_t *data) {
+            uint16_t half;
+            std::memcpy(&half, data, sizeof(half));
+            return halfToFloat(half);
+        }
+
+        // Q4_K packs 6-bit scales and mins for eight sub-blocks into 12 bytes
+        void scaleMinK4(int j, const uint8_t *q, uint8_t &scale, uint8_t &min) {
+            if (j < 4) {
+                scale = q[j] & 63;
+                min   = q[j + 4] & 63;
+            } else {
+                scale = (q[j + 4] & 0xf) | ((q[j - 4] >> 6) << 4);
+                min   = (q[j + 4] >> 4) | ((q[j] >> 6) << 4);
+            }
+        }
+
+        /**
+         * Expand one row of @p type into floats (block layouts as in ggml)
+         */
+        void dequantizeRow(TensorType type, const uint8_t *row, float *out, std::size_t n) {
+            switch (type) {
+            case TensorType::F32:
+                std::memcpy(out, row, n * sizeof(float));
+                break;
+            case TensorType::F16:
+                for (std::size_t i = 0; i < n; i++) {
+                    out[i] = halfAt(row + i * 2);
+                }
+                break;
+            case TensorType::Q8_0:
+                for (std::size_t b = 0; b < n / 32; b++, row += 34, out += 32) {
+                    float d    = halfAt(row);
+                    auto *q    = reinterpret_cast<const int8_t *>(row + 2);
+                    for (int i = 0; i < 32; i++) {
+                        out[i] = d * q[i];
+                    }
+                }
+                break;
+            case TensorType::Q4_0:
+                for (std::size_t b = 0; b < n / 32; b++, row += 18, out += 32) {
+                    float d = halfAt(row);
+                    for (int i = 0; i < 16; i++) {
+                        out[i]      = d * ((row[2 + i] & 0xf) - 8);
+                        out[i + 16] = d * ((row[2 + i] >> 4) - 8);
+                    }
+                }
+                break;
+            case TensorType::Q4_K:
+                for (std::size_t b = 0; b < n / 256; b++, row += 144) {
+                    float d        = halfAt(row);
+                    float dmin     = halfAt(row + 2);
+                    auto *scales   = row + 4;
+                    auto *q        = row + 16;
+                    for (int j = 0, is = 0; j < 256; j += 64, is += 2, q += 32) {
+                        uint8_t sc, m;
+                        scaleMinK4(is, scales, sc, m);
+                        float d1 = d * sc, m1 = dmin * m;
+                        scaleMinK4(is + 1, scales, sc, m);
+                        float d2 = d * sc, m2 = dmin * m;
+                        for (int l = 0; l < 32; l++) {
+                            *out++ = d1 * (q[l] & 0xf) - m1;
+                        }
+                        for (int l = 0; l < 32; l++) {
+                            *out++ = d2 * (q[l] >> 4) - m2;
+                        }
+                    }
+                }
+                break;
+            case TensorType::Q6_K:
+                for (std::size_t b = 0; b < n / 256; b++, row += 210) {
+                    auto *ql = row;
+                    auto *qh = row + 128;
+                    auto *sc = reinterpret_cast<const int8_t *>(row + 192);
+                    float d  = halfAt(row + 208);
+                    for (int half = 0; half < 2; half++, out += 128, ql += 64, qh += 32, sc += 8) {
+                        for (int l = 0; l < 32; l++) {
+                            int is       = l / 16;
+                            out[l]       = d * sc[is + 0] * (((ql[l] & 0xf) | (((qh[l] >> 0) & 3) << 4)) - 32);
+                            out[l + 32]  = d * sc[is + 2] * (((ql[l + 32] & 0xf) | (((qh[l] >> 2) & 3) << 4)) - 32);
+                            out[l + 64]  = d * sc[is + 4] * (((ql[l] >> 4) | (((qh[l] >> 4) & 3) << 4)) - 32);
+                            out[l + 96]  = d * sc[is + 6] * (((ql[l + 32] >> 4) | (((qh[l] >> 6) & 3) << 4)) - 32);
+                        }
+                    }
+                }
+                break;
+            }
+        }
+
+        float dot(const float *a, const float *b, std::size_t n) {
+            std::size_t i = 0;
+            float sum     = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+            }
+            __m256 acc  = _mm256_add_ps(acc0, acc1);
+            __m128 low  = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            low         = _mm_add_ps(low, _mm_movehl_ps(low, low));
+            low         = _mm_add_ss(low, _mm_shuffle_ps(low, low, 1));
+            sum         = _mm_cvtss_f32(low);
+#elif defined(__ARM_NEON)
+            float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+            for (; i + 8 <= n; i += 8) {
+                acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+                acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+            }
+            sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#else
+            // Independent accumulators let the compiler vectorise without -ffast-math
+            float acc[8] = {};
+            for (; i + 8 <= n; i += 8) {
+                for (int k = 0; k < 8; k++) {
+                    acc[k] += a[i + k] * b[i + k];
+                }
+            }
+            for (float value : acc) {
+                sum += value;
+            }
+#endif
+            for (; i < n; i++) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        void rmsNorm(float *out, const float *x, const float *weight, std::size_t n, float eps) {
+            float squares = dot(x, x, n);
+            float scale   = 1.0f / std::sqrt(squares / n + eps);
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = x[i] * scale * weight[i];
+            }
+        }
+
+        /**
+         * Fixed pool of worker threads for data-parallel loops; the caller works too
+         */
+        class Workers {
+          public:
+            explicit Workers(std::size_t count) {
+                for (std::size_t i = 0; i < count; i++) {
+                    _threads.emplace_back([this] { loop(); });
+                }
+            }
+
+            ~Workers() {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stop = true;
+                }
+                _wake.notify_all();
+                for (auto &thread : _threads) {
+                    thread.join();
+                }
+            }
+
+            using Task = std::function<void(std::size_t begin, std::size_t end)>;
+
+            /**
+             * Run @p task over [0, items) in chunks, returning when all are done
+             */
+            void run(std::size_t items, const Task &task) {
+                if (_threads.empty() || items < 2) {
+                    task(0, items);
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _task    = &task;
+                    _items   = items;
+                    _chunk   = std::max<std::size_t>(1, items / ((_threads.size() + 1) * 4));
+                    _next    = 0;
+                    _pending = _threads.size();
+                    _generation++;
+                }
+                _wake.notify_all();
+                work();
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                _done.wait(lock, [this] { return _pending == 0; });
+            }
+
+            std::size_t size() const {
+                return _threads.size() + 1;
+            }
+
+          private:
+            void work() {
+                for (std::size_t begin = _next.fetch_add(_chunk); begin < _items; begin = _next.fetch_add(_chunk)) {
+                    (*_task)(begin, std::min(begin + _chunk, _items));
+                }
+            }
+
+            void loop() {
+                uint64_t seen = 0;
+                while (true) {
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _wake.wait(lock, [&] { return _stop || _generation != seen; });
+                        if (_stop) {
+                            return;
+                        }
+                        seen = _generation;
+                    }
+                    work();
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (--_pending == 0) {
+                        _done.notify_one();
+                    }
+                }
+            }
+
+            std::vector<std::thread> _threads;
+            std::mutex _mutex;
+            std::condition_variable _wake;
+            std::condition_variable _done;
+            const Task *_task    = nullptr;
+            std::size_t _items   = 0;
+            std::size_t _chunk   = 1;
+            std::size_t _pending = 0;
+            uint64_t _generation = 0;
+            std::atomic<std::size_t> _next{0};
+            bool _stop = false;
+        };
+
+        /**
+         * SentencePiece (llama) tokenizer over the vocabulary embedded in the GGUF file
+         */
+        class Tokenizer {
+          public:
+            bool load(const json &metadata) {
+                if (metadata.value("tokenizer.ggml.model", "") != "llama") {
+                    Logger::getInstance().error("LocalModel: Unsupported tokenizer '{}'", metadata.value("tokenizer.ggml.model", ""));
+                    return false;
+                }
+
+                _pieces          = metadata.at("tokenizer.ggml.tokens").get<std::vector<std::string>>();
+                _scores          = metadata.value("tokenizer.ggml.scores", std::vector<float>(_pieces.size(), 0.0f));
+                _types           = metadata.value("tokenizer.ggml.token_type", std::vector<int>(_pieces.size(), NORMAL));
+                bos              = metadata.value("tokenizer.ggml.bos_token_id", 1);
+                eos              = metadata.value("tokenizer.ggml.eos_token_id", 2);
+                _unknown         = metadata.value("tokenizer.ggml.unknown_token_id", 0);
+                _addBos          = metadata.value("tokenizer.ggml.add_bos_token", true);
+                _addSpacePrefix  = metadata.value("tokenizer.ggml.add_space_prefix", true);
+                if (_scores.size() != _pieces.size() || _types.size() != _pieces.size()) {
+                    Logger::getInstance().error("LocalModel: Inconsistent vocabulary arrays");
+                    return false;
+                }
+
+                std::fill(std::begin(_bytes), std::end(_bytes), -1);
+                for (int id = 0; id < static_cast<int>(_pieces.size()); id++) {
+                    const auto &piece = _pieces[id];
+                    _ids.emplace(piece, id);
+                    if (_types[id] == BYTE && piece.size() == 6) {
+                        _bytes[std::stoi(piece.substr(3, 2), nullptr, 16)] = id;
+                    }
+                    if ((_types[id] == CONTROL || _types[id] == USER_DEFINED) && !piece.empty()) {
+                        _specials.emplace_back(piece, id);
+                    }
+                }
+                // Longest first, so "<|im_start|>" wins over any shorter special it begins with
+                std::sort(_specials.begin(), _specials.end(), [](const auto &a, const auto &b) { return a.first.size() > b.first.size(); });
+                return true;
+            }
+
+            std::vector<int> encode(const std::string &text) const {
+                std::vector<int> tokens;
+                if (_addBos && bos >= 0) {
+                    tokens.push_back(bos);
+                }
+
+                // Special tokens in the text (chat template markers) map to their ids directly
+                std::size_t start = 0;
+                while (start < text.size()) {
+                    std::size_t best = std::string::npos;
+                    const std::pair<std::string, int> *special = nullptr;
+                    for (const auto &candidate : _specials) {
+                        auto at = text.find(candidate.first, start);
+                        if (at < best) {
+                            best    = at;
+                            special = &candidate;
+                        }
+                    }
+                    encodeText(text.substr(start, best == std::string::npos ? std::string::npos : best - start), start == 0, tokens);
+                    if (!special) {
+                        break;
+                    }
+                    tokens.push_back(special->second);
+                    start = best + special->first.size();
+                }
+                return tokens;
+            }
+
+            /**
+             * Text of @p id; control tokens decode to nothing
+             */
+            std::string decode(int id) const {
+                if (id < 0 || id >= static_cast<int>(_pieces.size()) || _types[id] == CONTROL) {
+                    return {};
+                }
+                if (_types[id] == BYTE) {
+                    return std::string(1, static_cast<char>(std::stoi(_pieces[id].substr(3, 2), nullptr, 16)));
+                }
+                std::string text = _pieces[id];
+                for (auto at = text.find(SPACE); at != std::string::npos; at = text.find(SPACE, at + 1)) {
+                    text.replace(at, SPACE.size(), " ");
+                }
+                return text;
+            }
+
+            bool isEnd(int id) const {
+                return id == eos || (id >= 0 && id < static_cast<int>(_types.size()) && _types[id] == CONTROL);
+            }
+
+            std::size_t size() const {
+                return _pieces.size();
+            }
+
+            int bos = -1;
+            int eos = -1;
+
+          private:
+            enum TokenType { NORMAL = 1, UNKNOWN = 2, CONTROL = 3, USER_DEFINED = 4, UNUSED = 5, BYTE = 6 };
+
+            static constexpr std::string_view SPACE = "\xe2\x96\x81"; // U+2581
+
+            struct Symbol {
+                std::size_t offset;
+                std::size_t length;
+                int prev;
+                int next;
+            };
+
+            struct Bigram {
+                float score;
+                int left;
+                std::size_t length;
+
+                bool operator<(const Bigram &other) const {
+                    return score < other.score || (score == other.score && left > other.left);
+                }
+            };
+
+            // Byte-pair merging by piece score, as SentencePiece does
+            void encodeText(const std::string &raw, bool first, std::vector<int> &tokens) const {
+                if (raw.empty()) {
+                    return;
+                }
+                std::string text = first && _addSpacePrefix ? std::string(SPACE) : std::string();
+                for (char c : raw) {
+                    if (c == ' ') {
+                        text += SPACE;
+                    } else {
+                        text += c;
+                    }
+                }
+
+                std::vector<Symbol> symbols;
+                for (std::size_t offset = 0; offset < text.size();) {
+                    auto lead   = static_cast<uint8_t>(text[offset]);
+                    std::size_t length = lead < 0x80 ? 1 : lead < 0xe0 ? 2 : lead < 0xf0 ? 3 : 4;
+                    length      = std::min(length, text.size() - offset);
+                    symbols.push_back({offset, length, static_cast<int>(symbols.size()) - 1, static_cast<int>(symbols.size()) + 1});
+                    offset += length;
+                }
+                symbols.back().next = -1;
+
+                std::priority_queue<Bigram> queue;
+                auto tryBigram = [&](int left, int right) {
+                    if (left < 0 || right < 0) {
+                        return;
+                    }
+                    std::size_t length = symbols[left].length + symbols[right].length;
+                    auto it            = _ids.find(text.substr(symbols[left].offset, length));
+                    if (it != _ids.end()) {
+                        queue.push({_scores[it->second], left, length});
+                    }
+                };
+                for (int i = 1; i < static_cast<int>(symbols.size()); i++) {
+                    tryBigram(i - 1, i);
+                }
+
+                while (!queue.empty()) {
+                    auto bigram = queue.top();
+                    queue.pop();
+                    auto &left = symbols[bigram.left];
+                    if (left.length == 0 || left.next < 0 || left.length + symbols[left.next].length != bigram.length) {
+                        // Stale: one side was merged since
+                        continue;
+                    }
+                    auto &right  = symbols[left.next];
+                    left.length += right.length;
+                    right.length = 0;
+                    left.next    = right.next;
+                    if (left.next >= 0) {
+                        symbols[left.next].prev = bigram.left;
+                    }
+                    tryBigram(left.prev, bigram.left);
+                    tryBigram(bigram.left, left.next);
+                }
+
+                for (int i = 0; i >= 0; i = symbols[i].next) {
+                    auto piece = text.substr(symbols[i].offset, symbols[i].length);
+                    auto it    = _ids.find(piece);
+                    if (it != _ids.end()) {
+                        tokens.push_back(it->second);
+                        continue;
+                    }
+                    for (unsigned char c : piece) {
+                        tokens.push_back(_bytes[c] >= 0 ? _bytes[c] : _unknown);
+                    }
+                }
+            }
+
+            std::vector<std::string> _pieces;
+            std::vector<float> _scores;
+            std::vector<int> _types;
+            std::unordered_map<std::string, int> _ids;
+            std::vector<std::pair<std::string, int>> _specials;
+            int _bytes[256];
+            int _unknown         = 0;
+            bool _addBos         = true;
+            bool _addSpacePrefix = true;
+        };
+
+        /**
+         * Number of bytes at the end of @p text that start an unfinished UTF-8 sequence
+         */
+        std::size_t incompleteUtf8(const std::string &text) {
+            for (std::size_t back = 1; back <= std::min<std::size_t>(3, text.size()); back++) {
+                auto c = static_cast<uint8_t>(text[text.size() - back]);
+                if ((c & 0xc0) == 0x80) {
+                    continue;
+                }
+                std::size_t length = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+                return length > back ? back : 0;
+            }
+            return 0;
+        }
+
+    } // namespace
+
+    class LocalModel::Engine {
+      public:
+        static std::shared_ptr<Engine> load(const std::string &path) {
+            auto engine  = std::shared_ptr<Engine>(new Engine());
+            engine->_file = GgufFile::open(path);
+            if (!engine->_file || !engine->init()) {
+                return nullptr;
+            }
+            return engine;
+        }
+
+        /**
+         * Chat prompt in the model's own template (detected from tokenizer.chat_template)
+         */
+        std::string chatPrompt(const std::string &systemContent, const std::string &userContent) const {
+            if (_template.find("<|im_start|>") != std::string::npos) {
+                return "<|im_start|>system\n" + systemContent + "<|im_end|>\n<|im_start|>user\n" + userContent +
+                       "<|im_end|>\n<|im_start|>assistant\n";
+            }
+            if (_template.find("<|user|>") != std::string::npos) {
+                return "<|system|>\n" + systemContent + "</s>\n<|user|>\n" + userContent + "</s>\n<|assistant|>\n";
+            }
+            return "[INST] <<SYS>>\n" + systemContent + "\n<</SYS>>\n\n" + userContent + " [/INST]";
+        }
+
+        LLM::Completion generate(const std::string &prompt, const LLM::DeltaCallback &onDelta) {
+            using Clock = std::chrono::steady_clock;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            LLM::Completion completion;
+            auto started = Clock::now();
+            auto micros  = [&] { return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count(); };
+
+            auto tokens = _tokenizer.encode(prompt);
+            if (tokens.size() >= _context) {
+                completion.error = fmt::format("Prompt of {} tokens exceeds the local context of {}", tokens.size(), _context);
+                return completion;
+            }
+
+            // Keep the KV cache of the longest common prefix with the previous prompt
+            std::size_t reused = 0;
+            while (reused < _cached.size() && reused + 1 < tokens.size() && _cached[reused] == tokens[reused]) {
+                reused++;
+            }
+            _cached.assign(tokens.begin(), tokens.begin() + reused);
+
+            std::vector<float> logits;
+            for (std::size_t at = reused; at < tokens.size(); at += PROMPT_BATCH) {
+                auto count = std::min(PROMPT_BATCH, tokens.size() - at);
+                logits     = forward(&tokens[at], count, at);
+                _cached.insert(_cached.end(), tokens.begin() + at, tokens.begin() + at + count);
+            }
+            auto promptMicros = micros();
+
+            std::string content;
+            std::string pending;
+            std::size_t generated = 0;
+            auto limit            = std::min(MAX_NEW_TOKENS, _context - tokens.size());
+            while (generated < limit) {
+                int next = static_cast<int>(std::max_element(logits.begin(), logits.end()) - logits.begin());
+                if (_tokenizer.isEnd(next)) {
+                    break;
+                }
+                generated++;
+                if (generated == 1) {
+                    completion.firstByteMicros = micros();
+                }
+
+                // Hold back partial UTF-8 sequences split across byte tokens
+                pending += _tokenizer.decode(next);
+                if (content.empty()) {
+                    // The reply's first piece carries the word-start marker of SentencePiece
+                    pending.erase(0, std::min(pending.find_first_not_of(' '), pending.size()));
+                }
+                auto ready = pending.size() - incompleteUtf8(pending);
+                if (ready > 0) {
+                    auto delta = pending.substr(0, ready);
+                    pending.erase(0, ready);
+                    content += delta;
+                    if (onDelta) {
+                        onDelta(delta);
+                    }
+                }
+
+                if (_cached.size() >= _context) {
+                    break;
+                }
+                _cached.push_back(next);
+                logits = forward(&next, 1, _cached.size() - 1);
+            }
+            if (!pending.empty()) {
+                content += pending;
+                if (onDelta) {
+                    onDelta(pending);
+                }
+            }
+
+            completion.totalMicros  = micros();
+            completion.outputTokens = generated;
+            completion.content      = std::move(content);
+            completion.status       = 200;
+            completion.ok           = true;
+
+            auto evaluated      = tokens.size() - reused;
+            auto generateMicros = completion.totalMicros - promptMicros;
+            Logger::getInstance().info("LocalModel::generate: prompt {} tokens ({} reused) at {:.1f} tok/s, {} tokens at {:.1f} tok/s, "
+                                       "{} threads",
+                                       tokens.size(), reused, evaluated * 1e6 / std::max<int64_t>(promptMicros, 1), generated,
+                                       generated * 1e6 / std::max<int64_t>(generateMicros, 1), _workers->size());
+            return completion;
+        }
+
+      private:
+        struct Layer {
+            std::vector<float> attnNorm;
+            std::vector<float> ffnNorm;
+            const Tensor *wq;
+            const Tensor *wk;
+            const Tensor *wv;
+            const Tensor *wo;
+            const Tensor *gate;
+            const Tensor *up;
+            const Tensor *down;
+        };
+
+        Engine() = default;
+
+        bool init() {
+            const auto &meta = _file->metadata();
+            auto arch        = meta.value("general.architecture", "");
+            if (arch != "llama") {
+                Logger::getInstance().error("LocalModel: Unsupported architecture '{}'", arch);
+                return false;
+            }
+            if (!_tokenizer.load(meta)) {
+                return false;
+            }
+
+            try {
+                _dim       = meta.at(arch + ".embedding_length").get<std::size_t>();
+                _hidden    = meta.at(arch + ".feed_forward_length").get<std::size_t>();
+                _heads     = meta.at(arch + ".attention.head_count").get<std::size_t>();
+                _kvHeads   = meta.value(arch + ".attention.head_count_kv", _heads);
+                _eps       = meta.value(arch + ".attention.layer_norm_rms_epsilon", 1e-5f);
+                _ropeBase  = meta.value(arch + ".rope.freq_base", 10000.0f);
+                _headDim   = _dim / _heads;
+                _ropeDim   = meta.value(arch + ".rope.dimension_count", _headDim);
+                _context   = std::min<std::size_t>(meta.value(arch + ".context_length", MAX_CONTEXT), MAX_CONTEXT);
+                _template  = meta.value("tokenizer.chat_template", "");
+                auto count = meta.at(arch + ".block_count").get<std::size_t>();
+
+                _embedding = require("token_embd.weight", _dim, _tokenizer.size());
+                _output    = _file->tensor("output.weight") ? require("output.weight", _dim, _tokenizer.size()) : _embedding;
+                _outNorm   = vectorOf("output_norm.weight", _dim);
+                for (std::size_t i = 0; i < count; i++) {
+                    auto name = [&](const char *suffix) { return fmt::format("blk.{}.{}", i, suffix); };
+                    Layer layer;
+                    layer.attnNorm = vectorOf(name("attn_norm.weight"), _dim);
+                    layer.ffnNorm  = vectorOf(name("ffn_norm.weight"), _dim);
+                    layer.wq       = require(name("attn_q.weight"), _dim, _dim);
+                    layer.wk       = require(name("attn_k.weight"), _dim, kvDim());
+                    layer.wv       = require(name("attn_v.weight"), _dim, kvDim());
+                    layer.wo       = require(name("attn_output.weight"), _dim, _dim);
+                    layer.gate     = require(name("ffn_gate.weight"), _dim, _hidden);
+                    layer.up       = require(name("ffn_up.weight"), _dim, _hidden);
+                    layer.down     = require(name("ffn_down.weight"), _hidden, _dim);
+                    _layers.push_back(std::move(layer));
+                }
+            } catch (const std::exception &e) {
+                Logger::getInstance().error("LocalModel: Invalid model: {}", e.what());
+                return false;
+            }
+
+            _keys.assign(_layers.size() * _context * kvDim(), 0.0f);
+            _values.assign(_layers.size() * _context * kvDim(), 0.0f);
+
+            auto threads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, MAX_THREADS);
+            _workers     = std::make_unique<Workers>(threads - 1);
+
+            Logger::getInstance().info("LocalModel: Loaded {} layers, dim {}, {} heads ({} kv), vocab {}, context {}", _layers.size(), _dim,
+                                       _heads, _kvHeads, _tokenizer.size(), _context);
+            return true;
+        }
+
+        std::size_t kvDim() const {
+            return _headDim * _kvHeads;
+        }
+
+        const Tensor *require(const std::string &name, std::size_t columns, std::size_t rows) const {
+            const auto *tensor = _file->tensor(name);
+            if (!tensor || tensor->dims.size() != 2 || tensor->dims[0] != columns || tensor->dims[1] != rows) {
+                throw std::runtime_error(fmt::format("tensor {} missing or not {}x{}", name, columns, rows));
+            }
+            return tensor;
+        }
+
+        std::vector<float> vectorOf(const std::string &name, std::size_t size) const {
+            const auto *tensor = _file->tensor(name);
+            if (!tensor || tensor->dims[0] != size) {
+                throw std::runtime_error(fmt::format("tensor {} missing or not of size {}", name, size));
+            }
+            std::vector<float> values(size);
+            dequantizeRow(tensor->type, tensor->data, values.data(), size);
+            return values;
+        }
+
+        /**
+         * out[b][row] = W[row] . in[b] for a batch of @p batch vectors; each weight row is expanded once
+         */
+        void matmul(const Tensor &weights, const float *in, float *out, std::size_t batch) {
+            auto columns = weights.dims[0];
+            auto rows    = weights.dims[1];
+            _workers->run(rows, [&](std::size_t begin, std::size_t end) {
+                thread_local std::vector<float> expanded;
+                expanded.resize(columns);
+                for (std::size_t row = begin; row < end; row++) {
+                    const auto *data = weights.data + row * weights.rowBytes;
+                    const float *w   = reinterpret_cast<const float *>(data);
+                    if (weights.type != TensorType::F32 || reinterpret_cast<uintptr_t>(data) % alignof(float) != 0) {
+                        dequantizeRow(weights.type, data, expanded.data(), columns);
+                        w = expanded.data();
+                    }
+                    for (std::size_t b = 0; b < batch; b++) {
+                        out[b * rows + row] = dot(w, in + b * columns, columns);
+                    }
+                }
+            });
+        }
+
+        void rope(float *vector, std::size_t heads, std::size_t position) const {
+            for (std::size_t h = 0; h < heads; h++) {
+                float *head = vector + h * _headDim;
+                for (std::size_t i = 0; i + 1 < _ropeDim; i += 2) {
+                    float angle = position * std::pow(_ropeBase, -static_cast<float>(i) / _ropeDim);
+                    float c = std::cos(angle), s = std::sin(angle);
+                    float x0 = head[i], x1 = head[i + 1];
+                    head[i]     = x0 * c - x1 * s;
+                    head[i + 1] = x0 * s + x1 * c;
+                }
+            }
+        }
+
+        /**
+         * Run @p count tokens at positions [start, start + count) through the model; returns the last token's logits
+         */
+        std::vector<float> forward(const int *tokens, std::size_t count, std::size_t start) {
+            auto kv = kvDim();
+            std::vector<float> x(count * _dim), norm(count * _dim), q(count * _dim), attention(count * _dim), projected(count * _dim);
+            std::vector<float> k(count * kv), v(count * kv), gate(count * _hidden), up(count * _hidden);
+
+            for (std::size_t b = 0; b < count; b++) {
+                dequantizeRow(_embedding->type, _embedding->data + tokens[b] * _embedding->rowBytes, &x[b * _dim], _dim);
+            }
+
+            for (std::size_t l = 0; l < _layers.size(); l++) {
+                const auto &layer = _layers[l];
+                float *keys       = &_keys[l * _context * kv];
+                float *values     = &_values[l * _context * kv];
+
+                for (std::size_t b = 0; b < count; b++) {
+                    rmsNorm(&norm[b * _dim], &x[b * _dim], layer.attnNorm.data(), _dim, _eps);
+                }
+                matmul(*layer.wq, norm.data(), q.data(), count);
+                matmul(*layer.wk, norm.data(), k.data(), count);
+                matmul(*layer.wv, norm.data(), v.data(), count);
+                for (std::size_t b = 0; b < count; b++) {
+                    rope(&q[b * _dim], _heads, start + b);
+                    rope(&k[b * kv], _kvHeads, start + b);
+                    std::copy_n(&k[b * kv], kv, keys + (start + b) * kv);
+                    std::copy_n(&v[b * kv], kv, values + (start + b) * kv);
+                }
+
+                // Causal attention, one (token, head) pair per work item
+                float scale = 1.0f / std::sqrt(static_cast<float>(_headDim));
+                _workers->run(count * _heads, [&](std::size_t begin, std::size_t end) {
+                    thread_local std::vector<float> scores;
+                    for (std::size_t item = begin; item < end; item++) {
+                        auto b       = item / _heads;
+                        auto h       = item % _heads;
+                        auto kvHead  = h / (_heads / _kvHeads);
+                        auto visible = start + b + 1;
+                        const float *query = &q[b * _dim + h * _headDim];
+
+                        scores.resize(visible);
+                        float highest = -INFINITY;
+                        for (std::size_t t = 0; t < visible; t++) {
+                            scores[t] = dot(query, keys + t * kv + kvHead * _headDim, _headDim) * scale;
+                            highest   = std::max(highest, scores[t]);
+                        }
+                        float total = 0;
+                        for (auto &score : scores) {
+                            score = std::exp(score - highest);
+                            total += score;
+                        }
+
+                        float *result = &attention[b * _dim + h * _headDim];
+                        std::fill_n(result, _headDim, 0.0f);
+                        for (std::size_t t = 0; t < visible; t++) {
+                            const float *value = values + t * kv + kvHead * _headDim;
+                            float weight       = scores[t] / total;
+                            for (std::size_t i = 0; i < _headDim; i++) {
+                                result[i] += weight * value[i];
+                            }
+                        }
+                    }
+                });
+
+                matmul(*layer.wo, attention.data(), projected.data(), count);
+                for (std::size_t i = 0; i < x.size(); i++) {
+                    x[i] += projected[i];
+                }
+
+                // SwiGLU feed-forward
+                for (std::size_t b = 0; b < count; b++) {
+                    rmsNorm(&norm[b * _dim], &x[b * _dim], layer.ffnNorm.data(), _dim, _eps);
+                }
+                matmul(*layer.gate, norm.data(), gate.data(), count);
+                matmul(*layer.up, norm.data(), up.data(), count);
+                for (std::size_t i = 0; i < gate.size(); i++) {
+                    gate[i] = gate[i] / (1.0f + std::exp(-gate[i])) * up[i];
+                }
+                matmul(*layer.down, gate.data(), projected.data(), count);
+                for (std::size_t i = 0; i < x.size(); i++) {
+                    x[i] += projected[i];
+                }
+            }
+
+            std::vector<float> last(_dim), logits(_tokenizer.size());
+            rmsNorm(last.data(), &x[(count - 1) * _dim], _outNorm.data(), _dim, _eps);
+            matmul(*_output, last.data(), logits.data(), 1);
+            return logits;
+        }
+
+        std::unique_ptr<GgufFile> _file;
+        Tokenizer _tokenizer;
+        std::unique_ptr<Workers> _workers;
+        std::mutex _mutex;
+
+        std::size_t _dim     = 0;
+        std::size_t _hidden  = 0;
+        std::size_t _heads   = 0;
+        std::size_t _kvHeads = 0;
+        std::size_t _headDim = 0;
+        std::size_t _ropeDim = 0;
+        std::size_t _context = 0;
+        float _eps           = 1e-5f;
+        float _ropeBase      = 10000.0f;
+        std::string _template;
+
+        const Tensor *_embedding = nullptr;
+        const Tensor *_output    = nullptr;
+        std::vector<float> _outNorm;
+        std::vector<Layer> _layers;
+
+        // [layer][position][kv head * head dim]
+        std::vector<float> _keys;
+        std::vector<float> _values;
+        std::vector<int> _cached;
+    };
+
+    struct LocalModel::Registry {
+        std::mutex mutex;
+        std::string path;
+        std::shared_ptr<Engine> engine;
+    };
+
+    LocalModel::Registry &LocalModel::registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    std::shared_ptr<LocalModel::Engine> LocalModel::engineFor(const std::string &path) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (r.engine && r.path == path) {
+            return r.engine;
+        }
+
+        // One model at a time: a second set of mapped weights would double the working set
+        r.engine.reset();
+        r.path.clear();
+        auto started = std::chrono::steady_clock::now();
+        r.engine     = Engine::load(path);
+        if (r.engine) {
+            r.path = path;
+            Logger::getInstance().info("LocalModel::engineFor: Loaded {} in {} ms", path,
+                                       std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started)
+                                           .count());
+        }
+        return r.engine;
+    }
+
+    LLM::Completion LocalModel::generate(const LLM::Config &config, const std::string &systemContent, const std::string &userContent,
+                                         const LLM::DeltaCallback &onDelta) {
+        auto path   = config.baseURL.substr(SCHEME.size());
+        auto engine = engineFor(path);
+        if (!engine) {
+            LLM::Completion completion;
+            completion.error = "Cannot load local model " + path;
+            return completion;
+        }
+        return engine->generate(engine->chatPrompt(systemContent, userContent), onDelta);
+    }
+
+    void LocalModel::unload() {
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.engine.reset();
+        r.path.clear();
+    }
+
+} // namespace byoa
@@ -1,5 +1,12 @@
 #include "app-controller.hpp"
+#include "bridge-stats.hpp"
+#include "config-store.hpp"
+#include "connection-cache.hpp"
+#include "event-bus.hpp"
+#include "gateway.hpp"
 #include "logger.hpp"
+#include "recording.hpp"
+#include "vault.hpp"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -10,6 +17,15 @@ int main() {
     Logger::getInstance().init();
     Logger::getInstance().info("Main::start: start");
 
+    byoa::ConnectionCache::load();
+    byoa::Recording::configureFromEnvironment();
+    byoa::Vault::configureFromEnvironment();
+    // API keys the credential store rejects are retried natively, but every window should say so
+    byoa::Vault::setStatusListener([](const std::string &status) { byoa::EventBus::publish(byoa::events::VaultStatus{status}); });
+    byoa::ConfigStore::migrateFromVault();
+    byoa::Gateway::configureFromEnvironment();
+    byoa::BridgeStats::configureFromEnvironment();
+
     AppController::getInstance().init();
     int status = AppController::getInstance().start();
 
@@ -1,9 +1,20 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
+#include <string_view>
 #include <thread>
 
+#include "arena.hpp"
+#include "connection-cache.hpp"
+#include "json-escape.hpp"
 #include "logger.hpp"
 #include "network.hpp"
+#include "recording.hpp"
 
 #ifdef __APPLE__
 #include <CoreFoundation/CoreFoundation.h>
@@ -14,55 +25,299 @@ using json = nlohmann::json;
 
 namespace byoa {
 
-    Network::FetchOptions Network::parseOptions(const std::string &optionsJson) {
-        FetchOptions options;
+    namespace {
+
+        // Whole-transfer limit for buffered requests
+        constexpr auto REQUEST_TIMEOUT     = std::chrono::seconds(30);
+        // Streamed requests may legitimately run for minutes; they fail only once the server goes quiet
+        constexpr auto STREAM_IDLE_TIMEOUT = std::chrono::seconds(30);
+        constexpr auto CONNECT_TIMEOUT     = std::chrono::seconds(10);
+
+        /**
+         * @brief SAX handler filling FetchOptions without building a JSON DOM
+         *
+         * Keeps string values of "method", "body", "unixSocket", the "memoryLimit" and
+         * "maxBodySize" numbers, the "headers" object and the
+         * "bodyParts" array; anything else is skipped. Each body part is either
+         * {"text": "..."} or {"attachment": "<handle>", "encoding": "dataUrl"}.
+         */
+        class OptionsSaxHandler : public json::json_sax_t {
+          public:
+            explicit OptionsSaxHandler(Network::FetchOptions &options)
+                : _options(options), _key(options.headers.get_allocator()), _innerKey(options.headers.get_allocator()),
+                  _partText(options.headers.get_allocator()), _partAttachment(options.headers.get_allocator()),
+                  _partEncoding(options.headers.get_allocator()) {}
+
+            bool null() override {
+                return true;
+            }
 
-        if (optionsJson.empty()) {
-            return options;
-        }
+            bool boolean(bool) override {
+                return true;
+            }
 
-        try {
-            json j = json::parse(optionsJson);
+            bool number_integer(number_integer_t) override {
+                return true;
+            }
+
+            bool number_unsigned(number_unsigned_t value) override {
+                if (_depth == 1 && _key == "memoryLimit") {
+                    _options.memoryLimit = static_cast<std::size_t>(value);
+                } else if (_depth == 1 && _key == "maxBodySize") {
+                    _options.maxBodySize = static_cast<std::size_t>(value);
+                }
+                return true;
+            }
 
-            // Parse method
-            if (j.contains("method") && j["method"].is_string()) {
-                options.method = j["method"].get<std::string>();
+            bool number_float(number_float_t, const string_t &) override {
+                return true;
             }
 
-            // Parse headers
-            if (j.contains("headers") && j["headers"].is_object()) {
-                for (auto &[key, value] : j["headers"].items()) {
-                    if (value.is_string()) {
-                        options.headers[key] = value.get<std::string>();
+            bool binary(binary_t &) override {
+                return true;
+            }
+
+            bool string(string_t &value) override {
+                if (_depth == 1 && _key == "method") {
+                    _options.method.assign(value);
+                } else if (_depth == 1 && _key == "body") {
+                    _options.body.assign(value);
+                } else if (_depth == 1 && _key == "unixSocket") {
+                    _options.unixSocket.assign(value);
+                } else if (_depth == 2 && _section == Section::HEADERS) {
+                    _options.headers[_innerKey].assign(value);
+                } else if (_depth == 3 && _section == Section::BODY_PARTS) {
+                    if (_innerKey == "text") {
+                        _partText.assign(value);
+                    } else if (_innerKey == "attachment") {
+                        _partAttachment.assign(value);
+                    } else if (_innerKey == "encoding") {
+                        _partEncoding.assign(value);
                     }
                 }
+                return true;
+            }
+
+            bool start_object(std::size_t) override {
+                _depth++;
+                if (_depth == 2 && _key == "headers") {
+                    _section = Section::HEADERS;
+                } else if (_depth == 3 && _section == Section::BODY_PARTS) {
+                    _partText.clear();
+                    _partAttachment.clear();
+                    _partEncoding.clear();
+                }
+                return true;
+            }
+
+            bool key(string_t &value) override {
+                if (_depth == 1) {
+                    _key.assign(value);
+                } else if ((_depth == 2 && _section == Section::HEADERS) || (_depth == 3 && _section == Section::BODY_PARTS)) {
+                    _innerKey.assign(value);
+                }
+                return true;
+            }
+
+            bool end_object() override {
+                if (_depth == 3 && _section == Section::BODY_PARTS) {
+                    commitPart();
+                } else if (_depth == 2 && _section == Section::HEADERS) {
+                    _section = Section::NONE;
+                }
+                _depth--;
+                return true;
+            }
+
+            bool start_array(std::size_t) override {
+                _depth++;
+                if (_depth == 2 && _key == "bodyParts") {
+                    _section = Section::BODY_PARTS;
+                }
+                return true;
+            }
+
+            bool end_array() override {
+                if (_depth == 2 && _section == Section::BODY_PARTS) {
+                    _section = Section::NONE;
+                }
+                _depth--;
+                return true;
+            }
+
+            bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &e) override {
+                Logger::getInstance().error("Network::parseOptions: JSON parse error: {}", e.what());
+                return false;
             }
 
-            // Parse body
-            if (j.contains("body") && j["body"].is_string()) {
-                options.body = j["body"].get<std::string>();
+          private:
+            enum class Section { NONE, HEADERS, BODY_PARTS };
+
+            void commitPart() {
+                if (_partAttachment.empty()) {
+                    _options.body.append(_partText);
+                    return;
+                }
+
+                auto attachment = Attachments::get(std::string(_partAttachment));
+                if (!attachment) {
+                    throw std::runtime_error("Unknown attachment handle: " + std::string(_partAttachment));
+                }
+
+                auto encoding = Attachments::parseEncoding(_partEncoding.empty() ? "raw" : _partEncoding);
+                if (!encoding) {
+                    throw std::runtime_error("Unknown attachment encoding: " + std::string(_partEncoding));
+                }
+
+                _options.attachments.push_back({_options.body.size(), *encoding, std::move(attachment)});
             }
-        } catch (const json::exception &e) {
-            Logger::getInstance().error("Network::parseOptions: JSON parse error: {}", e.what());
+
+            Network::FetchOptions &_options;
+            std::pmr::string _key;
+            std::pmr::string _innerKey;
+            std::pmr::string _partText;
+            std::pmr::string _partAttachment;
+            std::pmr::string _partEncoding;
+            int _depth       = 0;
+            Section _section = Section::NONE;
+        };
+
+        constexpr std::string_view trim(std::string_view value) {
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+                value.remove_prefix(1);
+            }
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r' || value.back() == '\n')) {
+                value.remove_suffix(1);
+            }
+            return value;
+        }
+
+        int64_t elapsedMicros(std::chrono::steady_clock::time_point since) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+        }
+
+        bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < a.size(); i++) {
+                if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                    return false;
+                }
+            }
+            return true;
         }
 
-        return options;
+        // POST/PUT bodies are streamed from the options' buffer; curl seeks back on redirects and retries
+        struct BodyReader {
+            std::string_view body;
+            std::size_t offset = 0;
+
+            static int seek(void *userdata, curl_off_t offset, int origin) {
+                auto *reader = static_cast<BodyReader *>(userdata);
+                if (origin != SEEK_SET || offset < 0 || static_cast<std::size_t>(offset) > reader->body.size()) {
+                    return CURL_SEEKFUNC_FAIL;
+                }
+                reader->offset = static_cast<std::size_t>(offset);
+                return CURL_SEEKFUNC_OK;
+            }
+        };
+
+    } // namespace
+
+    bool Network::HeaderLess::operator()(std::string_view a, std::string_view b) const {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](unsigned char x, unsigned char y) {
+            return std::tolower(x) < std::tolower(y);
+        });
+    }
+
+    void Network::parseOptions(const std::string &optionsJson, FetchOptions &options) {
+        if (optionsJson.empty()) {
+            return;
+        }
+
+        OptionsSaxHandler handler(options);
+        json::sax_parse(optionsJson, &handler);
+        assembleBody(options);
+    }
+
+    void Network::assembleBody(FetchOptions &options) {
+        if (options.attachments.empty()) {
+            return;
+        }
+
+        // Size the final body once and encode every attachment straight into it
+        std::size_t size = options.body.size();
+        for (const auto &slot : options.attachments) {
+            size += Attachments::encodedLength(*slot.attachment, slot.encoding);
+        }
+
+        std::pmr::string body(options.body.get_allocator());
+        body.resize_and_overwrite(size, [&](char *out, std::size_t) {
+            char *begin        = out;
+            std::size_t cursor = 0;
+            for (const auto &slot : options.attachments) {
+                out = std::copy(options.body.data() + cursor, options.body.data() + slot.offset, out);
+                out = Attachments::write(out, *slot.attachment, slot.encoding);
+                cursor = slot.offset;
+            }
+            out = std::copy(options.body.data() + cursor, options.body.data() + options.body.size(), out);
+            return static_cast<std::size_t>(out - begin);
+        });
+
+        Logger::getInstance().info("Network::assembleBody: {} attachment(s), body length: {}", options.attachments.size(), body.size());
+        options.body = std::move(body);
+        options.attachments.clear();
     }
 
     std::string Network::responseToJson(const FetchResponse &response) {
-        try {
-            json j;
-            j["status"]     = response.status;
-            j["statusText"] = response.statusText;
-            j["ok"]         = response.ok;
-            j["headers"]    = response.headers;
-            j["body"]       = response.body;
-
-            return j.dump();
-        } catch (const json::exception &e) {
-            Logger::getInstance().error("Network::responseToJson: JSON creation error: {}", e.what());
-            return "{}";
+        // Size the output once, then write every field straight into it
+        const std::string status = std::to_string(response.status);
+        const std::string_view ok = response.ok ? "true" : "false";
+
+        std::size_t size = std::string_view(R"({"status":,"statusText":"","ok":,"headers":{},"body":""})").size();
+        size += status.size() + ok.size();
+        size += JsonEscape::escapedLength(response.statusText);
+        size += JsonEscape::escapedLength(response.bodyView());
+        for (const auto &[key, value] : response.headers) {
+            // "key":"value",
+            size += JsonEscape::escapedLength(key) + JsonEscape::escapedLength(value) + 6;
+        }
+
+        std::string result(size, '\0');
+        char *out    = result.data();
+        auto literal = [&out](std::string_view text) {
+            for (char c : text) {
+                *out++ = c;
+            }
+        };
+
+        literal(R"({"status":)");
+        literal(status);
+        literal(R"(,"statusText":")");
+        out = JsonEscape::write(out, response.statusText);
+        literal(R"(","ok":)");
+        literal(ok);
+        literal(R"(,"headers":{)");
+        bool first = true;
+        for (const auto &[key, value] : response.headers) {
+            if (!first) {
+                literal(",");
+            }
+            first = false;
+            literal("\"");
+            out = JsonEscape::write(out, key);
+            literal("\":\"");
+            out = JsonEscape::write(out, value);
+            literal("\"");
         }
+        literal(R"(},"body":")");
+        out = JsonEscape::write(out, response.bodyView());
+        literal("\"}");
+
+        // The trailing comma of the last header was budgeted but never written
+        result.resize(static_cast<std::size_t>(out - result.data()));
+        return result;
     }
 
     std::string Network::getSystemProxy() {
@@ -115,96 +370,331 @@ namespace byoa {
 #endif
     }
 
-    std::string Network::fetchImpl(const std::string &url, const std::string &optionsJson) {
-        try {
-            Logger::getInstance().info("Network::fetchImpl: Fetching URL: {}", url);
+    void Network::request(const std::string &url, const FetchOptions &options, FetchResponse &response) {
+        if (Recording::isReplaying()) {
+            replay(url, options, response);
+            return;
+        }
 
-            FetchOptions options = parseOptions(optionsJson);
-            Logger::getInstance().info("Network::fetchImpl: Method: {}", options.method);
+        auto started = std::chrono::steady_clock::now();
 
-            // Build CPR session
-            cpr::Session session;
-            session.SetUrl(cpr::Url{url});
+        std::optional<Recording::Exchange> exchange;
+        if (Recording::isRecording()) {
+            exchange.emplace();
+            exchange->method = std::string(options.method);
+            exchange->url    = url;
+            exchange->requestHeaders.insert(options.headers.begin(), options.headers.end());
+            exchange->requestBody.assign(options.body);
+        }
 
+        std::string httpUrl    = url;
+        std::string socketPath = std::string(options.unixSocket);
+        if (url.starts_with(UNIX_SCHEME)) {
+            splitUnixURL(url, httpUrl, socketPath);
+        }
+
+        // Build CPR session
+        cpr::Session session;
+        session.SetUrl(cpr::Url{httpUrl});
+
+        std::string proxyUrl;
+        if (!socketPath.empty()) {
+            // Local servers: skip the TCP loopback path and proxy lookup altogether
+            Logger::getInstance().info("Network::request: Using unix socket: {}", socketPath);
+            session.SetUnixSocket(cpr::UnixSocket{socketPath});
+        } else {
             // Set system proxy if available
-            std::string proxyUrl = getSystemProxy();
+            proxyUrl = getSystemProxy();
             if (!proxyUrl.empty()) {
-                Logger::getInstance().info("Network::fetchImpl: Using system proxy: {}", proxyUrl);
+                Logger::getInstance().info("Network::request: Using system proxy: {}", proxyUrl);
                 session.SetProxies(cpr::Proxies{{"http", proxyUrl}, {"https", proxyUrl}});
             }
+        }
 
-            // Set headers
-            cpr::Header headers;
-            for (const auto &[key, value] : options.headers) {
-                headers[key] = value;
-                Logger::getInstance().info("Network::fetchImpl: Header: {} = {}", key, value);
-            }
-            if (!headers.empty()) {
-                session.SetHeader(headers);
-            }
-
-            // Set timeout (30 seconds default)
-            session.SetTimeout(cpr::Timeout{30000});
-
-            // Set body if present
-            if (!options.body.empty()) {
-                session.SetBody(cpr::Body{options.body});
-                Logger::getInstance().info("Network::fetchImpl: Body length: {}", options.body.length());
-            }
-
-            // Make request based on method
-            cpr::Response r;
-            if (options.method == "GET") {
-                r = session.Get();
-            } else if (options.method == "POST") {
-                r = session.Post();
-            } else if (options.method == "PUT") {
-                r = session.Put();
-            } else if (options.method == "DELETE") {
-                r = session.Delete();
-            } else if (options.method == "PATCH") {
-                r = session.Patch();
-            } else if (options.method == "HEAD") {
-                r = session.Head();
-            } else if (options.method == "OPTIONS") {
-                r = session.Options();
+        // Shared TLS sessions and DNS entries, warm from the previous launch
+        CURL *handle = session.GetCurlHolder()->handle;
+        auto resolve = ConnectionCache::attach(handle, httpUrl);
+
+        // Set headers
+        cpr::Header headers;
+        for (const auto &[key, value] : options.headers) {
+            headers.emplace(std::string(key), std::string(value));
+            Logger::getInstance().info("Network::request: Header: {} = {}", key, value);
+        }
+        if (!headers.empty()) {
+            session.SetHeader(headers);
+        }
+
+        if (options.onData) {
+            // Less than 1 byte/s over the idle window aborts; a total timeout would cut off long generations
+            session.SetConnectTimeout(cpr::ConnectTimeout{CONNECT_TIMEOUT});
+            session.SetLowSpeed(cpr::LowSpeed{1, STREAM_IDLE_TIMEOUT});
+        } else {
+            session.SetTimeout(cpr::Timeout{REQUEST_TIMEOUT});
+        }
+
+        // Set body if present. POST/PUT stream it from our buffer instead of handing cpr a copy.
+        BodyReader reader{options.body};
+        if (!options.body.empty()) {
+            if (options.method == "POST" || options.method == "PUT") {
+                session.SetReadCallback(cpr::ReadCallback{static_cast<cpr::cpr_off_t>(options.body.size()),
+                                                          [&reader](char *buffer, size_t &size, intptr_t) {
+                                                              size = std::min(size, reader.body.size() - reader.offset);
+                                                              std::memcpy(buffer, reader.body.data() + reader.offset, size);
+                                                              reader.offset += size;
+                                                              return true;
+                                                          }});
+                // Without this curl can't rewind the body to resend it after a redirect or on a reused connection
+                curl_easy_setopt(handle, CURLOPT_SEEKFUNCTION, &BodyReader::seek);
+                curl_easy_setopt(handle, CURLOPT_SEEKDATA, &reader);
             } else {
-                Logger::getInstance().error("Network::fetchImpl: Unsupported HTTP method: {}", options.method);
-                FetchResponse errorResponse;
-                errorResponse.status     = 400;
-                errorResponse.statusText = "Bad Request";
-                errorResponse.body       = "Unsupported HTTP method: " + options.method;
-                errorResponse.ok         = false;
-                return responseToJson(errorResponse);
+                session.SetBody(cpr::Body{std::string(options.body)});
+            }
+            Logger::getInstance().info("Network::request: Body length: {}", options.body.length());
+        }
+
+        // Parse headers ourselves so they land in the response's allocator instead of cpr::Header
+        session.SetHeaderCallback(cpr::HeaderCallback{[&](std::string_view line, intptr_t) {
+            line = trim(line);
+            if (line.empty() && exchange) {
+                // End of a header block
+                exchange->headersMicros = elapsedMicros(started);
+            }
+            if (line.starts_with("HTTP/")) {
+                // A new status line (redirect, 100-continue) starts a fresh header block
+                response.statusText.assign(line);
+                response.headers.clear();
+                // Known before the body arrives, so onData consumers can tell errors from content
+                auto code = line.find(' ');
+                if (code != std::string_view::npos) {
+                    std::from_chars(line.data() + code + 1, line.data() + line.size(), response.status);
+                }
+                return true;
             }
 
-            // Build response
-            FetchResponse response;
-            response.status     = static_cast<int>(r.status_code);
-            response.statusText = r.status_line;
-            response.body       = r.text;
-            response.ok         = (r.status_code >= 200 && r.status_code < 300);
+            auto colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                return true;
+            }
 
-            // Copy response headers
-            for (const auto &[key, value] : r.header) {
-                response.headers[key] = value;
+            std::string_view key   = trim(line.substr(0, colon));
+            std::string_view value = trim(line.substr(colon + 1));
+            // A HEAD response announces the length of a body it doesn't send
+            if (equalsIgnoreCase(key, "content-length") && options.method != "HEAD") {
+                std::size_t length = 0;
+                std::from_chars(value.data(), value.data() + value.size(), length);
+                if (length > options.maxBodySize) {
+                    // Refuse before downloading anything
+                    response.tooLarge = true;
+                    return false;
+                }
+                if (length <= options.memoryLimit) {
+                    response.body.reserve(length);
+                }
             }
 
-            Logger::getInstance().info("Network::fetchImpl: Response status: {}", response.status);
-            Logger::getInstance().info("Network::fetchImpl: Response body length: {}", response.body.length());
+            response.headers[std::pmr::string(key, response.headers.get_allocator())].assign(value);
+            return true;
+        }});
+
+        // Stream the body into the response buffer, or into a spill file once it outgrows the memory limit
+        session.SetWriteCallback(cpr::WriteCallback{[&](std::string_view data, intptr_t) {
+            if (exchange) {
+                exchange->chunks.push_back({elapsedMicros(started), data.size()});
+            }
+            return appendBody(options, response, data);
+        }});
+
+        // Make request based on method
+        cpr::Response r;
+        if (options.method == "GET") {
+            r = session.Get();
+        } else if (options.method == "POST") {
+            r = session.Post();
+        } else if (options.method == "PUT") {
+            r = session.Put();
+        } else if (options.method == "DELETE") {
+            r = session.Delete();
+        } else if (options.method == "PATCH") {
+            r = session.Patch();
+        } else if (options.method == "HEAD") {
+            r = session.Head();
+        } else if (options.method == "OPTIONS") {
+            r = session.Options();
+        } else {
+            Logger::getInstance().error("Network::request: Unsupported HTTP method: {}", options.method);
+            response.status = 400;
+            response.statusText.assign("Bad Request");
+            response.body.assign("Unsupported HTTP method: ");
+            response.body.append(options.method);
+            response.ok = false;
+            return;
+        }
+
+        response.status = static_cast<int>(r.status_code);
+        response.ok     = (r.status_code >= 200 && r.status_code < 300);
+
+        finishBody(options, response);
+
+        // Timeouts, dropped connections and onData aborts keep the status line of a truncated response
+        if (r.error && !response.tooLarge) {
+            Logger::getInstance().error("Network::request: Transfer failed: {}", r.error.message);
+            response.ok = false;
+            response.spill.reset();
+            response.statusText.assign("Network Error");
+            response.body.assign("Network error: ");
+            response.body.append(r.error.message);
+        }
+
+        if (exchange) {
+            exchange->status     = response.status;
+            exchange->statusText = std::string(response.statusText);
+            exchange->responseHeaders.insert(response.headers.begin(), response.headers.end());
+            exchange->responseBody.assign(response.bodyView());
+            Recording::record(std::move(*exchange));
+        }
+
+        if (socketPath.empty() && proxyUrl.empty()) {
+            ConnectionCache::record(handle, httpUrl);
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+        Logger::getInstance().info("Network::request: Response status: {}", response.status);
+        Logger::getInstance().info("Network::request: Response body length: {}", response.bodyView().length());
+        Logger::getInstance().info("Network::request: {} round trip: {} us", socketPath.empty() ? "tcp" : "unix", elapsed.count());
+    }
 
-            return responseToJson(response);
+    void Network::splitUnixURL(const std::string &url, std::string &httpUrl, std::string &socketPath) {
+        // unix:<socket path>[:<http path>]; the host is irrelevant once connected
+        std::string_view rest = std::string_view(url).substr(UNIX_SCHEME.size());
+        std::string_view path = "/";
+
+        auto separator = rest.find(":/");
+        if (separator != std::string_view::npos) {
+            path = rest.substr(separator + 1);
+            rest = rest.substr(0, separator);
+        }
+
+        socketPath.assign(rest);
+        httpUrl = "http://localhost";
+        httpUrl.append(path);
+    }
+
+    bool Network::appendBody(const FetchOptions &options, FetchResponse &response, std::string_view data) {
+        if (options.onData && !options.onData(data)) {
+            return false;
+        }
+
+        std::size_t received = (response.spill ? response.spill->size() : response.body.size()) + data.size();
+        if (received > options.maxBodySize) {
+            response.tooLarge = true;
+            return false;
+        }
+
+        if (!response.spill && received > options.memoryLimit) {
+            response.spill = SpillFile::create();
+            if (!response.spill || !response.spill->append(response.body)) {
+                return false;
+            }
+            Logger::getInstance().info("Network::appendBody: Body exceeds {} bytes, spilling to disk", options.memoryLimit);
+            response.body.clear();
+        }
+
+        if (response.spill) {
+            return response.spill->append(data);
+        }
+        response.body.append(data);
+        return true;
+    }
+
+    void Network::finishBody(const FetchOptions &options, FetchResponse &response) {
+        if (response.tooLarge) {
+            Logger::getInstance().error("Network::finishBody: Response exceeded {} bytes, transfer aborted", options.maxBodySize);
+            response.ok = false;
+            response.spill.reset();
+            response.statusText.assign("Response Too Large");
+            response.body.assign("Response body exceeded the maximum of ");
+            response.body.append(std::to_string(options.maxBodySize));
+            response.body.append(" bytes");
+        } else if (response.spill && !response.spill->finish()) {
+            response.ok = false;
+            response.spill.reset();
+            response.statusText.assign("Spill Failed");
+            response.body.assign("Failed to read back the spilled response body");
+        }
+    }
+
+    void Network::replay(const std::string &url, const FetchOptions &options, FetchResponse &response) {
+        auto exchange = Recording::nextReplay(std::string(options.method), url);
+        if (!exchange) {
+            Logger::getInstance().error("Network::replay: No recorded exchange for {} {}", options.method, url);
+            response.status = 502;
+            response.statusText.assign("No Recorded Exchange");
+            response.body.assign("No recorded exchange for ");
+            response.body.append(Recording::redactURL(url));
+            return;
+        }
+
+        // Reproduce the recorded timing relative to the start of the request
+        auto started = std::chrono::steady_clock::now();
+        std::this_thread::sleep_until(started + std::chrono::microseconds(exchange->headersMicros));
+        response.status = exchange->status;
+        response.ok     = (exchange->status >= 200 && exchange->status < 300);
+        response.statusText.assign(exchange->statusText);
+        for (const auto &[key, value] : exchange->responseHeaders) {
+            response.headers[std::pmr::string(key, response.headers.get_allocator())].assign(value);
+        }
+
+        std::string_view body = exchange->responseBody;
+        std::size_t offset    = 0;
+        for (const auto &chunk : exchange->chunks) {
+            std::this_thread::sleep_until(started + std::chrono::microseconds(chunk.offsetMicros));
+            std::size_t size = std::min(chunk.size, body.size() - offset);
+            if (!appendBody(options, response, body.substr(offset, size))) {
+                break;
+            }
+            offset += size;
+        }
+
+        finishBody(options, response);
+    }
+
+    std::string Network::fetchImpl(const std::string &url, const std::string &optionsJson) {
+        // Everything below, apart from the returned JSON, lives on this arena and is freed in one go
+        RequestArena arena;
+        allocator_type alloc{arena.resource()};
+
+        std::string result;
+        try {
+            Logger::getInstance().info("Network::fetchImpl: Fetching URL: {}", url);
+
+            FetchOptions options{alloc};
+            parseOptions(optionsJson, options);
+            // Inlining a spilled body would bring it back into memory several times over
+            options.memoryLimit = std::min(options.memoryLimit, MAX_FETCH_BODY_SIZE);
+            options.maxBodySize = std::min(options.maxBodySize, options.memoryLimit);
+            Logger::getInstance().info("Network::fetchImpl: Method: {}", options.method);
+
+            FetchResponse response{alloc};
+            request(url, options, response);
+            result = responseToJson(response);
         } catch (const std::exception &e) {
             Logger::getInstance().error("Network::fetchImpl: Exception: {}", e.what());
 
-            FetchResponse errorResponse;
-            errorResponse.status     = 0;
-            errorResponse.statusText = "Network Error";
-            errorResponse.body       = std::string("Network error: ") + e.what();
-            errorResponse.ok         = false;
+            FetchResponse errorResponse{alloc};
+            errorResponse.status = 0;
+            errorResponse.statusText.assign("Network Error");
+            errorResponse.body.assign("Network error: ");
+            errorResponse.body.append(e.what());
+            errorResponse.ok = false;
 
-            return responseToJson(errorResponse);
+            result = responseToJson(errorResponse);
         }
+
+        auto stats = arena.stats();
+        Logger::getInstance().info("Network::fetchImpl: Arena upstream allocations: {}, bytes: {}", stats.upstreamAllocations,
+                                   stats.upstreamBytes);
+        return result;
     }
 
     coco::future<std::string> Network::fetchAsync(const std::string &url, const std::string &options) {
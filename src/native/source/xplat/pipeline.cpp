@@ -0,0 +1,306 @@
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+#include "incremental.hpp"
+#include "logger.hpp"
+#include "pipeline.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        constexpr std::string_view WHITESPACE = " \t\r\n";
+
+        // Finished stage outputs, oldest entries evicted first
+        struct Cache {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::string> entries;
+            std::deque<std::string> order;
+        };
+
+        Cache &cache() {
+            static Cache instance;
+            return instance;
+        }
+
+        bool isBlank(std::string_view text) {
+            return text.find_first_not_of(WHITESPACE) == std::string_view::npos;
+        }
+
+        /**
+         * @brief Text flowing from one stage into the next
+         */
+        class Channel {
+          public:
+            void push(std::string_view text) {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _buffer.append(text);
+                }
+                _cv.notify_all();
+            }
+
+            void close(bool ok) {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _closed = true;
+                    _ok     = ok;
+                }
+                _cv.notify_all();
+            }
+
+            /**
+             * @brief Wait for the complete sentences buffered so far, or for the whole input
+             *
+             * @return std::nullopt once the channel is closed and drained, or failed upstream
+             */
+            std::optional<std::string> take(bool sentences) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                std::size_t length = 0;
+                _cv.wait(lock, [&]() {
+                    length = _closed ? _buffer.size() : sentences ? Pipeline::sentenceBoundary(_buffer) : 0;
+                    return _closed || length > 0;
+                });
+
+                if ((_closed && !_ok) || length == 0) {
+                    return std::nullopt;
+                }
+
+                std::string chunk = _buffer.substr(0, length);
+                _buffer.erase(0, length);
+                return chunk;
+            }
+
+            bool ok() {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _ok;
+            }
+
+          private:
+            std::mutex _mutex;
+            std::condition_variable _cv;
+            std::string _buffer;
+            bool _closed = false;
+            bool _ok     = true;
+        };
+
+        void runStage(const LLM::Config &config, const Pipeline::Stage &stage, std::size_t index, Channel &in, Channel &out,
+                      std::string &output, std::string &error, const Pipeline::ProgressCallback &onProgress) {
+            auto emit = [&](std::string_view text) {
+                if (text.empty()) {
+                    return;
+                }
+                output.append(text);
+                out.push(text);
+                if (onProgress) {
+                    onProgress(index, std::string(text), false);
+                }
+            };
+
+            while (auto chunk = in.take(stage.streamable)) {
+                if (isBlank(*chunk)) {
+                    emit(*chunk);
+                    continue;
+                }
+
+                // Keep the whitespace around the chunk; whatever the model adds around its answer is dropped
+                std::string_view text = *chunk;
+                std::size_t begin     = text.find_first_not_of(WHITESPACE);
+                std::size_t end       = text.find_last_not_of(WHITESPACE) + 1;
+                emit(text.substr(0, begin));
+
+                std::string held;
+                bool started    = false;
+                std::string body(text.substr(begin, end - begin));
+                auto completion = LLM::stream(config, stage.prompt, body, [&](const std::string &delta) {
+                    std::string pending = held + delta;
+                    if (!started) {
+                        pending.erase(0, std::min(pending.find_first_not_of(WHITESPACE), pending.size()));
+                        started = !pending.empty();
+                    }
+                    // Trailing whitespace is held back until more content follows it
+                    std::size_t keep = pending.find_last_not_of(WHITESPACE) + 1;
+                    held             = pending.substr(keep);
+                    pending.resize(keep);
+                    emit(pending);
+                });
+
+                if (!completion.ok) {
+                    error = completion.error;
+                    out.close(false);
+                    return;
+                }
+                emit(text.substr(end));
+            }
+
+            if (!in.ok()) {
+                error = "Previous stage failed";
+                out.close(false);
+                return;
+            }
+
+            out.close(true);
+            if (onProgress) {
+                onProgress(index, "", true);
+            }
+        }
+
+    } // namespace
+
+    std::size_t Pipeline::sentenceBoundary(std::string_view text) {
+        std::size_t boundary = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            char c = text[i];
+            if (c == '\n') {
+                boundary = i + 1;
+                continue;
+            }
+            if (c != '.' && c != '!' && c != '?') {
+                continue;
+            }
+
+            // Closing quotes or brackets belong to the sentence
+            std::size_t end = i + 1;
+            while (end < text.size() && (text[end] == '"' || text[end] == '\'' || text[end] == ')' || text[end] == ']')) {
+                end++;
+            }
+            // Only whitespace proves the sentence ended ("3.14", "e.g." mid-token don't count)
+            if (end < text.size() && WHITESPACE.find(text[end]) != std::string_view::npos) {
+                while (end < text.size() && text[end] != '\n' && WHITESPACE.find(text[end]) != std::string_view::npos) {
+                    end++;
+                }
+                boundary = end;
+                i        = end - 1;
+            }
+        }
+        return boundary;
+    }
+
+    Pipeline::Result Pipeline::run(const LLM::Config &config, const std::vector<Stage> &stages, const std::string &input,
+                                   std::size_t fromStage, const ProgressCallback &onProgress) {
+        Result result;
+        std::size_t count = stages.size();
+        result.outputs.resize(count);
+
+        // A stage's output is identified by the model, the original input and every prompt up to that stage
+        std::vector<std::string> keys(count);
+        uint64_t chain = Incremental::fingerprint(input);
+        for (std::size_t i = 0; i < count; i++) {
+            chain   = Incremental::fingerprint(fmt::format("{:x}\x1f{}", chain, stages[i].prompt));
+            keys[i] = fmt::format("{}\x1f{}\x1f{:x}", config.id, config.modelName, chain);
+        }
+
+        std::size_t start = 0;
+        {
+            auto &c = cache();
+            std::lock_guard<std::mutex> lock(c.mutex);
+            for (; start < std::min(fromStage, count); start++) {
+                auto it = c.entries.find(keys[start]);
+                if (it == c.entries.end()) {
+                    break;
+                }
+                result.outputs[start] = it->second;
+            }
+        }
+        result.resumedFrom = start;
+
+        if (start == count) {
+            result.content = count > 0 ? result.outputs.back() : input;
+            result.ok      = true;
+            return result;
+        }
+
+        // channels[k] feeds stage start + k; the last one collects the final output
+        std::vector<Channel> channels(count - start + 1);
+        channels[0].push(start == 0 ? input : result.outputs[start - 1]);
+        channels[0].close(true);
+
+        std::vector<std::string> errors(count);
+        std::vector<std::thread> threads;
+        for (std::size_t i = start; i < count; i++) {
+            threads.emplace_back([&, i]() {
+                runStage(config, stages[i], i, channels[i - start], channels[i - start + 1], result.outputs[i], errors[i], onProgress);
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        {
+            auto &c = cache();
+            std::lock_guard<std::mutex> lock(c.mutex);
+            for (std::size_t i = start; i < count; i++) {
+                if (!errors[i].empty()) {
+                    // Later stages never saw a complete input; a retry resumes here
+                    result.error = errors[i];
+                    break;
+                }
+
+                auto [it, inserted] = c.entries.insert_or_assign(keys[i], result.outputs[i]);
+                if (inserted) {
+                    c.order.push_back(keys[i]);
+                    if (c.order.size() > MAX_CACHED_OUTPUTS) {
+                        c.entries.erase(c.order.front());
+                        c.order.pop_front();
+                    }
+                }
+            }
+        }
+
+        Logger::getInstance().info("Pipeline::run: {} stages, resumed from {}", count, start);
+        if (!result.error.empty()) {
+            return result;
+        }
+
+        result.content = result.outputs.back();
+        result.ok      = true;
+        return result;
+    }
+
+    coco::future<std::string> Pipeline::runAsync(const std::string &configJson, const std::string &stagesJson, const std::string &input,
+                                                 int fromStage, ProgressCallback onProgress) {
+        auto promise = coco::promise<std::string>{};
+        auto future  = promise.get_future();
+
+        std::thread thread{[promise = std::move(promise), configJson, stagesJson, input, fromStage,
+                            onProgress = std::move(onProgress)]() mutable {
+            Result result;
+            auto config = LLM::parseConfig(configJson);
+            std::vector<Stage> stages;
+            try {
+                for (const auto &entry : json::parse(stagesJson)) {
+                    stages.push_back({entry.value("id", ""), entry.value("prompt", ""), entry.value("streamable", false)});
+                }
+            } catch (const json::exception &e) {
+                Logger::getInstance().error("Pipeline::runAsync: JSON parse error: {}", e.what());
+                result.error = "Invalid pipeline definition";
+            }
+
+            if (!config) {
+                result.error = "Invalid LLM configuration";
+            } else if (result.error.empty()) {
+                result = run(*config, stages, input, fromStage < 0 ? stages.size() : static_cast<std::size_t>(fromStage), onProgress);
+            }
+
+            json j = {
+                {"ok", result.ok},
+                {"content", result.content},
+                {"error", result.error},
+                {"outputs", result.outputs},
+                {"resumedFrom", result.resumedFrom},
+            };
+            promise.set_value(j.dump(-1, ' ', false, json::error_handler_t::replace));
+        }};
+        thread.detach();
+
+        return future;
+    }
+
+} // namespace byoa
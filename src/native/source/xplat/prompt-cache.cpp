@@ -0,0 +1,128 @@
+#include <map>
+#include <mutex>
+
+#include "incremental.hpp"
+#include "logger.hpp"
+#include "prompt-cache.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        struct Stats {
+            uint64_t requests     = 0;
+            uint64_t hits         = 0;
+            uint64_t promptTokens = 0;
+            uint64_t cachedTokens = 0;
+            int64_t hitFirstByteMicros  = 0;
+            int64_t missFirstByteMicros = 0;
+        };
+
+        struct State {
+            std::mutex mutex;
+            std::map<std::string, Stats> stats;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        uint64_t tokensAt(const json &usage, const char *pointer) {
+            json::json_pointer path(pointer);
+            return usage.contains(path) && usage[path].is_number_unsigned() ? usage[path].get<uint64_t>() : 0;
+        }
+
+    } // namespace
+
+    PromptCache::Markers PromptCache::markersFor(const LLM::Config &config) {
+        if (config.promptCache == "off") {
+            return Markers::NONE;
+        }
+        if (config.promptCache == "anthropic") {
+            return Markers::ANTHROPIC;
+        }
+        if (config.promptCache == "openai") {
+            return Markers::OPENAI;
+        }
+
+        // Automatic prefix caching elsewhere needs no markers, only the stable layout
+        if (config.baseURL.find("anthropic.com") != std::string::npos || config.baseURL.find("openrouter.ai") != std::string::npos) {
+            return Markers::ANTHROPIC;
+        }
+        if (config.baseURL.find("api.openai.com") != std::string::npos) {
+            return Markers::OPENAI;
+        }
+        return Markers::NONE;
+    }
+
+    json PromptCache::requestBody(const LLM::Config &config, const std::string &systemContent, const std::string &userContent) {
+        json system = {{"role", "system"}, {"content", systemContent}};
+        json body   = {{"model", config.modelName}};
+
+        switch (markersFor(config)) {
+        case Markers::ANTHROPIC:
+            // Cache breakpoint right after the part that never changes for this action
+            system["content"] = json::array({{{"type", "text"}, {"text", systemContent}, {"cache_control", {{"type", "ephemeral"}}}}});
+            break;
+        case Markers::OPENAI:
+            body["prompt_cache_key"] = fmt::format("byoa-{:x}", Incremental::fingerprint(config.modelName + '\x1f' + systemContent));
+            break;
+        case Markers::NONE:
+            break;
+        }
+
+        body["messages"] = json::array({std::move(system), {{"role", "user"}, {"content", userContent}}});
+        return body;
+    }
+
+    uint64_t PromptCache::observe(const std::string &configId, const json &usage, int64_t firstByteMicros) {
+        if (!usage.is_object()) {
+            return 0;
+        }
+
+        // OpenAI, Anthropic and DeepSeek each report cache reads under their own name
+        uint64_t cached = tokensAt(usage, "/prompt_tokens_details/cached_tokens") + tokensAt(usage, "/cache_read_input_tokens") +
+                          tokensAt(usage, "/prompt_cache_hit_tokens");
+        uint64_t prompt = tokensAt(usage, "/prompt_tokens");
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto &stats = s.stats[configId];
+        stats.requests++;
+        stats.promptTokens += prompt;
+        stats.cachedTokens += cached;
+        if (cached > 0) {
+            stats.hits++;
+            stats.hitFirstByteMicros += firstByteMicros;
+        } else {
+            stats.missFirstByteMicros += firstByteMicros;
+        }
+
+        Logger::getInstance().info("PromptCache::observe: {} of {} prompt tokens cached, first byte after {} us", cached, prompt,
+                                   firstByteMicros);
+        return cached;
+    }
+
+    std::string PromptCache::statsJson() {
+        json result = json::object();
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto &[configId, stats] : s.stats) {
+            auto misses     = stats.requests - stats.hits;
+            result[configId] = {
+                {"requests", stats.requests},
+                {"hits", stats.hits},
+                {"promptTokens", stats.promptTokens},
+                {"cachedTokens", stats.cachedTokens},
+                {"hitFirstByteMs", stats.hits ? stats.hitFirstByteMicros / 1000.0 / stats.hits : 0.0},
+                {"missFirstByteMs", misses ? stats.missFirstByteMicros / 1000.0 / misses : 0.0},
+            };
+        }
+        return result.dump();
+    }
+
+} // namespace byoa
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <unordered_map>
+
+#include "logger.hpp"
+#include "recording.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        constexpr const char *REDACTED = "<redacted>";
+
+        struct State {
+            std::mutex mutex;
+            std::atomic<bool> recording{false};
+            std::atomic<bool> replaying{false};
+            std::ofstream output;
+
+            // "METHOD url" -> recorded exchanges and the index of the next one to serve
+            std::unordered_map<std::string, std::pair<std::vector<Recording::Exchange>, std::size_t>> replays;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        std::string lowercase(std::string_view text) {
+            std::string result(text);
+            std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+            return result;
+        }
+
+        bool isSecretHeader(const std::string &name) {
+            static const std::vector<std::string> secrets = {"authorization", "proxy-authorization", "x-api-key", "api-key",
+                                                             "x-goog-api-key", "cookie", "set-cookie"};
+            return std::find(secrets.begin(), secrets.end(), lowercase(name)) != secrets.end();
+        }
+
+        bool isSecretField(const std::string &name) {
+            std::string lower = lowercase(name);
+            for (const char *word : {"key", "token", "secret", "password"}) {
+                if (lower.find(word) != std::string::npos) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void redactJson(json &value) {
+            if (value.is_object()) {
+                for (auto &[name, field] : value.items()) {
+                    if (field.is_string() && isSecretField(name)) {
+                        field = REDACTED;
+                    } else {
+                        redactJson(field);
+                    }
+                }
+            } else if (value.is_array()) {
+                for (auto &element : value) {
+                    redactJson(element);
+                }
+            }
+        }
+
+        std::string replayKey(const std::string &method, const std::string &url) {
+            return method + " " + Recording::redactURL(url);
+        }
+
+    } // namespace
+
+    void Recording::configureFromEnvironment() {
+        if (const char *file = std::getenv("BYOA_REPLAY_FILE"); file && *file) {
+            startReplay(file);
+        } else if (const char *file = std::getenv("BYOA_RECORD_FILE"); file && *file) {
+            startRecording(file);
+        }
+    }
+
+    bool Recording::startRecording(const std::filesystem::path &file) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.output = std::ofstream(file, std::ios::app);
+        if (!s.output) {
+            Logger::getInstance().error("Recording::startRecording: Failed to open {}", file.string());
+            return false;
+        }
+        s.recording = true;
+        Logger::getInstance().info("Recording::startRecording: Recording network exchanges to {}", file.string());
+        return true;
+    }
+
+    void Recording::stopRecording() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.recording = false;
+        s.output.close();
+    }
+
+    bool Recording::isRecording() {
+        return state().recording;
+    }
+
+    void Recording::record(Exchange exchange) {
+        redact(exchange);
+
+        json chunks = json::array();
+        for (const auto &chunk : exchange.chunks) {
+            chunks.push_back({chunk.offsetMicros, chunk.size});
+        }
+
+        json line = {
+            {"method", exchange.method},
+            {"url", exchange.url},
+            {"requestHeaders", exchange.requestHeaders},
+            {"requestBody", exchange.requestBody},
+            {"status", exchange.status},
+            {"statusText", exchange.statusText},
+            {"responseHeaders", exchange.responseHeaders},
+            {"headersMicros", exchange.headersMicros},
+            {"chunks", chunks},
+            {"body", exchange.responseBody},
+        };
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.recording) {
+            s.output << line.dump(-1, ' ', false, json::error_handler_t::replace) << '\n';
+            s.output.flush();
+        }
+    }
+
+    bool Recording::startReplay(const std::filesystem::path &file) {
+        std::ifstream input(file);
+        if (!input) {
+            Logger::getInstance().error("Recording::startReplay: Failed to open {}", file.string());
+            return false;
+        }
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.replays.clear();
+
+        std::size_t count = 0;
+        std::string text;
+        while (std::getline(input, text)) {
+            if (text.empty()) {
+                continue;
+            }
+
+            try {
+                json line = json::parse(text);
+
+                Exchange exchange;
+                exchange.method          = line.value("method", "GET");
+                exchange.url             = line.value("url", "");
+                exchange.requestHeaders  = line.value("requestHeaders", HeaderList{});
+                exchange.requestBody     = line.value("requestBody", "");
+                exchange.status          = line.value("status", 0);
+                exchange.statusText      = line.value("statusText", "");
+                exchange.responseHeaders = line.value("responseHeaders", HeaderList{});
+                exchange.headersMicros   = line.value("headersMicros", int64_t{0});
+                exchange.responseBody    = line.value("body", "");
+                for (const auto &chunk : line.value("chunks", json::array())) {
+                    exchange.chunks.push_back({chunk.at(0).get<int64_t>(), chunk.at(1).get<std::size_t>()});
+                }
+
+                s.replays[replayKey(exchange.method, exchange.url)].first.push_back(std::move(exchange));
+                count++;
+            } catch (const json::exception &e) {
+                Logger::getInstance().error("Recording::startReplay: Skipping malformed line: {}", e.what());
+            }
+        }
+
+        s.replaying = true;
+        Logger::getInstance().info("Recording::startReplay: Replaying {} exchanges from {}", count, file.string());
+        return true;
+    }
+
+    bool Recording::isReplaying() {
+        return state().replaying;
+    }
+
+    std::optional<Recording::Exchange> Recording::nextReplay(const std::string &method, const std::string &url) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.replays.find(replayKey(method, url));
+        if (it == s.replays.end() || it->second.first.empty()) {
+            return std::nullopt;
+        }
+
+        auto &[exchanges, next] = it->second;
+        Exchange exchange       = exchanges[next];
+        next                    = (next + 1) % exchanges.size();
+        return exchange;
+    }
+
+    std::string Recording::redactURL(const std::string &url) {
+        auto query = url.find('?');
+        if (query == std::string::npos) {
+            return url;
+        }
+
+        std::string result = url.substr(0, query + 1);
+        std::size_t start  = query + 1;
+        while (start <= url.size()) {
+            std::size_t end = std::min(url.find('&', start), url.size());
+            std::string_view param(url.data() + start, end - start);
+            std::size_t equals = param.find('=');
+
+            if (equals != std::string_view::npos && isSecretField(std::string(param.substr(0, equals)))) {
+                result.append(param.substr(0, equals + 1));
+                result.append(REDACTED);
+            } else {
+                result.append(param);
+            }
+            if (end < url.size()) {
+                result.push_back('&');
+            }
+            start = end + 1;
+        }
+        return result;
+    }
+
+    void Recording::redact(Exchange &exchange) {
+        exchange.url = redactURL(exchange.url);
+        for (auto *headers : {&exchange.requestHeaders, &exchange.responseHeaders}) {
+            for (auto &[name, value] : *headers) {
+                if (isSecretHeader(name)) {
+                    value = REDACTED;
+                }
+            }
+        }
+
+        json body = json::parse(exchange.requestBody, nullptr, false);
+        if (!body.is_discarded() && body.is_structured()) {
+            redactJson(body);
+            exchange.requestBody = body.dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+    }
+
+} // namespace byoa
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <unordered_map>
+
+#include "logger.hpp"
+#include "router.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        struct History {
+            double ttfbMs       = 0;
+            double tokensPerSec = 0;
+            uint64_t samples    = 0;
+        };
+
+        struct State {
+            std::mutex mutex;
+            std::unordered_map<std::string, History> history;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        double ewma(double current, double sample, double alpha) {
+            return current == 0 ? sample : alpha * sample + (1 - alpha) * current;
+        }
+
+    } // namespace
+
+    std::size_t Router::estimateTokens(std::string_view text) {
+        return (text.size() + 3) / 4;
+    }
+
+    void Router::observe(const std::string &configId, const LLM::Completion &completion, bool streamed) {
+        double totalMs = completion.totalMicros / 1000.0;
+        double ttfbMs  = completion.firstByteMicros / 1000.0;
+        auto tokens    = completion.outputTokens ? completion.outputTokens : estimateTokens(completion.content);
+        if (configId.empty() || totalMs <= 0 || tokens == 0) {
+            return;
+        }
+
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto &history = s.history[configId];
+        if (streamed) {
+            history.ttfbMs = ewma(history.ttfbMs, ttfbMs, EWMA_ALPHA);
+        }
+        // Without a stream, the first byte is the whole answer: subtract the known TTFB if there is one
+        double generationMs   = streamed ? totalMs - ttfbMs : totalMs - std::min(history.ttfbMs, totalMs / 2);
+        history.tokensPerSec  = ewma(history.tokensPerSec, tokens * 1000.0 / std::max(generationMs, 1.0), EWMA_ALPHA);
+        history.samples++;
+    }
+
+    Router::Route Router::route(const std::vector<LLM::Config> &configs, const Policy &policy, std::string_view input) {
+        Route route;
+        route.inputTokens   = estimateTokens(input);
+        auto expectedOutput = std::max(route.inputTokens, MIN_OUTPUT_TOKENS);
+
+        std::vector<const LLM::Config *> candidates;
+        if (policy.models.empty()) {
+            for (const auto &config : configs) {
+                candidates.push_back(&config);
+            }
+        } else {
+            for (const auto &id : policy.models) {
+                auto it = std::find_if(configs.begin(), configs.end(), [&](const LLM::Config &c) { return c.id == id; });
+                if (it != configs.end()) {
+                    candidates.push_back(&*it);
+                }
+            }
+        }
+        if (candidates.empty()) {
+            route.reason = "No enabled model matches the routing policy";
+            return route;
+        }
+
+        {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            for (const auto *config : candidates) {
+                Prediction prediction;
+                prediction.configId = config->id;
+                prediction.fits     = config->contextTokens == 0 || route.inputTokens + expectedOutput <= config->contextTokens;
+
+                auto it             = s.history.find(config->id);
+                prediction.observed = it != s.history.end() && it->second.samples > 0;
+                double ttfbMs       = prediction.observed && it->second.ttfbMs > 0 ? it->second.ttfbMs : PRIOR_TTFB_MS;
+                double tokensPerSec = prediction.observed ? it->second.tokensPerSec : PRIOR_TOKENS_PER_SEC;
+                prediction.latencyMs = ttfbMs + expectedOutput * 1000.0 / tokensPerSec;
+                route.predictions.push_back(prediction);
+            }
+        }
+
+        auto nameOf = [&](const std::string &id) {
+            auto it = std::find_if(configs.begin(), configs.end(), [&](const LLM::Config &c) { return c.id == id; });
+            return it->name.empty() ? id : it->name;
+        };
+
+        std::vector<const Prediction *> fitting;
+        for (const auto &prediction : route.predictions) {
+            if (prediction.fits) {
+                fitting.push_back(&prediction);
+            }
+        }
+
+        std::string why;
+        const Prediction *chosen = nullptr;
+        if (fitting.empty()) {
+            // Nothing is known to fit: try the largest context window and let the provider decide
+            chosen = &*std::max_element(route.predictions.begin(), route.predictions.end(), [&](const Prediction &a, const Prediction &b) {
+                return candidates[&a - route.predictions.data()]->contextTokens < candidates[&b - route.predictions.data()]->contextTokens;
+            });
+            why    = "no model's context window fits the input, using the largest";
+        } else {
+            auto fastest = *std::min_element(fitting.begin(), fitting.end(),
+                                             [](const Prediction *a, const Prediction *b) { return a->latencyMs < b->latencyMs; });
+            if (policy.latencyTargetMs > 0) {
+                auto meets = std::find_if(fitting.begin(), fitting.end(),
+                                          [&](const Prediction *p) { return p->latencyMs <= policy.latencyTargetMs; });
+                chosen     = meets != fitting.end() ? *meets : fastest;
+                why        = meets != fitting.end() ? "first preferred model within the {:.0f} ms target"
+                                                    : "no model meets the {:.0f} ms target, using the fastest";
+                why        = fmt::format(fmt::runtime(why), policy.latencyTargetMs);
+            } else {
+                chosen = fastest;
+                why    = "fastest predicted model";
+            }
+        }
+
+        // Fallbacks: everything else that fits, fastest first
+        route.chain.push_back(chosen->configId);
+        std::vector<const Prediction *> rest;
+        for (const auto *prediction : fitting) {
+            if (prediction != chosen) {
+                rest.push_back(prediction);
+            }
+        }
+        std::sort(rest.begin(), rest.end(), [](const Prediction *a, const Prediction *b) { return a->latencyMs < b->latencyMs; });
+        for (const auto *prediction : rest) {
+            route.chain.push_back(prediction->configId);
+        }
+
+        route.reason = fmt::format("~{} input tokens: {} ({}), predicted {:.0f} ms{}", route.inputTokens, nameOf(chosen->configId), why,
+                                   chosen->latencyMs, chosen->observed ? "" : " from defaults, no history yet");
+        for (const auto &prediction : route.predictions) {
+            if (&prediction == chosen) {
+                continue;
+            }
+            route.reason += fmt::format("; {} {}", nameOf(prediction.configId),
+                                        prediction.fits ? fmt::format("predicted {:.0f} ms", prediction.latencyMs) : "context too small");
+        }
+        return route;
+    }
+
+    coco::future<std::string> Router::invokeAsync(const std::string &configsJson, const std::string &policyJson,
+                                                  const std::string &systemContent, const std::string &userContent) {
+        auto promise = coco::promise<std::string>{};
+        auto future  = promise.get_future();
+
+        std::thread thread{[promise = std::move(promise), configsJson, policyJson, systemContent, userContent]() mutable {
+            json result = {{"ok", false}, {"content", ""}, {"error", ""}, {"configId", ""}, {"reason", ""}, {"attempts", json::array()}};
+            try {
+                std::vector<LLM::Config> configs;
+                for (const auto &item : json::parse(configsJson)) {
+                    if (auto config = LLM::parseConfig(item.dump())) {
+                        configs.push_back(std::move(*config));
+                    }
+                }
+
+                Policy policy;
+                json p                 = json::parse(policyJson.empty() ? "{}" : policyJson);
+                policy.models          = p.value("models", std::vector<std::string>{});
+                policy.latencyTargetMs = p.value("latencyTargetMs", 0.0);
+
+                auto route       = Router::route(configs, policy, userContent);
+                result["reason"] = route.reason;
+                Logger::getInstance().info("Router::invokeAsync: {}", route.reason);
+
+                for (const auto &id : route.chain) {
+                    const auto &config = *std::find_if(configs.begin(), configs.end(), [&](const LLM::Config &c) { return c.id == id; });
+                    auto completion    = LLM::complete(config, systemContent, userContent);
+                    result["attempts"].push_back({{"configId", id}, {"ok", completion.ok}, {"error", completion.error}});
+                    if (completion.ok) {
+                        result["ok"]       = true;
+                        result["content"]  = completion.content;
+                        result["configId"] = id;
+                        break;
+                    }
+                    Logger::getInstance().warn("Router::invokeAsync: {} failed, falling back: {}", id, completion.error);
+                    result["error"] = completion.error;
+                }
+                if (route.chain.empty()) {
+                    result["error"] = route.reason;
+                }
+            } catch (const json::exception &e) {
+                Logger::getInstance().error("Router::invokeAsync: JSON parse error: {}", e.what());
+                result["error"] = e.what();
+            }
+            promise.set_value(result.dump(-1, ' ', false, json::error_handler_t::replace));
+        }};
+        thread.detach();
+
+        return future;
+    }
+
+} // namespace byoa
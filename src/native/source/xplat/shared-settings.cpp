@@ -0,0 +1,235 @@
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <vector>
+
+#include "config-store.hpp"
+#include "logger.hpp"
+#include "shared-settings.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    struct SharedSettings::State {
+        std::mutex mutex;
+        bool loaded               = false;
+        json document             = json::object();
+        uint64_t version          = 0;
+        uint64_t nextSubscription = 1;
+        std::map<uint64_t, Listener> listeners;
+
+        // Callers hold the mutex
+        void loadLocked() {
+            if (loaded) {
+                return;
+            }
+            loaded = true;
+            for (const auto &[key, value] : ConfigStore::snapshot()) {
+                if (!value) {
+                    continue;
+                }
+                json parsed = json::parse(*value, nullptr, false);
+                if (!parsed.is_discarded()) {
+                    document[key] = std::move(parsed);
+                }
+            }
+            // Versions only need to grow within a run; starting at the store revision keeps them readable in logs
+            version = ConfigStore::revision();
+        }
+
+        /**
+         * Apply @p patch, persist the keys it touches and return the delta for listeners,
+         * or an empty string if the patch is invalid. Callers hold the mutex.
+         */
+        std::string commitLocked(const json &patch) {
+            // Settings persist per top-level key, so an op on the whole document has nothing to write
+            for (const auto &op : patch) {
+                for (const char *field : {"path", "from"}) {
+                    if (op.is_object() && op.contains(field) && op[field] == "") {
+                        Logger::getInstance().error("SharedSettings::commit: Rejected patch: {} of the root", field);
+                        return "";
+                    }
+                }
+            }
+
+            json updated;
+            try {
+                updated = document.patch(patch);
+            } catch (const json::exception &e) {
+                Logger::getInstance().error("SharedSettings::commit: Rejected patch: {}", e.what());
+                return "";
+            }
+
+            std::set<std::string> touched;
+            for (const auto &op : patch) {
+                for (const char *field : {"path", "from"}) {
+                    if (op.contains(field) && op[field].is_string()) {
+                        json::json_pointer pointer(op[field].get<std::string>());
+                        // The parent chain ends at the top-level key
+                        while (!pointer.empty() && !pointer.parent_pointer().empty()) {
+                            pointer = pointer.parent_pointer();
+                        }
+                        if (!pointer.empty()) {
+                            touched.insert(pointer.back());
+                        }
+                    }
+                }
+            }
+
+            std::map<std::string, std::string> values;
+            for (const auto &key : touched) {
+                if (!updated.contains(key)) {
+                    if (!ConfigStore::remove(key)) {
+                        Logger::getInstance().error("SharedSettings::commit: Failed to remove {}, keeping version {}", key, version);
+                        return "";
+                    }
+                } else {
+                    values[key] = updated[key].dump(-1, ' ', false, json::error_handler_t::replace);
+                }
+            }
+            if (!values.empty() && !ConfigStore::setMany(values)) {
+                Logger::getInstance().error("SharedSettings::commit: Failed to persist, keeping version {}", version);
+                return "";
+            }
+
+            document = std::move(updated);
+            version++;
+            return json{{"version", version}, {"patch", patch}}.dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+    };
+
+    SharedSettings::State &SharedSettings::state() {
+        static State instance;
+        return instance;
+    }
+
+    namespace {
+
+        // JSON pointer to top-level @p key
+        std::string pointerTo(const std::string &key) {
+            std::string pointer = "/";
+            for (char c : key) {
+                pointer += c == '~' ? "~0" : c == '/' ? "~1" : std::string(1, c);
+            }
+            return pointer;
+        }
+
+        void broadcast(const std::vector<SharedSettings::Listener> &listeners, const std::string &delta) {
+            for (const auto &listener : listeners) {
+                listener(delta);
+            }
+        }
+
+    } // namespace
+
+    std::string SharedSettings::snapshotJson() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.loadLocked();
+        return json{{"version", s.version}, {"state", s.document}}.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+
+    std::string SharedSettings::applyJson(const std::string &patchJson, uint64_t baseVersion, uint64_t origin) {
+        json patch = json::parse(patchJson, nullptr, false);
+        if (!patch.is_array()) {
+            return R"({"ok":false,"error":"patch must be an array"})";
+        }
+
+        std::string delta;
+        std::vector<Listener> listeners;
+        uint64_t version;
+        {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.loadLocked();
+            if (baseVersion != s.version) {
+                return json{{"ok", false}, {"conflict", true}, {"version", s.version}}.dump();
+            }
+            delta = s.commitLocked(patch);
+            if (delta.empty()) {
+                return json{{"ok", false}, {"version", s.version}}.dump();
+            }
+            version = s.version;
+            for (const auto &[id, listener] : s.listeners) {
+                if (id != origin) {
+                    listeners.push_back(listener);
+                }
+            }
+        }
+
+        Logger::getInstance().info("SharedSettings::applyJson: Version {}, {} ops, {} byte delta to {} windows", version, patch.size(),
+                                   delta.size(), listeners.size());
+        broadcast(listeners, delta);
+        return json{{"ok", true}, {"version", version}}.dump();
+    }
+
+    bool SharedSettings::set(const std::string &key, const std::string &valueJson) {
+        json value = json::parse(valueJson, nullptr, false);
+        if (value.is_discarded()) {
+            // Stored as given, the way the vault used to take any string
+            value = valueJson;
+        }
+
+        std::string delta;
+        std::vector<Listener> listeners;
+        {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.loadLocked();
+            auto pointer = pointerTo(key);
+            json patch   = s.document.contains(key) ? json::diff(s.document[key], value, pointer)
+                                                    : json::array({{{"op", "add"}, {"path", pointer}, {"value", value}}});
+            if (patch.empty()) {
+                return true;
+            }
+            delta = s.commitLocked(patch);
+            if (delta.empty()) {
+                return false;
+            }
+            for (const auto &[id, listener] : s.listeners) {
+                listeners.push_back(listener);
+            }
+        }
+        broadcast(listeners, delta);
+        return true;
+    }
+
+    bool SharedSettings::remove(const std::string &key) {
+        std::string delta;
+        std::vector<Listener> listeners;
+        {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.loadLocked();
+            if (!s.document.contains(key)) {
+                return ConfigStore::remove(key);
+            }
+            delta = s.commitLocked(json::array({{{"op", "remove"}, {"path", pointerTo(key)}}}));
+            if (delta.empty()) {
+                return false;
+            }
+            for (const auto &[id, listener] : s.listeners) {
+                listeners.push_back(listener);
+            }
+        }
+        broadcast(listeners, delta);
+        return true;
+    }
+
+    uint64_t SharedSettings::subscribe(Listener listener) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto id = s.nextSubscription++;
+        s.listeners.emplace(id, std::move(listener));
+        return id;
+    }
+
+    void SharedSettings::unsubscribe(uint64_t id) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.listeners.erase(id);
+    }
+
+} // namespace byoa
@@ -0,0 +1,282 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <unordered_map>
+
+#include "app-paths.hpp"
+#include "llm.hpp"
+#include "logger.hpp"
+#include "router.hpp"
+#include "speculation.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        constexpr const char *STATS_FILE = "action-stats.json";
+
+        // What an action sent last time; kept in memory only since the config holds the API key
+        struct Request {
+            std::string configJson;
+            std::string systemContent;
+        };
+
+        struct Flight {
+            std::string actionId;
+            std::string configId;
+            std::string systemContent;
+            std::string input;
+            Clock::time_point started;
+            Clock::time_point finished;
+            std::atomic<bool> cancelled{false};
+            bool done = false;
+            LLM::Completion completion;
+        };
+
+        struct State {
+            std::mutex mutex;
+            std::condition_variable finished;
+            bool loaded = false;
+            // source key -> action id -> times used
+            json counts = json::object();
+            std::unordered_map<std::string, Request> requests;
+            std::shared_ptr<Flight> flight;
+            std::string source;
+
+            uint64_t predictions  = 0;
+            uint64_t hits         = 0;
+            uint64_t misses       = 0;
+            int64_t savedMicros   = 0;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        // Callers hold the mutex
+        void loadLocked(State &s) {
+            if (s.loaded) {
+                return;
+            }
+            s.loaded = true;
+
+            std::ifstream file(AppPaths::dataDir() / STATS_FILE);
+            if (!file) {
+                return;
+            }
+            json j = json::parse(file, nullptr, false);
+            if (j.is_object()) {
+                s.counts = std::move(j);
+            }
+        }
+
+        void cancelLocked(State &s) {
+            if (s.flight) {
+                s.flight->cancelled = true;
+                s.flight.reset();
+                s.misses++;
+            }
+        }
+
+    } // namespace
+
+    std::string Speculation::contentType(const std::string &content) {
+        if (content.starts_with("http://") || content.starts_with("https://")) {
+            return "url";
+        }
+        // Braces and semicolons at line ends are a cheap but decent signal for code
+        std::size_t lines = 1, codeLines = 0;
+        for (std::size_t i = 0; i < content.size(); i++) {
+            if (content[i] == '\n') {
+                lines++;
+                auto last = i > 0 ? content[i - 1] : '\0';
+                codeLines += last == ';' || last == '{' || last == '}';
+            }
+        }
+        if (codeLines * 4 >= lines && codeLines > 0) {
+            return "code";
+        }
+        return content.size() > 1000 ? "long-text" : "text";
+    }
+
+    void Speculation::begin(const std::string &sourceApp, const std::string &content) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        loadLocked(s);
+        cancelLocked(s);
+
+        s.source = (sourceApp.empty() ? std::string("unknown") : sourceApp) + '/' + contentType(content);
+        if (content.empty() || !s.counts.contains(s.source)) {
+            return;
+        }
+
+        // The favourite action for this source, if it is a clear one
+        std::string actionId;
+        uint64_t best = 0, total = 0;
+        for (const auto &[id, count] : s.counts[s.source].items()) {
+            auto n = count.get<uint64_t>();
+            total += n;
+            if (n > best) {
+                best     = n;
+                actionId = id;
+            }
+        }
+        double confidence = total ? static_cast<double>(best) / total : 0;
+        auto request      = s.requests.find(actionId);
+        if (total < MIN_SAMPLES || confidence < MIN_CONFIDENCE || request == s.requests.end()) {
+            return;
+        }
+
+        auto tokens = Router::estimateTokens(request->second.systemContent) + Router::estimateTokens(content);
+        if (tokens > MAX_TOKENS) {
+            Logger::getInstance().info("Speculation::begin: Skipping {}: ~{} tokens over the cap", actionId, tokens);
+            return;
+        }
+        auto config = LLM::parseConfig(request->second.configJson);
+        if (!config) {
+            return;
+        }
+
+        auto flight           = std::make_shared<Flight>();
+        flight->actionId      = actionId;
+        flight->configId      = config->id;
+        flight->systemContent = request->second.systemContent;
+        flight->input         = content;
+        flight->started       = Clock::now();
+        s.flight              = flight;
+        s.predictions++;
+        Logger::getInstance().info("Speculation::begin: Predicting {} for {} ({:.0f}% of {} uses)", actionId, s.source, confidence * 100,
+                                   total);
+
+        std::thread([flight, config = std::move(*config)] {
+            // Streamed so a misprediction can abort the transfer mid-way
+            auto completion = LLM::stream(config, flight->systemContent, flight->input, nullptr, &flight->cancelled);
+
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            flight->completion = std::move(completion);
+            flight->finished   = Clock::now();
+            flight->done       = true;
+            s.finished.notify_all();
+        }).detach();
+    }
+
+    void Speculation::cancel() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        cancelLocked(s);
+    }
+
+    coco::future<std::string> Speculation::claimAsync(const std::string &actionId, const std::string &configJson,
+                                                      const std::string &systemContent, const std::string &userContent,
+                                                      bool recordUsage) {
+        auto promise = coco::promise<std::string>{};
+        auto future  = promise.get_future();
+
+        std::thread thread{[promise = std::move(promise), actionId, configJson, systemContent, userContent, recordUsage]() mutable {
+            json result   = {{"hit", false}, {"ok", false}, {"content", ""}, {"error", ""}, {"savedMs", 0}};
+            auto config   = LLM::parseConfig(configJson);
+            auto claimed  = Clock::now();
+
+            auto &s = state();
+            std::unique_lock<std::mutex> lock(s.mutex);
+            loadLocked(s);
+            if (recordUsage) {
+                if (!s.source.empty()) {
+                    auto &count = s.counts[s.source][actionId];
+                    count       = count.is_number() ? count.get<uint64_t>() + 1 : 1;
+                }
+                s.requests[actionId] = {configJson, systemContent};
+            }
+
+            auto flight = s.flight;
+            if (flight && config && flight->actionId == actionId && flight->configId == config->id &&
+                flight->systemContent == systemContent && flight->input == userContent) {
+                s.flight.reset();
+                s.finished.wait(lock, [&] { return flight->done; });
+
+                if (flight->completion.ok) {
+                    // Time the user did not have to wait: everything that ran before the click
+                    auto saved =
+                        std::chrono::duration_cast<std::chrono::microseconds>(std::min(claimed, flight->finished) - flight->started);
+                    s.hits++;
+                    s.savedMicros += saved.count();
+                    result["hit"]     = true;
+                    result["ok"]      = true;
+                    result["content"] = flight->completion.content;
+                    result["savedMs"] = saved.count() / 1000;
+                    Logger::getInstance().info("Speculation::claim: Hit for {}, saved {} ms", actionId, saved.count() / 1000);
+                } else {
+                    // Let the caller retry normally
+                    s.misses++;
+                    result["error"] = flight->completion.error;
+                }
+            } else if (flight && flight->actionId != actionId) {
+                // The same action with another config is one of several enabled models; the matching claim takes it
+                Logger::getInstance().info("Speculation::claim: Predicted {}, got {}; cancelling", flight->actionId, actionId);
+                cancelLocked(s);
+            }
+            lock.unlock();
+
+            promise.set_value(result.dump(-1, ' ', false, json::error_handler_t::replace));
+        }};
+        thread.detach();
+
+        return future;
+    }
+
+    std::string Speculation::statsJson() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto decided = s.hits + s.misses;
+        json stats   = {
+            {"predictions", s.predictions},
+            {"hits", s.hits},
+            {"misses", s.misses},
+            {"hitRate", decided ? static_cast<double>(s.hits) / decided : 0.0},
+            {"savedMs", s.savedMicros / 1000},
+            {"counts", s.counts},
+        };
+        return stats.dump();
+    }
+
+    void Speculation::save() {
+        auto &s = state();
+        std::string text;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (!s.loaded) {
+                return;
+            }
+            text = s.counts.dump();
+        }
+
+        // Same temporary-file-and-rename dance as the connection cache
+        auto path      = AppPaths::dataDir() / STATS_FILE;
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            file << text;
+            if (!file) {
+                Logger::getInstance().error("Speculation::save: Failed to write {}", temporary.string());
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temporary, path, ec);
+        if (ec) {
+            Logger::getInstance().error("Speculation::save: Failed to replace {}: {}", path.string(), ec.message());
+        }
+    }
+
+} // namespace byoa
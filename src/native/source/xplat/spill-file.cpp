@@ -0,0 +1,85 @@
+#include "logger.hpp"
+#include "spill-file.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace byoa {
+
+    std::unique_ptr<SpillFile> SpillFile::create() {
+        // tmpfile() is removed automatically once closed, even if the app crashes
+        std::FILE *file = std::tmpfile();
+        if (!file) {
+            Logger::getInstance().error("SpillFile::create: Failed to create temporary file");
+            return nullptr;
+        }
+        return std::unique_ptr<SpillFile>(new SpillFile(file));
+    }
+
+    SpillFile::~SpillFile() {
+#ifdef _WIN32
+        if (_data) {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping) {
+            CloseHandle(_mapping);
+        }
+#else
+        if (_data) {
+            munmap(const_cast<char *>(_data), _size);
+        }
+#endif
+        if (_file) {
+            std::fclose(_file);
+        }
+    }
+
+    bool SpillFile::append(std::string_view data) {
+        if (data.empty()) {
+            return true;
+        }
+        if (std::fwrite(data.data(), 1, data.size(), _file) != data.size()) {
+            Logger::getInstance().error("SpillFile::append: Write failed after {} bytes", _size);
+            return false;
+        }
+        _size += data.size();
+        return true;
+    }
+
+    bool SpillFile::finish() {
+        if (std::fflush(_file) != 0) {
+            Logger::getInstance().error("SpillFile::finish: Flush failed");
+            return false;
+        }
+        if (_size == 0) {
+            return true;
+        }
+
+#ifdef _WIN32
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(_file)));
+        _mapping      = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!_mapping) {
+            Logger::getInstance().error("SpillFile::finish: CreateFileMapping failed: {}", GetLastError());
+            return false;
+        }
+        _data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fileno(_file), 0);
+        _data      = data == MAP_FAILED ? nullptr : static_cast<const char *>(data);
+#endif
+        if (!_data) {
+            Logger::getInstance().error("SpillFile::finish: Failed to map {} bytes", _size);
+            return false;
+        }
+        return true;
+    }
+
+    std::string_view SpillFile::view() const {
+        return _data ? std::string_view(_data, _size) : std::string_view();
+    }
+
+} // namespace byoa
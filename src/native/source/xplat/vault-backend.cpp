@@ -0,0 +1,316 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <keychain/keychain.h>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+#include "crypto.hpp"
+#include "logger.hpp"
+#include "vault-backend.hpp"
+
+namespace byoa {
+
+    namespace {
+
+        VaultBackend::Result notFound() {
+            return {VaultBackend::Status::NOT_FOUND, "", ""};
+        }
+
+        VaultBackend::Result failed(std::string error) {
+            return {VaultBackend::Status::FAILED, "", std::move(error)};
+        }
+
+        class KeychainBackend : public VaultBackend {
+          public:
+            KeychainBackend(std::string package, std::string service) : _package(std::move(package)), _service(std::move(service)) {}
+
+            const char *name() const override {
+                return "keychain";
+            }
+
+            Result get(const std::string &key) override {
+                keychain::Error error;
+                auto value = keychain::getPassword(_package, _service, key, error);
+                return complete(error, std::move(value));
+            }
+
+            Result set(const std::string &key, const std::string &value) override {
+                keychain::Error error;
+                keychain::setPassword(_package, _service, key, value, error);
+                return complete(error, "");
+            }
+
+            Result remove(const std::string &key) override {
+                keychain::Error error;
+                keychain::deletePassword(_package, _service, key, error);
+                return complete(error, "");
+            }
+
+          private:
+            static Result complete(const keychain::Error &error, std::string value) {
+                if (error.type == keychain::ErrorType::NotFound) {
+                    return notFound();
+                } else if (error) {
+                    return failed(error.message);
+                }
+                return {Status::OK, std::move(value), ""};
+            }
+
+            std::string _package;
+            std::string _service;
+        };
+
+        class MemoryBackend : public VaultBackend {
+          public:
+            const char *name() const override {
+                return "memory";
+            }
+
+            Result get(const std::string &key) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _values.find(key);
+                return it == _values.end() ? notFound() : Result{Status::OK, it->second, ""};
+            }
+
+            Result set(const std::string &key, const std::string &value) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _values[key] = value;
+                return {};
+            }
+
+            Result remove(const std::string &key) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _values.erase(key) ? Result{} : notFound();
+            }
+
+          private:
+            std::mutex _mutex;
+            std::map<std::string, std::string> _values;
+        };
+
+        class UnavailableBackend : public VaultBackend {
+          public:
+            explicit UnavailableBackend(std::string reason) : _reason(std::move(reason)) {}
+
+            const char *name() const override {
+                return "unavailable";
+            }
+
+            std::string unusable() const override {
+                return _reason;
+            }
+
+            Result get(const std::string &) override {
+                return failed(_reason);
+            }
+
+            Result set(const std::string &, const std::string &) override {
+                return failed(_reason);
+            }
+
+            Result remove(const std::string &) override {
+                return failed(_reason);
+            }
+
+          private:
+            std::string _reason;
+        };
+
+        /**
+         * File layout: "BYOAVLT1", 16-byte salt, 12-byte nonce, then the sealed
+         * records ([u32 length][key][u32 length][value] each, little-endian).
+         * The unencrypted prefix is the AEAD's associated data, so a swapped salt
+         * or nonce fails to open like any other tampering.
+         */
+        class EncryptedFileBackend : public VaultBackend {
+          public:
+            static constexpr char MAGIC[8]          = {'B', 'Y', 'O', 'A', 'V', 'L', 'T', '1'};
+            static constexpr std::size_t SALT_SIZE   = 16;
+            static constexpr std::size_t HEADER_SIZE = sizeof(MAGIC) + SALT_SIZE + sizeof(Crypto::Nonce);
+            // Paid once per launch; each write only seals with the derived key
+            static constexpr uint32_t ITERATIONS = 100000;
+
+            explicit EncryptedFileBackend(std::filesystem::path path) : _path(std::move(path)) {}
+
+            const char *name() const override {
+                return "file";
+            }
+
+            bool open(const std::string &secret) {
+                std::ifstream file(_path, std::ios::binary);
+                if (!file) {
+                    _salt = Crypto::randomBytes(SALT_SIZE);
+                    _key  = Crypto::pbkdf2(secret, _salt, ITERATIONS);
+                    return true;
+                }
+
+                std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                if (bytes.size() < HEADER_SIZE + Crypto::TAG_SIZE || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+                    Logger::getInstance().error("VaultBackend::encryptedFile: {} is not a vault file", _path.string());
+                    return false;
+                }
+                _salt = bytes.substr(sizeof(MAGIC), SALT_SIZE);
+                _key  = Crypto::pbkdf2(secret, _salt, ITERATIONS);
+
+                Crypto::Nonce nonce;
+                std::memcpy(nonce.data(), bytes.data() + sizeof(MAGIC) + SALT_SIZE, nonce.size());
+                std::string_view header(bytes.data(), HEADER_SIZE);
+                auto plaintext = Crypto::open(_key, nonce, header, std::string_view(bytes).substr(HEADER_SIZE));
+                if (!plaintext || !decode(*plaintext)) {
+                    Logger::getInstance().error("VaultBackend::encryptedFile: Cannot open {}: wrong secret or corrupted", _path.string());
+                    return false;
+                }
+                return true;
+            }
+
+            Result get(const std::string &key) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _values.find(key);
+                return it == _values.end() ? notFound() : Result{Status::OK, it->second, ""};
+            }
+
+            Result set(const std::string &key, const std::string &value) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto previous = _values.find(key);
+                std::optional<std::string> undo;
+                if (previous != _values.end()) {
+                    undo = previous->second;
+                }
+                _values[key] = value;
+                if (auto error = writeLocked(); !error.empty()) {
+                    if (undo) {
+                        _values[key] = *undo;
+                    } else {
+                        _values.erase(key);
+                    }
+                    return failed(error);
+                }
+                return {};
+            }
+
+            Result remove(const std::string &key) override {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _values.find(key);
+                if (it == _values.end()) {
+                    return notFound();
+                }
+                auto undo = std::move(it->second);
+                _values.erase(it);
+                if (auto error = writeLocked(); !error.empty()) {
+                    _values[key] = std::move(undo);
+                    return failed(error);
+                }
+                return {};
+            }
+
+          private:
+            static void putLength(std::string &out, std::size_t length) {
+                for (int shift = 0; shift < 32; shift += 8) {
+                    out += static_cast<char>((length >> shift) & 0xff);
+                }
+            }
+
+            bool decode(const std::string &data) {
+                std::size_t offset = 0;
+                auto take          = [&](std::string &out) {
+                    if (data.size() - offset < 4) {
+                        return false;
+                    }
+                    uint32_t length = 0;
+                    for (int i = 0; i < 4; i++) {
+                        length |= static_cast<uint32_t>(static_cast<uint8_t>(data[offset + i])) << (8 * i);
+                    }
+                    offset += 4;
+                    if (data.size() - offset < length) {
+                        return false;
+                    }
+                    out = data.substr(offset, length);
+                    offset += length;
+                    return true;
+                };
+
+                std::map<std::string, std::string> values;
+                while (offset < data.size()) {
+                    std::string key, value;
+                    if (!take(key) || !take(value)) {
+                        return false;
+                    }
+                    values[std::move(key)] = std::move(value);
+                }
+                _values = std::move(values);
+                return true;
+            }
+
+            // Returns an error message, empty on success. Callers hold the mutex.
+            std::string writeLocked() {
+                std::string plaintext;
+                for (const auto &[key, value] : _values) {
+                    putLength(plaintext, key.size());
+                    plaintext += key;
+                    putLength(plaintext, value.size());
+                    plaintext += value;
+                }
+
+                // A fresh nonce per write: the key stays the same for the life of the file
+                Crypto::Nonce nonce;
+                auto random = Crypto::randomBytes(nonce.size());
+                std::memcpy(nonce.data(), random.data(), nonce.size());
+                std::string bytes(MAGIC, sizeof(MAGIC));
+                bytes += _salt;
+                bytes.append(reinterpret_cast<const char *>(nonce.data()), nonce.size());
+                bytes += Crypto::seal(_key, nonce, bytes, plaintext);
+
+                // Same temporary-file-and-rename dance as the config store
+                auto temporary = _path;
+                temporary += ".tmp";
+                {
+                    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+                    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+                    file.flush();
+                    if (!file) {
+                        return "Failed to write " + temporary.string();
+                    }
+                }
+                std::error_code ec;
+                std::filesystem::permissions(temporary, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write, ec);
+                std::filesystem::rename(temporary, _path, ec);
+                if (ec) {
+                    return "Failed to replace " + _path.string() + ": " + ec.message();
+                }
+                return "";
+            }
+
+            std::filesystem::path _path;
+            std::string _salt;
+            Crypto::Key _key{};
+            std::mutex _mutex;
+            std::map<std::string, std::string> _values;
+        };
+
+    } // namespace
+
+    std::unique_ptr<VaultBackend> VaultBackend::keychain(const std::string &package, const std::string &service) {
+        return std::make_unique<KeychainBackend>(package, service);
+    }
+
+    std::unique_ptr<VaultBackend> VaultBackend::encryptedFile(const std::filesystem::path &path, const std::string &secret) {
+        auto backend = std::make_unique<EncryptedFileBackend>(path);
+        if (!backend->open(secret)) {
+            return nullptr;
+        }
+        return backend;
+    }
+
+    std::unique_ptr<VaultBackend> VaultBackend::memory() {
+        return std::make_unique<MemoryBackend>();
+    }
+
+    std::unique_ptr<VaultBackend> VaultBackend::unavailable(const std::string &reason) {
+        return std::make_unique<UnavailableBackend>(reason);
+    }
+
+} // namespace byoa
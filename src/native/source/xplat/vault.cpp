@@ -1,53 +1,771 @@
-#include <keychain/keychain.h>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <unordered_map>
 
+#include "app-paths.hpp"
+#include "crypto.hpp"
 #include "logger.hpp"
+#include "vault-backend.hpp"
 #include "vault.hpp"
 
 namespace byoa {
 
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        constexpr const char *VAULT_FILE = "vault.bin";
+        constexpr const char *KEY_FILE   = "vault.key";
+        // Long enough to absorb a slider drag or a burst of toggles
+        constexpr std::chrono::milliseconds DEFAULT_WRITE_BEHIND_DELAY{500};
+
+        struct Entry {
+            // std::nullopt caches "not found" as well
+            std::optional<std::string> value;
+            Clock::time_point fetched;
+        };
+
+        // Told whether a deferred change reached the store
+        using Waiter = std::function<void(bool written)>;
+
+        struct Pending {
+            // std::nullopt is a deferred delete
+            std::optional<std::string> value;
+            // Tells a flush whether the change it wrote was replaced meanwhile
+            uint64_t sequence = 0;
+            // Carried over to the change that replaces this one, which answers them
+            std::vector<Waiter> waiters;
+        };
+
+        // What a flush writes; Pending without the waiters
+        struct Change {
+            std::string key;
+            std::optional<std::string> value;
+            uint64_t sequence;
+        };
+
+        struct State {
+            std::mutex mutex;
+            std::unordered_map<std::string, Entry> entries;
+            // Deferred changes not in the store yet; reads see these first
+            std::map<std::string, Pending> pending;
+            // Error of each pending change the store rejected, until a write of the key goes through
+            std::map<std::string, std::string> failures;
+            Vault::StatusListener statusListener;
+            uint64_t sequence                = 0;
+            bool flushQueued                 = false;
+            Clock::duration writeBehindDelay = DEFAULT_WRITE_BEHIND_DELAY;
+            Clock::duration revalidateInterval = Clock::duration::zero();
+            std::shared_ptr<VaultBackend> backend;
+            // Bumped by every write, so a read racing with one doesn't cache what it read before it
+            uint64_t writes = 0;
+        };
+
+        State &state() {
+            static State instance;
+            return instance;
+        }
+
+        // Callers hold the mutex
+        bool fresh(const State &s, const Entry &entry) {
+            return s.revalidateInterval == Clock::duration::zero() || Clock::now() - entry.fetched < s.revalidateInterval;
+        }
+
+        void remember(const std::string &key, std::optional<std::string> value) {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.entries[key] = {std::move(value), Clock::now()};
+            s.writes++;
+        }
+
+        void notifyStatus() {
+            Vault::StatusListener listener;
+            {
+                auto &s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                listener = s.statusListener;
+            }
+            if (listener) {
+                listener(Vault::statusJson());
+            }
+        }
+
+        // A direct write supersedes whatever was deferred for the key; returns who waited on that
+        std::vector<Waiter> dropPending(const std::string &key) {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto it = s.pending.find(key);
+            if (it == s.pending.end()) {
+                return {};
+            }
+            auto waiters = std::move(it->second.waiters);
+            s.pending.erase(it);
+            return waiters;
+        }
+
+        // Answer the waiters of a dropped deferred change with the outcome of the direct write; a successful one ends a failure
+        void settleDirect(const std::string &key, const std::vector<Waiter> &waiters, bool written) {
+            bool cleared = false;
+            if (written) {
+                auto &s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                cleared = s.failures.erase(key) > 0;
+            }
+            for (const auto &waiter : waiters) {
+                waiter(written);
+            }
+            if (cleared) {
+                notifyStatus();
+            }
+        }
+
+        void rememberRead(const std::string &key, std::optional<std::string> value, uint64_t writesBefore) {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (s.writes == writesBefore) {
+                s.entries[key] = {std::move(value), Clock::now()};
+            }
+        }
+
+    } // namespace
+
     bool Vault::storeData(const std::string &key, const std::string &value) {
-        keychain::Error error;
-        keychain::setPassword(PACKAGE_NAME, SERVICE_NAME, key, value, error);
+        auto waiters = dropPending(key);
+        auto result  = backend()->set(key, value);
 
-        if (error) {
-            Logger::getInstance().error("Failed to store data: {}", error.message);
+        if (result.status != VaultBackend::Status::OK) {
+            Logger::getInstance().error("Failed to store data: {}", result.error);
+            // The store may or may not hold the new value now
+            invalidate(key);
+            settleDirect(key, waiters, false);
             return false;
         }
 
+        remember(key, value);
+        settleDirect(key, waiters, true);
         return true;
     }
 
     std::optional<std::string> Vault::getData(const std::string &key) {
-        keychain::Error error;
-        auto data = keychain::getPassword(PACKAGE_NAME, SERVICE_NAME, key, error);
+        uint64_t writesBefore;
+        {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            writesBefore = s.writes;
+            if (auto pending = s.pending.find(key); pending != s.pending.end()) {
+                return pending->second.value;
+            }
+            auto it = s.entries.find(key);
+            if (it != s.entries.end() && fresh(s, it->second)) {
+                return it->second.value;
+            }
+        }
+
+        auto started = Clock::now();
+        auto store  = backend();
+        auto result = store->get(key);
+        Logger::getInstance().info("Vault::getData: Read {} from the {} store in {} us", key, store->name(),
+                                   std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count());
 
-        if (error.type == keychain::ErrorType::NotFound) {
+        if (result.status == VaultBackend::Status::NOT_FOUND) {
+            rememberRead(key, std::nullopt, writesBefore);
             return std::nullopt;
-        } else if (error) {
-            Logger::getInstance().error("Failed to get data: {}", error.message);
+        } else if (result.status != VaultBackend::Status::OK) {
+            // Not cached: the next read tries the store again
+            Logger::getInstance().error("Failed to get data: {}", result.error);
             return std::nullopt;
         }
 
-        return data;
+        rememberRead(key, result.value, writesBefore);
+        return result.value;
     }
 
     bool Vault::deleteData(const std::string &key) {
-        keychain::Error error;
-        keychain::deletePassword(PACKAGE_NAME, SERVICE_NAME, key, error);
+        auto waiters = dropPending(key);
+        auto result  = backend()->remove(key);
 
-        if (error) {
-            Logger::getInstance().error("Failed to delete data: {}", error.message);
+        if (result.status != VaultBackend::Status::OK) {
+            Logger::getInstance().error("Failed to delete data: {}", result.error);
+            invalidate(key);
+            settleDirect(key, waiters, false);
             return false;
         }
 
+        remember(key, std::nullopt);
+        settleDirect(key, waiters, true);
         return true;
     }
 
     bool Vault::hasData(const std::string &key) {
-        keychain::Error error;
-        keychain::getPassword(PACKAGE_NAME, SERVICE_NAME, key, error);
+        return getData(key).has_value();
+    }
+
+    Vault::Values Vault::getMany(const std::vector<std::string> &keys) {
+        Values values;
+        std::vector<std::string> missing;
+        uint64_t writesBefore;
+        {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            writesBefore = s.writes;
+            for (const auto &key : keys) {
+                auto it = s.entries.find(key);
+                if (auto pending = s.pending.find(key); pending != s.pending.end()) {
+                    values[key] = pending->second.value;
+                } else if (it != s.entries.end() && fresh(s, it->second)) {
+                    values[key] = it->second.value;
+                } else {
+                    missing.push_back(key);
+                }
+            }
+        }
+        if (missing.empty()) {
+            return values;
+        }
+
+        auto started = Clock::now();
+        auto store   = backend();
+        for (const auto &key : missing) {
+            auto result = store->get(key);
+            if (result.status == VaultBackend::Status::NOT_FOUND) {
+                values[key] = std::nullopt;
+                rememberRead(key, std::nullopt, writesBefore);
+            } else if (result.status != VaultBackend::Status::OK) {
+                Logger::getInstance().error("Failed to get data: {}", result.error);
+                values[key] = std::nullopt;
+            } else {
+                values[key] = result.value;
+                rememberRead(key, std::move(result.value), writesBefore);
+            }
+        }
+        Logger::getInstance().info("Vault::getMany: Read {} of {} keys from the {} store in {} us", missing.size(), keys.size(),
+                                   store->name(), std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count());
+        return values;
+    }
+
+    bool Vault::setMany(const std::map<std::string, std::string> &values) {
+        bool success = true;
+        for (const auto &[key, value] : values) {
+            success = storeData(key, value) && success;
+        }
+        return success;
+    }
+
+    struct Vault::Worker {
+        struct Job {
+            std::vector<std::string> keys;
+            const char *operation;
+            std::function<void()> run;
+            Clock::time_point queued;
+        };
+
+        struct Timing {
+            uint64_t count       = 0;
+            int64_t waitMicros   = 0;
+            int64_t runMicros    = 0;
+            int64_t maxRunMicros = 0;
+        };
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Job> queue;
+        // Queued or running jobs per key, and ones that touch every key
+        std::unordered_map<std::string, std::size_t> pending;
+        std::size_t pendingAll = 0;
+        std::size_t maxDepth   = 0;
+        std::unordered_map<std::string, Timing> timings;
+        bool stop = false;
+        std::thread thread;
+
+        Worker() : thread([this] { loop(); }) {}
+
+        // Drains what is queued, so writes made just before exit still reach the store
+        ~Worker() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            wake.notify_one();
+            thread.join();
+        }
+
+        void loop() {
+            while (true) {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [this] { return stop || !queue.empty(); });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                }
+
+                auto started = Clock::now();
+                job.run();
+                auto finished = Clock::now();
+
+                auto waited = std::chrono::duration_cast<std::chrono::microseconds>(started - job.queued).count();
+                auto ran    = std::chrono::duration_cast<std::chrono::microseconds>(finished - started).count();
+                if (finished - started >= SLOW_OPERATION) {
+                    Logger::getInstance().warn("Vault::Worker: {} took {} ms after waiting {} ms", job.operation, ran / 1000,
+                                               waited / 1000);
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                auto &timing = timings[job.operation];
+                timing.count++;
+                timing.waitMicros += waited;
+                timing.runMicros += ran;
+                timing.maxRunMicros = std::max(timing.maxRunMicros, ran);
+                if (job.keys.empty()) {
+                    pendingAll--;
+                }
+                for (const auto &key : job.keys) {
+                    if (--pending[key] == 0) {
+                        pending.erase(key);
+                    }
+                }
+            }
+        }
+    };
+
+    Vault::Worker &Vault::worker() {
+        // Constructed first so it is destroyed last: flushes the worker drains at exit may re-arm it
+        flusher();
+        static Worker instance;
+        return instance;
+    }
+
+    void Vault::enqueue(std::vector<std::string> keys, const char *operation, std::function<void()> job) {
+        auto &w = worker();
+        {
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (keys.empty()) {
+                w.pendingAll++;
+            }
+            for (const auto &key : keys) {
+                w.pending[key]++;
+            }
+            w.queue.push_back({std::move(keys), operation, std::move(job), Clock::now()});
+            w.maxDepth = std::max(w.maxDepth, w.queue.size());
+        }
+        w.wake.notify_one();
+    }
+
+    std::optional<std::optional<std::string>> Vault::settled(const std::string &key) {
+        {
+            auto &w = worker();
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (w.pendingAll || w.pending.contains(key)) {
+                return std::nullopt;
+            }
+        }
+        // A job queued from here on was submitted after this read, so answering from the cache keeps the order
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (auto pending = s.pending.find(key); pending != s.pending.end()) {
+            return pending->second.value;
+        }
+        auto it = s.entries.find(key);
+        if (it == s.entries.end() || !fresh(s, it->second)) {
+            return std::nullopt;
+        }
+        return it->second.value;
+    }
+
+    coco::future<std::string> Vault::getDataAsync(const std::string &key) {
+        if (auto cached = settled(key)) {
+            coco::promise<std::string> promise;
+            auto future = promise.get_future();
+            promise.set_value(cached->value_or(""));
+            return future;
+        }
+        return submit<std::string>({key}, "getData", [key]() { return getData(key).value_or(""); });
+    }
+
+    coco::future<bool> Vault::storeDataAsync(const std::string &key, const std::string &value) {
+        auto promise = std::make_shared<coco::promise<bool>>();
+        auto future  = promise->get_future();
+        defer(key, value, [promise](bool written) { promise->set_value(written); });
+        return future;
+    }
+
+    coco::future<bool> Vault::deleteDataAsync(const std::string &key) {
+        auto promise = std::make_shared<coco::promise<bool>>();
+        auto future  = promise->get_future();
+        defer(key, std::nullopt, [promise](bool written) { promise->set_value(written); });
+        return future;
+    }
+
+    coco::future<bool> Vault::hasDataAsync(const std::string &key) {
+        if (auto cached = settled(key)) {
+            coco::promise<bool> promise;
+            auto future = promise.get_future();
+            promise.set_value(cached->has_value());
+            return future;
+        }
+        return submit<bool>({key}, "hasData", [key]() { return hasData(key); });
+    }
+
+    coco::future<Vault::Values> Vault::getManyAsync(const std::vector<std::string> &keys) {
+        return submit<Values>(keys, "getMany", [keys]() { return getMany(keys); });
+    }
+
+    coco::future<bool> Vault::setManyAsync(const std::map<std::string, std::string> &values) {
+        struct Outcome {
+            coco::promise<bool> promise;
+            std::size_t remaining = 0;
+            bool written          = true;
+            std::mutex mutex;
+        };
+        auto outcome       = std::make_shared<Outcome>();
+        auto future        = outcome->promise.get_future();
+        outcome->remaining = values.size();
+        if (values.empty()) {
+            outcome->promise.set_value(true);
+            return future;
+        }
+        for (const auto &[key, value] : values) {
+            defer(key, value, [outcome](bool written) {
+                std::unique_lock<std::mutex> lock(outcome->mutex);
+                outcome->written = outcome->written && written;
+                if (--outcome->remaining == 0) {
+                    lock.unlock();
+                    outcome->promise.set_value(outcome->written);
+                }
+            });
+        }
+        return future;
+    }
+
+    struct Vault::Flusher {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::optional<Clock::time_point> due;
+        bool stop = false;
+        std::thread thread;
+
+        Flusher() : thread([this] { loop(); }) {}
+
+        ~Flusher() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            wake.notify_one();
+            thread.join();
+        }
+
+        // Later changes don't push an armed flush back, so none waits much longer than the delay
+        void arm(Clock::time_point at) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (due) {
+                    return;
+                }
+                due = at;
+            }
+            wake.notify_one();
+        }
+
+        void loop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stop) {
+                if (!due) {
+                    wake.wait(lock, [this] { return stop || due; });
+                    continue;
+                }
+                if (wake.wait_until(lock, *due, [this] { return stop; })) {
+                    return;
+                }
+                due.reset();
+                lock.unlock();
+                scheduleFlush();
+                lock.lock();
+            }
+        }
+    };
+
+    Vault::Flusher &Vault::flusher() {
+        static Flusher instance;
+        return instance;
+    }
+
+    bool Vault::defer(const std::string &key, std::optional<std::string> value, std::function<void(bool)> written) {
+        // Kept pending, the change would be served for the session and then silently lost at exit
+        if (auto reason = backend()->unusable(); !reason.empty()) {
+            Logger::getInstance().error("Vault::defer: Refusing to keep {}: {}", key, reason);
+            if (written) {
+                written(false);
+            }
+            return false;
+        }
+
+        auto &s = state();
+        Clock::duration delay;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto &pending    = s.pending[key];
+            pending.value    = value;
+            pending.sequence = ++s.sequence;
+            if (written) {
+                pending.waiters.push_back(std::move(written));
+            }
+            s.entries[key] = {std::move(value), Clock::now()};
+            s.writes++;
+            delay = s.writeBehindDelay;
+        }
+        if (delay == Clock::duration::zero()) {
+            scheduleFlush();
+        } else {
+            flusher().arm(Clock::now() + delay);
+        }
+        return true;
+    }
+
+    bool Vault::storeDeferred(const std::string &key, const std::string &value) {
+        return defer(key, value);
+    }
+
+    bool Vault::deleteDeferred(const std::string &key) {
+        return defer(key, std::nullopt);
+    }
+
+    bool Vault::flush() {
+        auto &s = state();
+        std::vector<Change> batch;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.flushQueued = false;
+            for (const auto &[key, pending] : s.pending) {
+                batch.push_back({key, pending.value, pending.sequence});
+            }
+        }
+        if (batch.empty()) {
+            return true;
+        }
+
+        auto started       = Clock::now();
+        auto store         = backend();
+        std::size_t failed = 0;
+        bool changed       = false;
+        for (const auto &change : batch) {
+            auto result  = change.value ? store->set(change.key, *change.value) : store->remove(change.key);
+            bool written = result.status == VaultBackend::Status::OK || (!change.value && result.status == VaultBackend::Status::NOT_FOUND);
+            if (!written) {
+                Logger::getInstance().error("Vault::flush: Failed to write {}: {}", change.key, result.error);
+                failed++;
+            }
+
+            std::vector<Waiter> answered;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (written) {
+                    changed |= s.failures.erase(change.key) > 0;
+                } else {
+                    auto [failure, added] = s.failures.try_emplace(change.key, result.error);
+                    changed |= added || failure->second != result.error;
+                    failure->second = result.error;
+                }
+                // A change replaced meanwhile leaves its waiters to the flush that writes the replacement
+                auto it = s.pending.find(change.key);
+                if (it != s.pending.end() && it->second.sequence == change.sequence) {
+                    answered = std::move(it->second.waiters);
+                    it->second.waiters.clear();
+                    if (written) {
+                        s.pending.erase(it);
+                    }
+                }
+            }
+            for (const auto &waiter : answered) {
+                waiter(written);
+            }
+        }
+        Logger::getInstance().info("Vault::flush: Wrote {} of {} deferred changes to the {} store in {} us", batch.size() - failed,
+                                   batch.size(), store->name(),
+                                   std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count());
+        if (changed) {
+            notifyStatus();
+        }
+        return failed == 0;
+    }
+
+    coco::future<bool> Vault::flushAsync() {
+        return submit<bool>({}, "flush", [] { return flush(); });
+    }
 
-        return error.type != keychain::ErrorType::NotFound;
+    void Vault::scheduleFlush() {
+        {
+            auto &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (s.pending.empty() || s.flushQueued) {
+                return;
+            }
+            s.flushQueued = true;
+        }
+        // Ordered after every queued job, like any other write
+        enqueue({}, "flush", [] {
+            if (!flush()) {
+                flusher().arm(Clock::now() + RETRY_DELAY);
+            }
+        });
+    }
+
+    void Vault::setWriteBehindDelay(std::chrono::milliseconds delay) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.writeBehindDelay = delay;
+    }
+
+    std::string Vault::workerStatsJson() {
+        auto &w = worker();
+        std::lock_guard<std::mutex> lock(w.mutex);
+        nlohmann::json operations = nlohmann::json::object();
+        for (const auto &[operation, timing] : w.timings) {
+            operations[operation] = {
+                {"count", timing.count},
+                {"avgWaitMs", timing.count ? timing.waitMicros / 1000.0 / timing.count : 0.0},
+                {"avgRunMs", timing.count ? timing.runMicros / 1000.0 / timing.count : 0.0},
+                {"maxRunMs", timing.maxRunMicros / 1000.0},
+            };
+        }
+        nlohmann::json result = {{"queued", w.queue.size()}, {"maxQueued", w.maxDepth}, {"operations", std::move(operations)}};
+        return result.dump();
+    }
+
+    std::string Vault::statusJson() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        nlohmann::json failed = nlohmann::json::object();
+        for (const auto &[key, error] : s.failures) {
+            failed[key] = error;
+        }
+        nlohmann::json status = {{"pending", s.pending.size()}, {"failed", std::move(failed)}};
+        if (auto reason = s.backend ? s.backend->unusable() : std::string(); !reason.empty()) {
+            status["unavailable"] = reason;
+        }
+        return status.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    }
+
+    void Vault::setStatusListener(StatusListener listener) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.statusListener = std::move(listener);
+    }
+
+    void Vault::invalidate(const std::string &key) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (key.empty()) {
+            s.entries.clear();
+        } else {
+            s.entries.erase(key);
+        }
+        s.writes++;
+    }
+
+    void Vault::setRevalidateInterval(std::chrono::seconds interval) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.revalidateInterval = interval;
+    }
+
+    std::shared_ptr<VaultBackend> Vault::backend() {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.backend) {
+            s.backend = VaultBackend::keychain(PACKAGE_NAME, SERVICE_NAME);
+        }
+        return s.backend;
+    }
+
+    void Vault::setBackend(std::unique_ptr<VaultBackend> backend) {
+        auto &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.backend = std::move(backend);
+        // Whatever was cached came from the previous store
+        s.entries.clear();
+        s.writes++;
+    }
+
+    namespace {
+
+        // BYOA_VAULT_SECRET, or a random key kept next to the vault file (readable by the user only)
+        std::optional<std::string> fileSecret() {
+            const char *secret = std::getenv("BYOA_VAULT_SECRET");
+            if (secret && *secret) {
+                return std::string(secret);
+            }
+
+            auto path = AppPaths::dataDir() / KEY_FILE;
+            std::ifstream existing(path, std::ios::binary);
+            if (existing) {
+                std::string key((std::istreambuf_iterator<char>(existing)), std::istreambuf_iterator<char>());
+                if (!key.empty()) {
+                    return key;
+                }
+            }
+
+            auto key = Crypto::randomBytes(32);
+            {
+                std::ofstream file(path, std::ios::binary | std::ios::trunc);
+                file.write(key.data(), static_cast<std::streamsize>(key.size()));
+                file.flush();
+                if (!file) {
+                    Logger::getInstance().error("Vault::configureFromEnvironment: Failed to write {}", path.string());
+                    return std::nullopt;
+                }
+            }
+            std::error_code ec;
+            std::filesystem::permissions(path, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write, ec);
+            Logger::getInstance().info("Vault::configureFromEnvironment: Created vault key {}", path.string());
+            return key;
+        }
+
+    } // namespace
+
+    void Vault::configureFromEnvironment() {
+        const char *seconds = std::getenv("BYOA_VAULT_REVALIDATE_SECONDS");
+        if (seconds && *seconds) {
+            setRevalidateInterval(std::chrono::seconds(std::strtol(seconds, nullptr, 10)));
+            Logger::getInstance().info("Vault::configureFromEnvironment: Revalidating cached entries after {} s", seconds);
+        }
+
+        const char *writeBehind = std::getenv("BYOA_VAULT_WRITE_BEHIND_MS");
+        if (writeBehind && *writeBehind) {
+            setWriteBehindDelay(std::chrono::milliseconds(std::strtol(writeBehind, nullptr, 10)));
+            Logger::getInstance().info("Vault::configureFromEnvironment: Deferred writes wait up to {} ms", writeBehind);
+        }
+
+        const char *name     = std::getenv("BYOA_VAULT_BACKEND");
+        std::string selected = name && *name ? name : "keychain";
+        if (selected == "file") {
+            auto secret = fileSecret();
+            auto file   = secret ? VaultBackend::encryptedFile(AppPaths::dataDir() / VAULT_FILE, *secret) : nullptr;
+            if (file) {
+                setBackend(std::move(file));
+            } else {
+                // Not falling back to another store: secrets saved there would be missing once the file opens again
+                auto path = AppPaths::dataDir() / VAULT_FILE;
+                Logger::getInstance().error("Vault::configureFromEnvironment: Can't open {}, refusing API key reads and writes",
+                                            path.string());
+                setBackend(VaultBackend::unavailable("Encrypted vault " + path.string() + " can't be opened"));
+            }
+        } else if (selected == "memory") {
+            setBackend(VaultBackend::memory());
+        } else if (selected != "keychain") {
+            Logger::getInstance().warn("Vault::configureFromEnvironment: Unknown BYOA_VAULT_BACKEND '{}', using keychain", selected);
+        }
+        Logger::getInstance().info("Vault::configureFromEnvironment: Using the {} store", backend()->name());
     }
 
 } // namespace byoa
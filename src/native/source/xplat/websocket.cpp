@@ -0,0 +1,539 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <curl/curl.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+#include "logger.hpp"
+#include "websocket.hpp"
+
+using json = nlohmann::json;
+
+namespace byoa {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        constexpr auto HEARTBEAT_INTERVAL   = std::chrono::seconds(15);
+        constexpr auto DEAD_AFTER           = HEARTBEAT_INTERVAL * 3;
+        constexpr auto IDLE_DISCONNECT      = std::chrono::minutes(10);
+        constexpr auto MIN_BACKOFF          = std::chrono::milliseconds(500);
+        constexpr auto MAX_BACKOFF          = std::chrono::seconds(30);
+        constexpr int MAX_CONNECT_ATTEMPTS  = 6;
+        constexpr std::size_t RECEIVE_CHUNK = 16 * 1024;
+
+        bool waitSocket(curl_socket_t socket, bool forWrite, int timeoutMs) {
+#ifdef _WIN32
+            WSAPOLLFD fd{};
+            fd.fd     = socket;
+            fd.events = forWrite ? POLLWRNORM : POLLRDNORM;
+            return WSAPoll(&fd, 1, timeoutMs) > 0;
+#else
+            pollfd fd{};
+            fd.fd     = socket;
+            fd.events = forWrite ? POLLOUT : POLLIN;
+            return poll(&fd, 1, timeoutMs) > 0;
+#endif
+        }
+
+        std::string resultJson(bool ok, const std::string &error, const std::string &message) {
+            json j = {{"ok", ok}, {"error", error}, {"message", message}};
+            return j.dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+
+    } // namespace
+
+    class WebSocket::Connection {
+      public:
+        struct Request {
+            std::string id;
+            std::string payload;
+            DeltaCallback onDelta;
+            coco::promise<std::string> promise;
+        };
+
+        explicit Connection(std::string url) : _url(std::move(url)), _multi(curl_multi_init()) {
+            _thread = std::thread([this]() { run(); });
+        }
+
+        ~Connection() {
+            stop();
+            if (_multi) {
+                curl_multi_cleanup(_multi);
+            }
+        }
+
+        void setHeaders(std::vector<std::string> headers) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_headers.empty() && headers != _headers) {
+                // New credentials only apply to a new handshake
+                _reconnectRequested = true;
+            }
+            _headers = std::move(headers);
+        }
+
+        void enqueue(Request request) {
+            bool duplicate = false;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                // Replies are routed by id, so a second pending request with the same id would take over the first one's
+                duplicate = !_pendingIds.insert(request.id).second;
+                if (!duplicate) {
+                    _outbound.push_back(std::move(request));
+                    _lastUse = Clock::now();
+                }
+            }
+            if (duplicate) {
+                Logger::getInstance().warn("WebSocket::enqueue: Request id {} is already pending on {}", request.id, _url);
+                request.promise.set_value(resultJson(false, "Request id already in use: " + request.id, ""));
+                return;
+            }
+            wake();
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            wake();
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+      private:
+        // Interrupts whichever wait the connection thread is in: the condition variable or the socket poll
+        void wake() {
+            _cv.notify_all();
+            if (_multi) {
+                curl_multi_wakeup(_multi);
+            }
+        }
+
+        // Blocks until the socket is readable, wake() is called or @p timeout passes; true if there is data to read
+        bool waitReadable(Clock::duration timeout) {
+            timeout       = std::max(timeout, Clock::duration::zero());
+            int timeoutMs = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(timeout).count());
+            if (!_multi) {
+                // Nothing can interrupt a plain poll, so keep it short enough for new requests to go out promptly
+                return waitSocket(_socket, false, std::min(timeoutMs, 10));
+            }
+
+            curl_waitfd fd{};
+            fd.fd     = _socket;
+            fd.events = CURL_WAIT_POLLIN;
+            if (curl_multi_poll(_multi, &fd, 1, timeoutMs, nullptr) != CURLM_OK) {
+                return false;
+            }
+            return fd.revents & CURL_WAIT_POLLIN;
+        }
+
+        // Time until the next heartbeat, dead-peer or idle check is due
+        Clock::duration untilNextCheck(Clock::time_point now) {
+            auto next = std::min(std::max(_lastActivity, _lastPing) + HEARTBEAT_INTERVAL, _lastActivity + DEAD_AFTER);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                next = std::min(next, _lastUse + IDLE_DISCONNECT);
+                if (!_outbound.empty()) {
+                    return Clock::duration::zero();
+                }
+            }
+            return next - now;
+        }
+
+        void run() {
+            int attempts = 0;
+            auto backoff = std::chrono::duration_cast<Clock::duration>(MIN_BACKOFF);
+
+            while (true) {
+                bool reconnect = false;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    if (!_curl && Clock::now() - _lastUse > IDLE_DISCONNECT) {
+                        // Unused for a while: only (re)connect once there is something to send
+                        _cv.wait(lock, [this]() { return _stopping || !_outbound.empty(); });
+                    }
+                    if (_stopping) {
+                        break;
+                    }
+                    std::swap(reconnect, _reconnectRequested);
+                }
+
+                if (reconnect && _curl) {
+                    disconnect("Handshake headers changed");
+                }
+
+                if (!_curl) {
+                    if (!connect()) {
+                        if (++attempts >= MAX_CONNECT_ATTEMPTS) {
+                            failOutbound("Unable to connect to " + _url);
+                            attempts = 0;
+                            backoff  = MIN_BACKOFF;
+                            continue;
+                        }
+
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _cv.wait_for(lock, backoff, [this]() { return _stopping; });
+                        backoff = std::min<Clock::duration>(backoff * 2, MAX_BACKOFF);
+                        continue;
+                    }
+                    attempts = 0;
+                    backoff  = MIN_BACKOFF;
+                }
+
+                flushOutbound();
+                if (!_curl) {
+                    continue;
+                }
+
+                // Sleeps until the peer sends something, a request is enqueued or a check is due; no polling interval
+                if (waitReadable(untilNextCheck(Clock::now())) && !receive()) {
+                    continue;
+                }
+
+                auto now = Clock::now();
+                if (now - _lastActivity > DEAD_AFTER) {
+                    disconnect("Heartbeat timeout");
+                    continue;
+                }
+                if (now - _lastActivity > HEARTBEAT_INTERVAL && now - _lastPing > HEARTBEAT_INTERVAL) {
+                    _lastPing = now;
+                    if (!sendFrame("", CURLWS_PING)) {
+                        disconnect("Failed to send ping");
+                        continue;
+                    }
+                }
+
+                bool idle = false;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    idle = _inflight.empty() && _outbound.empty() && now - _lastUse > IDLE_DISCONNECT;
+                }
+                if (idle) {
+                    disconnect("Idle");
+                }
+            }
+
+            if (_curl) {
+                disconnect("Shutting down");
+            }
+            failOutbound("Shutting down");
+        }
+
+        bool connect() {
+            std::vector<std::string> headers;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                headers = _headers;
+            }
+
+            _curl = curl_easy_init();
+            if (!_curl) {
+                return false;
+            }
+
+            for (const auto &header : headers) {
+                _headerList = curl_slist_append(_headerList, header.c_str());
+            }
+            curl_easy_setopt(_curl, CURLOPT_URL, _url.c_str());
+            curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _headerList);
+            curl_easy_setopt(_curl, CURLOPT_CONNECTTIMEOUT, 10L);
+            // Perform the upgrade handshake only; frames are exchanged with curl_ws_send/recv
+            curl_easy_setopt(_curl, CURLOPT_CONNECT_ONLY, 2L);
+
+            CURLcode rc = curl_easy_perform(_curl);
+            if (rc != CURLE_OK) {
+                Logger::getInstance().error("WebSocket::connect: {} failed: {}", _url, curl_easy_strerror(rc));
+                cleanup();
+                return false;
+            }
+
+            curl_easy_getinfo(_curl, CURLINFO_ACTIVESOCKET, &_socket);
+            _lastActivity = _lastPing = Clock::now();
+            Logger::getInstance().info("WebSocket::connect: Connected to {}", _url);
+            return true;
+        }
+
+        void cleanup() {
+            if (_curl) {
+                curl_easy_cleanup(_curl);
+                _curl = nullptr;
+            }
+            if (_headerList) {
+                curl_slist_free_all(_headerList);
+                _headerList = nullptr;
+            }
+            _message.clear();
+        }
+
+        void disconnect(const std::string &reason) {
+            Logger::getInstance().warn("WebSocket::disconnect: {}: {}", _url, reason);
+            cleanup();
+
+            // Requests already on the wire cannot be resumed on a new connection
+            std::map<std::string, Request> inflight;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                inflight.swap(_inflight);
+                _inflightOrder.clear();
+                for (const auto &[id, request] : inflight) {
+                    _pendingIds.erase(id);
+                }
+            }
+            for (auto &[id, request] : inflight) {
+                request.promise.set_value(resultJson(false, reason, ""));
+            }
+        }
+
+        void failOutbound(const std::string &reason) {
+            std::deque<Request> outbound;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                outbound.swap(_outbound);
+                for (const auto &request : outbound) {
+                    _pendingIds.erase(request.id);
+                }
+            }
+            for (auto &request : outbound) {
+                request.promise.set_value(resultJson(false, reason, ""));
+            }
+        }
+
+        void flushOutbound() {
+            while (true) {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (_outbound.empty()) {
+                    return;
+                }
+                Request request = std::move(_outbound.front());
+                _outbound.pop_front();
+                lock.unlock();
+
+                if (!sendFrame(request.payload, CURLWS_TEXT)) {
+                    lock.lock();
+                    _outbound.push_front(std::move(request));
+                    lock.unlock();
+                    disconnect("Failed to send message");
+                    return;
+                }
+
+                lock.lock();
+                _inflightOrder.push_back(request.id);
+                _inflight.emplace(request.id, std::move(request));
+            }
+        }
+
+        bool sendFrame(const std::string &data, unsigned int flags) {
+            std::size_t offset = 0;
+            while (true) {
+                std::size_t sent = 0;
+                CURLcode rc      = curl_ws_send(_curl, data.data() + offset, data.size() - offset, &sent, 0, flags);
+                if (rc == CURLE_OK) {
+                    offset += sent;
+                    if (offset >= data.size()) {
+                        return true;
+                    }
+                    if (sent > 0) {
+                        continue;
+                    }
+                } else if (rc != CURLE_AGAIN) {
+                    Logger::getInstance().error("WebSocket::sendFrame: {}", curl_easy_strerror(rc));
+                    return false;
+                }
+
+                if (!waitSocket(_socket, true, 1000)) {
+                    Logger::getInstance().error("WebSocket::sendFrame: Socket not writable");
+                    return false;
+                }
+            }
+        }
+
+        bool receive() {
+            char buffer[RECEIVE_CHUNK];
+            while (true) {
+                std::size_t received             = 0;
+                const struct curl_ws_frame *meta = nullptr;
+                CURLcode rc                      = curl_ws_recv(_curl, buffer, sizeof(buffer), &received, &meta);
+                if (rc == CURLE_AGAIN) {
+                    return true;
+                }
+                if (rc != CURLE_OK) {
+                    disconnect(curl_easy_strerror(rc));
+                    return false;
+                }
+
+                _lastActivity = Clock::now();
+                if (meta->flags & CURLWS_CLOSE) {
+                    disconnect("Closed by peer");
+                    return false;
+                }
+                if (meta->flags & (CURLWS_PING | CURLWS_PONG)) {
+                    // curl answers pings itself; either way the peer is alive
+                    continue;
+                }
+
+                _message.append(buffer, received);
+                if (meta->bytesleft == 0 && !(meta->flags & CURLWS_CONT)) {
+                    dispatch(_message);
+                    _message.clear();
+                }
+            }
+        }
+
+        void dispatch(const std::string &message) {
+            std::string id;
+            std::string type;
+            bool done = false;
+            try {
+                json j = json::parse(message);
+                if (j.is_object()) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    for (const char *key : {"request_id", "event_id", "id"}) {
+                        if (j.contains(key) && j[key].is_string() && _inflight.contains(j[key].get<std::string>())) {
+                            id = j[key].get<std::string>();
+                            break;
+                        }
+                    }
+                    if (j.contains("type") && j["type"].is_string()) {
+                        type = j["type"].get<std::string>();
+                    }
+                    done = type == "response.done" || type == "error" || (j.contains("done") && j["done"].is_boolean() && j["done"]);
+                }
+            } catch (const json::exception &) {
+                // Non-JSON frames are still forwarded as deltas
+            }
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (id.empty()) {
+                if (_inflightOrder.empty()) {
+                    Logger::getInstance().warn("WebSocket::dispatch: Dropping unrouted message from {}", _url);
+                    return;
+                }
+                id = _inflightOrder.front();
+            }
+
+            auto it = _inflight.find(id);
+            if (it == _inflight.end()) {
+                return;
+            }
+
+            DeltaCallback onDelta = it->second.onDelta;
+            std::optional<Request> finished;
+            if (done) {
+                finished.emplace(std::move(it->second));
+                _inflight.erase(it);
+                std::erase(_inflightOrder, id);
+                _pendingIds.erase(id);
+            }
+            lock.unlock();
+
+            if (onDelta) {
+                onDelta(message);
+            }
+            if (finished) {
+                bool ok = type != "error";
+                finished->promise.set_value(resultJson(ok, ok ? "" : message, message));
+            }
+        }
+
+        std::string _url;
+
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::vector<std::string> _headers;
+        std::deque<Request> _outbound;
+        std::map<std::string, Request> _inflight;
+        std::deque<std::string> _inflightOrder;
+        // Ids of every request not yet settled, whether still outbound or in flight
+        std::set<std::string> _pendingIds;
+        Clock::time_point _lastUse;
+        bool _reconnectRequested = false;
+        bool _stopping           = false;
+
+        // Empty multi handle used only for curl_multi_poll on the socket, which other threads can interrupt
+        CURLM *_multi = nullptr;
+
+        // Owned by the connection thread
+        CURL *_curl               = nullptr;
+        curl_slist *_headerList   = nullptr;
+        curl_socket_t _socket     = CURL_SOCKET_BAD;
+        Clock::time_point _lastActivity;
+        Clock::time_point _lastPing;
+        std::string _message;
+
+        std::thread _thread;
+    };
+
+    struct WebSocket::Registry {
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<Connection>> connections;
+    };
+
+    WebSocket::Registry &WebSocket::registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    std::shared_ptr<WebSocket::Connection> WebSocket::connectionFor(const std::string &url) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto &connection = r.connections[url];
+        if (!connection) {
+            connection = std::make_shared<Connection>(url);
+        }
+        return connection;
+    }
+
+    coco::future<std::string> WebSocket::sendAsync(const std::string &url, const std::string &headersJson, const std::string &requestId,
+                                                   const std::string &payload, DeltaCallback onDelta) {
+        auto promise = coco::promise<std::string>{};
+        auto future  = promise.get_future();
+
+        std::vector<std::string> headers;
+        try {
+            if (!headersJson.empty()) {
+                for (auto &[key, value] : json::parse(headersJson).items()) {
+                    if (value.is_string()) {
+                        headers.push_back(key + ": " + value.get<std::string>());
+                    }
+                }
+            }
+        } catch (const json::exception &e) {
+            Logger::getInstance().error("WebSocket::sendAsync: JSON parse error: {}", e.what());
+        }
+
+        auto connection = connectionFor(url);
+        connection->setHeaders(std::move(headers));
+        connection->enqueue({requestId, payload, std::move(onDelta), std::move(promise)});
+
+        return future;
+    }
+
+    void WebSocket::closeAll() {
+        std::map<std::string, std::shared_ptr<Connection>> connections;
+        {
+            auto &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            connections.swap(r.connections);
+        }
+        for (auto &[url, connection] : connections) {
+            connection->stop();
+        }
+    }
+
+} // namespace byoa
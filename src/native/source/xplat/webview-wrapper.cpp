@@ -1,16 +1,102 @@
 #include <saucer/smartview.hpp>
 #include <saucer/window.hpp>
+#include <nlohmann/json.hpp>
+#include <string_view>
+#include <type_traits>
 
-#include "app-controller.hpp"
+#include "attachments.hpp"
+#include "bridge-stats.hpp"
 #include "clipboard.hpp"
+#include "config-store.hpp"
+#include "endpoint-pool.hpp"
+#include "event-bus.hpp"
+#include "event-queue.hpp"
+#include "incremental.hpp"
+#include "llm.hpp"
 #include "logger.hpp"
 #include "network.hpp"
+#include "pipeline.hpp"
+#include "prompt-cache.hpp"
+#include "router.hpp"
+#include "shared-settings.hpp"
+#include "speculation.hpp"
 #include "vault.hpp"
 #include "webview-wrapper.hpp"
+#include "websocket.hpp"
 
 using namespace std;
 using namespace byoa;
 
+namespace {
+
+    // {key: value or null}
+    string valuesToJson(const Vault::Values &values) {
+        nlohmann::json result = nlohmann::json::object();
+        for (const auto &[key, value] : values) {
+            result[key] = value ? nlohmann::json(*value) : nlohmann::json(nullptr);
+        }
+        return result.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    }
+
+    // {key: string} object; non-string values are skipped
+    optional<map<string, string>> stringMap(const string &valuesJson) {
+        auto values = nlohmann::json::parse(valuesJson, nullptr, false);
+        if (!values.is_object()) {
+            return nullopt;
+        }
+        map<string, string> entries;
+        for (const auto &[key, value] : values.items()) {
+            if (value.is_string()) {
+                entries[key] = value.get<string>();
+            }
+        }
+        return entries;
+    }
+
+    // Bytes a bridge argument or result occupies: its length for strings, its size otherwise
+    template <typename T>
+    size_t payloadBytes(const T &value) {
+        if constexpr (is_convertible_v<const T &, string_view>) {
+            return string_view(value).size();
+        } else {
+            return sizeof(T);
+        }
+    }
+
+    // A handler with the same signature as @p handler's call operator, so saucer binds it the same way
+    template <typename Handler, typename Result, typename Class, typename... Args>
+    auto instrumented(BridgeStats::Function &stats, Handler handler, coco::task<Result> (Class::*)(Args...) const) {
+        return [&stats, handler = std::move(handler)](Args... args) -> coco::task<Result> {
+            auto started = stats.begin((payloadBytes(args) + ... + size_t{0}));
+            if constexpr (is_void_v<Result>) {
+                try {
+                    co_await handler(args...);
+                } catch (...) {
+                    stats.end(started, 0, true);
+                    throw;
+                }
+                stats.end(started, 0);
+            } else {
+                Result result{};
+                try {
+                    result = co_await handler(args...);
+                } catch (...) {
+                    stats.end(started, 0, true);
+                    throw;
+                }
+                stats.end(started, payloadBytes(result));
+                co_return result;
+            }
+        };
+    }
+
+} // namespace
+
+template <typename Handler>
+void WebviewWrapper::expose(const char *name, Handler handler) {
+    _webview->expose(name, instrumented(BridgeStats::function(name), std::move(handler), &Handler::operator()));
+}
+
 WebviewWrapper::WebviewWrapper(shared_ptr<saucer::window> window) {
     auto result = saucer::smartview<>::create({.window = window});
     if (result.has_value()) {
@@ -26,6 +112,22 @@ WebviewWrapper::WebviewWrapper(shared_ptr<saucer::window> window) {
         // even it was hidden earlier.
         _webview->set_dev_tools(true);
 #endif // DEBUG
+
+        // Fire-and-forget: nothing waits on the script's result, so no future is created per batch
+        _events   = make_unique<EventQueue>([this](string script) { _webview->execute(script); });
+        _endpoint = EventBus::attach([this](EventId id, string data) { _events->push(string(EventRegistry::name(id)), std::move(data)); });
+
+        // A reload starts a page with no listeners; hold its events until it reports the ones it has
+        _webview->on<saucer::webview::event::navigated>([this](const auto &) { EventBus::reset(_endpoint); });
+    }
+}
+
+WebviewWrapper::~WebviewWrapper() {
+    if (_endpoint) {
+        EventBus::detach(_endpoint);
+    }
+    if (_settingsSubscription) {
+        SharedSettings::unsubscribe(_settingsSubscription);
     }
 }
 
@@ -36,39 +138,120 @@ bool WebviewWrapper::init(const string &viewURL) {
     }
 
     // Expose clipboard functions
-    _webview->expose("clipboard_readText", []() -> coco::task<string> { co_return Clipboard::readText(); });
+    expose("clipboard_readText", []() -> coco::task<string> { co_return Clipboard::readText(); });
 
-    _webview->expose("clipboard_writeText", [](const string &text) -> coco::task<bool> {
+    expose("clipboard_writeText", [](const string &text) -> coco::task<bool> {
         bool success = Clipboard::writeText(text);
         co_return success;
     });
 
-    _webview->expose("clipboard_clear", []() -> coco::task<void> {
+    expose("clipboard_clear", []() -> coco::task<void> {
         Clipboard::clear();
         co_return;
     });
 
-    _webview->expose("vault_getData", [](const string &key) -> coco::task<string> {
-        auto data = Vault::getData(key);
-        co_return data.value_or("");
+    // Large clipboard payloads stay native; JS only gets a handle to reference in "bodyParts"
+    expose("attachment_readClipboardImage", []() -> coco::task<string> {
+        string image = Clipboard::readImage();
+        co_return image.empty() ? "" : Attachments::put("image/png", std::move(image));
     });
 
-    _webview->expose("vault_setData", [](const string &key, const string &value) -> coco::task<bool> {
-        bool success = Vault::storeData(key, value);
-        co_return success;
+    expose("attachment_release", [](const string &handle) -> coco::task<bool> { co_return Attachments::release(handle); });
+
+    // Credential store calls may block or prompt, so they run on the Vault worker
+    expose("vault_getData", [](const string &key) -> coco::task<string> { co_return co_await Vault::getDataAsync(key); });
+
+    // Writes are deferred and coalesced, and later reads already see them, but the promise only resolves once the
+    // store took the change: false means it was rejected (it stays pending, is retried and shows in vault_status)
+    expose("vault_setData", [](const string &key, const string &value) -> coco::task<bool> {
+        co_return co_await Vault::storeDataAsync(key, value);
     });
 
-    _webview->expose("vault_deleteData", [](const string &key) -> coco::task<bool> {
-        bool success = Vault::deleteData(key);
-        co_return success;
+    expose("vault_deleteData", [](const string &key) -> coco::task<bool> { co_return co_await Vault::deleteDataAsync(key); });
+
+    expose("vault_hasData", [](const string &key) -> coco::task<bool> { co_return co_await Vault::hasDataAsync(key); });
+
+    expose("vault_getMany", [](const string &keysJson) -> coco::task<string> {
+        auto keys = nlohmann::json::parse(keysJson, nullptr, false);
+        if (!keys.is_array()) {
+            co_return "{}";
+        }
+        vector<string> names;
+        for (const auto &key : keys) {
+            if (key.is_string()) {
+                names.push_back(key.get<string>());
+            }
+        }
+        co_return valuesToJson(co_await Vault::getManyAsync(names));
     });
 
-    _webview->expose("vault_hasData", [](const string &key) -> coco::task<bool> {
-        bool success = Vault::hasData(key);
-        co_return success;
+    expose("vault_setMany", [](const string &valuesJson) -> coco::task<bool> {
+        auto entries = stringMap(valuesJson);
+        if (!entries) {
+            co_return false;
+        }
+        co_return co_await Vault::setManyAsync(*entries);
+    });
+
+    expose("vault_workerStats", []() -> coco::task<string> { co_return Vault::workerStatsJson(); });
+
+    // Keys the store rejected, including API keys saved through config_* and settings_apply; changes arrive as "vault:status"
+    expose("vault_status", []() -> coco::task<string> { co_return Vault::statusJson(); });
+
+    // Non-secret settings; API keys inside llm_configs are kept in the vault by ConfigStore, so these
+    // run on the Vault worker as well, ordered after any queued vault operation
+    expose("config_getData", [](const string &key) -> coco::task<string> {
+        co_return co_await Vault::submit<string>({}, "ConfigStore::get", [key]() { return ConfigStore::get(key).value_or(""); });
     });
 
-    _webview->expose("network_fetch", [](const string &url, const string &options) -> coco::task<string> {
+    // Writes go through SharedSettings, so subscribed windows get the difference
+    expose("config_setData", [](const string &key, const string &value) -> coco::task<bool> {
+        co_return co_await Vault::submit<bool>({}, "SharedSettings::set", [key, value]() { return SharedSettings::set(key, value); });
+    });
+
+    expose("config_deleteData", [](const string &key) -> coco::task<bool> {
+        co_return co_await Vault::submit<bool>({}, "SharedSettings::remove", [key]() { return SharedSettings::remove(key); });
+    });
+
+    expose("config_hasData", [](const string &key) -> coco::task<bool> {
+        co_return co_await Vault::submit<bool>({}, "ConfigStore::get", [key]() { return ConfigStore::get(key).has_value(); });
+    });
+
+    expose("config_setMany", [](const string &valuesJson) -> coco::task<bool> {
+        auto entries = stringMap(valuesJson);
+        if (!entries) {
+            co_return false;
+        }
+        co_return co_await Vault::submit<bool>({}, "SharedSettings::set", [entries]() {
+            bool success = true;
+            for (const auto &[key, value] : *entries) {
+                success = SharedSettings::set(key, value) && success;
+            }
+            return success;
+        });
+    });
+
+    // Everything the frontend needs at startup in one round trip
+    expose("config_snapshot", []() -> coco::task<string> {
+        co_return co_await Vault::submit<string>({}, "ConfigStore::snapshot", []() { return valuesToJson(ConfigStore::snapshot()); });
+    });
+
+    // Subscribes this window to settings deltas ("settings:patch") and returns the document they apply to
+    expose("settings_subscribe", [this]() -> coco::task<string> {
+        if (!_settingsSubscription) {
+            _settingsSubscription = SharedSettings::subscribe([this](const string &delta) { triggerEvent(events::SettingsPatch{delta}); });
+        }
+        co_return co_await Vault::submit<string>({}, "SharedSettings::snapshot", []() { return SharedSettings::snapshotJson(); });
+    });
+
+    expose("settings_apply", [this](const string &patchJson, uint64_t baseVersion) -> coco::task<string> {
+        auto origin = _settingsSubscription;
+        co_return co_await Vault::submit<string>({}, "SharedSettings::apply", [patchJson, baseVersion, origin]() {
+            return SharedSettings::applyJson(patchJson, baseVersion, origin);
+        });
+    });
+
+    expose("network_fetch", [](const string &url, const string &options) -> coco::task<string> {
         // co_await the future directly - the function returns a temporary (rvalue) that can be awaited
         // This suspends the coroutine without blocking the thread
         // The coroutine will automatically resume when the background thread completes
@@ -76,12 +259,120 @@ bool WebviewWrapper::init(const string &viewURL) {
         co_return response;
     });
 
-    _webview->expose("event_trigger", [this](const string &eventName, const string &data) -> coco::task<void> {
-        AppController::getInstance().getAssistantWindow()->sendEventToWebview(eventName, data);
-        AppController::getInstance().getMainWindow()->sendEventToWebview(eventName, data);
+    expose("llm_invokeIncremental",
+           [](const string &configJson, const string &actionKey, const string &systemContent,
+              const string &userContent) -> coco::task<string> {
+               // Only paragraphs changed since this action's last run are sent to the provider
+               string result = co_await Incremental::invokeAsync(configJson, actionKey, systemContent, userContent);
+               co_return result;
+           });
+
+    expose("llm_complete",
+           [](const string &configJson, const string &systemContent, const string &userContent) -> coco::task<string> {
+               // Natively sent so pooled configs are balanced across their endpoints
+               string result = co_await LLM::completeAsync(configJson, systemContent, userContent);
+               co_return result;
+           });
+
+    expose("llm_invokeRouted",
+           [](const string &configsJson, const string &policyJson, const string &systemContent,
+              const string &userContent) -> coco::task<string> {
+               // The model is picked per input from observed latency; the reason comes back with the result
+               string result = co_await Router::invokeAsync(configsJson, policyJson, systemContent, userContent);
+               co_return result;
+           });
+
+    expose("speculation_claim",
+           [](const string &actionId, const string &configJson, const string &systemContent, const string &userContent,
+              bool recordUsage) -> coco::task<string> {
+               // Attaches to the request started when the popup opened, if it guessed this one
+               string result = co_await Speculation::claimAsync(actionId, configJson, systemContent, userContent, recordUsage);
+               co_return result;
+           });
+
+    expose("speculation_stats", []() -> coco::task<string> { co_return Speculation::statsJson(); });
+
+    expose("llm_poolStats", []() -> coco::task<string> { co_return EndpointPool::statsJson(); });
+
+    expose("llm_promptCacheStats", []() -> coco::task<string> { co_return PromptCache::statsJson(); });
+
+    expose("ws_send",
+           [this](const string &url, const string &headersJson, const string &requestId,
+                  const string &payload) -> coco::task<string> {
+               // Every provider message is forwarded to this webview as it arrives
+               auto onDelta = [this, requestId](const string &message) { triggerEvent(events::WsDelta{requestId, message}); };
+               string result = co_await WebSocket::sendAsync(url, headersJson, requestId, payload, std::move(onDelta));
+               co_return result;
+           });
+
+    expose("pipeline_run",
+           [this](const string &configJson, const string &stagesJson, const string &input, int fromStage,
+                  const string &runId) -> coco::task<string> {
+               // Stage output is streamed to this webview while later stages are already consuming it
+               auto onProgress = [this, runId](size_t stage, const string &delta, bool done) {
+                   triggerEvent(events::PipelineProgress{runId, stage, delta, done});
+               };
+               string result = co_await Pipeline::runAsync(configJson, stagesJson, input, fromStage, std::move(onProgress));
+               co_return result;
+           });
+
+    expose("event_queueStats", [this]() -> coco::task<string> { co_return _events->statsJson(); });
+
+    // The page reports which events it has listeners for, so the bus only routes those here
+    expose("event_subscribe", [this](const string &eventName, bool listening) -> coco::task<bool> {
+        auto id = EventRegistry::find(eventName);
+        if (!id) {
+            Logger::getInstance().warn("WebviewWrapper::event_subscribe: Unknown event {}", eventName);
+            co_return false;
+        }
+        EventBus::subscribe(_endpoint, *id, listening);
+        co_return true;
+    });
+
+    // Sent once the page has started, with every event it listens for; held events are delivered then
+    expose("event_resubscribe", [this](const string &eventNamesJson) -> coco::task<bool> {
+        auto names = nlohmann::json::parse(eventNamesJson, nullptr, false);
+        if (!names.is_array()) {
+            Logger::getInstance().warn("WebviewWrapper::event_resubscribe: Expected an array of event names");
+            co_return false;
+        }
+        vector<EventId> ids;
+        for (const auto &name : names) {
+            auto id = name.is_string() ? EventRegistry::find(name.get<string>()) : nullopt;
+            if (!id) {
+                Logger::getInstance().warn("WebviewWrapper::event_resubscribe: Unknown event {}", name.dump());
+                continue;
+            }
+            ids.push_back(*id);
+        }
+        EventBus::resubscribe(_endpoint, ids);
+        co_return true;
+    });
+
+    expose("event_trigger", [](const string &eventName, const string &data) -> coco::task<void> {
+        auto id = EventRegistry::find(eventName);
+        if (!id) {
+            Logger::getInstance().warn("WebviewWrapper::event_trigger: Unknown event {}", eventName);
+            co_return;
+        }
+        if (!EventRegistry::raisedByWebview(*id)) {
+            Logger::getInstance().warn("WebviewWrapper::event_trigger: {} is raised natively only", eventName);
+            co_return;
+        }
+        // Only the shape is checked here; the fields are typed by EventMap on the TypeScript side
+        if (!nlohmann::json::parse(data, nullptr, false).is_object()) {
+            Logger::getInstance().warn("WebviewWrapper::event_trigger: {} payload is not a JSON object", eventName);
+            co_return;
+        }
+        EventBus::publish(*id, data);
         co_return;
     });
 
+    expose("event_busStats", []() -> coco::task<string> { co_return EventBus::statsJson(); });
+
+    // Per-function calls, in-flight count, latency and payload sizes of every bridge above
+    expose("debug_bridgeStats", []() -> coco::task<string> { co_return BridgeStats::statsJson(); });
+
     if (!viewURL.empty()) {
         // Load local HTML content
         _webview->set_url(viewURL);
@@ -93,47 +384,3 @@ bool WebviewWrapper::init(const string &viewURL) {
 
     return true;
 }
-
-void WebviewWrapper::triggerEvent(const string &eventName, const string &data) {
-    if (!_webview.has_value()) {
-        Logger::getInstance().warn("WebviewWrapper::triggerEvent: Webview not available");
-        return;
-    }
-
-    Logger::getInstance().info("AppController::triggerEvent: Calling native callback with event: {}", eventName);
-
-    // Escape the strings for JavaScript execution
-    auto escapeString = [](const string &str) {
-        string result;
-        for (char c : str) {
-            if (c == '"' || c == '\'') {
-                result += "\\";
-                result += c;
-            } else if (c == '\\') {
-                result += "\\\\";
-            } else if (c == '\n') {
-                result += "\\n";
-            } else if (c == '\r') {
-                result += "\\r";
-            } else if (c == '\t') {
-                result += "\\t";
-            } else {
-                result += c;
-            }
-        }
-        return result;
-    };
-
-    string escapedEventName = escapeString(eventName);
-    string escapedData      = escapeString(data);
-
-    try {
-        // Use saucer's format string with placeholders - don't add quotes since saucer adds them
-        auto result = _webview->evaluate<string>(
-            "(function() {{ if (window.__nativeCallback) {{ window.__nativeCallback({}, {}); }} return ''; }})()", escapedEventName,
-            escapedData);
-        // We don't need to wait for the result since it's fire-and-forget
-    } catch (const exception &e) {
-        Logger::getInstance().error("AppController::triggerEvent: Failed to call JavaScript callback: {}", e.what());
-    }
-}
@@ -0,0 +1,133 @@
+// Published test vectors for the in-tree primitives behind the encrypted vault file: SHA-256
+// (FIPS 180-4 examples), HMAC-SHA-256 (RFC 4231), PBKDF2-HMAC-SHA256 (RFC 7914 section 11; the
+// RFC 6070 vectors are for SHA-1) and the ChaCha20-Poly1305 AEAD (RFC 8439 section 2.8.2).
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "crypto.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, const std::string &what) {
+        std::printf("%s %s\n", condition ? "ok  " : "FAIL", what.c_str());
+        if (!condition) {
+            failures++;
+        }
+    }
+
+    std::string hex(std::string_view bytes) {
+        static constexpr char DIGITS[] = "0123456789abcdef";
+        std::string out;
+        for (unsigned char c : bytes) {
+            out += DIGITS[c >> 4];
+            out += DIGITS[c & 0xf];
+        }
+        return out;
+    }
+
+    template <std::size_t N> std::string hex(const std::array<uint8_t, N> &bytes) {
+        return hex(std::string_view(reinterpret_cast<const char *>(bytes.data()), N));
+    }
+
+    std::string unhex(std::string_view digits) {
+        std::string out;
+        for (std::size_t i = 0; i + 1 < digits.size(); i += 2) {
+            out += static_cast<char>(std::stoi(std::string(digits.substr(i, 2)), nullptr, 16));
+        }
+        return out;
+    }
+
+    void sha256() {
+        check(hex(byoa::Crypto::sha256("")) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+              "SHA-256 of the empty string");
+        check(hex(byoa::Crypto::sha256("abc")) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "SHA-256 of \"abc\"");
+        check(hex(byoa::Crypto::sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) ==
+                  "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+              "SHA-256 of the two-block message");
+    }
+
+    void hmacSha256() {
+        struct Case {
+            const char *name;
+            std::string key;
+            std::string data;
+            const char *expected;
+        };
+        const Case cases[] = {
+            {"RFC 4231 test case 1", std::string(20, '\x0b'), "Hi There",
+             "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"},
+            {"RFC 4231 test case 2", "Jefe", "what do ya want for nothing?",
+             "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"},
+            {"RFC 4231 test case 3", std::string(20, '\xaa'), std::string(50, '\xdd'),
+             "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe"},
+            {"RFC 4231 test case 6 (key longer than a block)", std::string(131, '\xaa'),
+             "Test Using Larger Than Block-Size Key - Hash Key First", "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"},
+            {"RFC 4231 test case 7 (key and data longer than a block)", std::string(131, '\xaa'),
+             "This is a test using a larger than block-size key and a larger than block-size data. The key needs to be hashed before "
+             "being used by the HMAC algorithm.",
+             "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2"},
+        };
+        for (const auto &c : cases) {
+            check(hex(byoa::Crypto::hmacSha256(c.key, c.data)) == c.expected, std::string("HMAC-SHA-256 ") + c.name);
+        }
+    }
+
+    void pbkdf2() {
+        // The published outputs are 64 bytes; pbkdf2() returns the first block
+        check(hex(byoa::Crypto::pbkdf2("passwd", "salt", 1)) == "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc",
+              "PBKDF2-HMAC-SHA256, 1 iteration");
+        check(hex(byoa::Crypto::pbkdf2("Password", "NaCl", 80000)) == "4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56",
+              "PBKDF2-HMAC-SHA256, 80000 iterations");
+    }
+
+    void chacha20Poly1305() {
+        byoa::Crypto::Key key;
+        for (std::size_t i = 0; i < key.size(); i++) {
+            key[i] = static_cast<uint8_t>(0x80 + i);
+        }
+        const byoa::Crypto::Nonce nonce = {0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47};
+        const std::string aad           = unhex("50515253c0c1c2c3c4c5c6c7");
+        const std::string plaintext =
+            "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+        const std::string expected = "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b"
+                                     "1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+                                     "3ff4def08e4b7a9de576d26586cec64b6116"
+                                     "1ae10b594f09e26a7e902ecbd0600691";
+
+        auto sealed = byoa::Crypto::seal(key, nonce, aad, plaintext);
+        check(hex(sealed) == expected, "ChaCha20-Poly1305 RFC 8439 2.8.2 ciphertext and tag");
+
+        auto opened = byoa::Crypto::open(key, nonce, aad, sealed);
+        check(opened && *opened == plaintext, "ChaCha20-Poly1305 opens its own output");
+
+        auto tampered = sealed;
+        tampered[0] ^= 1;
+        check(!byoa::Crypto::open(key, nonce, aad, tampered), "ChaCha20-Poly1305 rejects a modified ciphertext");
+
+        auto otherAad = aad;
+        otherAad.back() ^= 1;
+        check(!byoa::Crypto::open(key, nonce, otherAad, sealed), "ChaCha20-Poly1305 rejects modified associated data");
+
+        check(!byoa::Crypto::open(key, nonce, aad, sealed.substr(0, byoa::Crypto::TAG_SIZE - 1)),
+              "ChaCha20-Poly1305 rejects a short input");
+    }
+
+} // namespace
+
+int main() {
+    sha256();
+    hmacSha256();
+    pbkdf2();
+    chacha20Poly1305();
+
+    if (failures) {
+        std::printf("\n%d checks failed\n", failures);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,364 @@
+// WebSocket transport against an in-process stand-in server: one listening socket on 127.0.0.1,
+// the RFC 6455 handshake and unfragmented frames, enough to exercise routing, duplicate request
+// ids and round-trip latency without a provider.
+//
+// The stand-in answers a text frame {"id": X} with a delta and a "response.done" for X. With
+// "hold": true it does not answer; {"id": X, "release": Y} then finishes the held Y and X.
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "base64.hpp"
+#include "websocket.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+#ifdef _WIN32
+    using Socket             = SOCKET;
+    constexpr Socket INVALID = INVALID_SOCKET;
+    void closeSocket(Socket socket) {
+        closesocket(socket);
+    }
+#else
+    using Socket             = int;
+    constexpr Socket INVALID = -1;
+    void closeSocket(Socket socket) {
+        close(socket);
+    }
+#endif
+
+    int failures = 0;
+
+    void check(bool condition, const std::string &what) {
+        std::printf("%s %s\n", condition ? "ok  " : "FAIL", what.c_str());
+        if (!condition) {
+            failures++;
+        }
+    }
+
+    // SHA-1 for the handshake's Sec-WebSocket-Accept only
+    std::string sha1(const std::string &input) {
+        uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        std::string data = input;
+        uint64_t bits    = static_cast<uint64_t>(input.size()) * 8;
+        data += static_cast<char>(0x80);
+        while (data.size() % 64 != 56) {
+            data += '\0';
+        }
+        for (int i = 7; i >= 0; i--) {
+            data += static_cast<char>((bits >> (i * 8)) & 0xFF);
+        }
+
+        auto rotl = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+        for (std::size_t chunk = 0; chunk < data.size(); chunk += 64) {
+            uint32_t w[80];
+            for (int i = 0; i < 16; i++) {
+                const auto *p = reinterpret_cast<const unsigned char *>(data.data() + chunk + i * 4);
+                w[i]          = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+            }
+            for (int i = 16; i < 80; i++) {
+                w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+            }
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+            for (int i = 0; i < 80; i++) {
+                uint32_t f, k;
+                if (i < 20) {
+                    f = (b & c) | (~b & d), k = 0x5A827999;
+                } else if (i < 40) {
+                    f = b ^ c ^ d, k = 0x6ED9EBA1;
+                } else if (i < 60) {
+                    f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+                } else {
+                    f = b ^ c ^ d, k = 0xCA62C1D6;
+                }
+                uint32_t t = rotl(a, 5) + f + e + k + w[i];
+                e = d, d = c, c = rotl(b, 30), b = a, a = t;
+            }
+            h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e;
+        }
+
+        std::string digest;
+        for (uint32_t word : h) {
+            for (int i = 3; i >= 0; i--) {
+                digest += static_cast<char>((word >> (i * 8)) & 0xFF);
+            }
+        }
+        return digest;
+    }
+
+    std::string base64(const std::string &input) {
+        std::string out(byoa::Base64::encodedLength(input.size()), '\0');
+        byoa::Base64::encode(out.data(), reinterpret_cast<const unsigned char *>(input.data()), input.size());
+        return out;
+    }
+
+    class StandInServer {
+      public:
+        StandInServer() {
+            _listener = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family      = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port        = 0;
+            bind(_listener, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+            listen(_listener, 4);
+
+            socklen_t length = sizeof(address);
+            getsockname(_listener, reinterpret_cast<sockaddr *>(&address), &length);
+            _port   = ntohs(address.sin_port);
+            _thread = std::thread([this]() { run(); });
+        }
+
+        ~StandInServer() {
+            _stopping = true;
+#ifdef _WIN32
+            shutdown(_client, SD_BOTH);
+#else
+            shutdown(_client, SHUT_RDWR);
+#endif
+            // A throwaway connection unblocks accept() so the server thread sees _stopping
+            Socket wake = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family      = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port        = htons(static_cast<uint16_t>(_port));
+            connect(wake, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+            _thread.join();
+            closeSocket(wake);
+            closeSocket(_listener);
+        }
+
+        std::string url() const {
+            return "ws://127.0.0.1:" + std::to_string(_port) + "/v1/realtime";
+        }
+
+        int connections() const {
+            return _connections;
+        }
+
+      private:
+        void run() {
+            while (!_stopping) {
+                Socket client = accept(_listener, nullptr, nullptr);
+                if (client == INVALID) {
+                    return;
+                }
+                if (_stopping) {
+                    closeSocket(client);
+                    return;
+                }
+                _client = client;
+                _connections++;
+                if (handshake()) {
+                    serve();
+                }
+                _client = INVALID;
+                closeSocket(client);
+            }
+        }
+
+        bool readExactly(char *out, std::size_t length) {
+            while (length > 0) {
+                int received = recv(_client, out, static_cast<int>(length), 0);
+                if (received <= 0) {
+                    return false;
+                }
+                out += received;
+                length -= received;
+            }
+            return true;
+        }
+
+        bool handshake() {
+            std::string request;
+            char c;
+            while (request.find("\r\n\r\n") == std::string::npos) {
+                if (!readExactly(&c, 1)) {
+                    return false;
+                }
+                request += c;
+            }
+
+            // Header names are case-insensitive
+            std::string lower = request;
+            for (char &ch : lower) {
+                ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+            }
+            const std::string header = "sec-websocket-key:";
+            auto start               = lower.find(header);
+            if (start == std::string::npos) {
+                return false;
+            }
+            start           = request.find_first_not_of(' ', start + header.size());
+            std::string key = request.substr(start, request.find("\r\n", start) - start);
+
+            std::string accept   = base64(sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+            std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                   "Sec-WebSocket-Accept: " +
+                                   accept + "\r\n\r\n";
+            return send(_client, response.data(), static_cast<int>(response.size()), 0) == static_cast<int>(response.size());
+        }
+
+        void sendFrame(int opcode, const std::string &payload) {
+            std::string frame;
+            frame += static_cast<char>(0x80 | opcode);
+            if (payload.size() < 126) {
+                frame += static_cast<char>(payload.size());
+            } else {
+                frame += static_cast<char>(126);
+                frame += static_cast<char>((payload.size() >> 8) & 0xFF);
+                frame += static_cast<char>(payload.size() & 0xFF);
+            }
+            frame += payload;
+            send(_client, frame.data(), static_cast<int>(frame.size()), 0);
+        }
+
+        void sendDone(const std::string &id) {
+            sendFrame(0x1, json{{"request_id", id}, {"type", "response.done"}}.dump());
+        }
+
+        void serve() {
+            std::vector<std::string> held;
+            while (!_stopping) {
+                unsigned char head[2];
+                if (!readExactly(reinterpret_cast<char *>(head), 2)) {
+                    return;
+                }
+                int opcode            = head[0] & 0x0F;
+                uint64_t length       = head[1] & 0x7F;
+                unsigned char mask[4] = {0, 0, 0, 0};
+                if (length >= 126) {
+                    unsigned char extended[8];
+                    std::size_t bytes = length == 126 ? 2 : 8;
+                    if (!readExactly(reinterpret_cast<char *>(extended), bytes)) {
+                        return;
+                    }
+                    length = 0;
+                    for (std::size_t i = 0; i < bytes; i++) {
+                        length = (length << 8) | extended[i];
+                    }
+                }
+                if ((head[1] & 0x80) && !readExactly(reinterpret_cast<char *>(mask), 4)) {
+                    return;
+                }
+                std::string payload(length, '\0');
+                if (length > 0 && !readExactly(payload.data(), length)) {
+                    return;
+                }
+                for (std::size_t i = 0; i < payload.size(); i++) {
+                    payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+                }
+
+                if (opcode == 0x8) {
+                    sendFrame(0x8, "");
+                    return;
+                }
+                if (opcode == 0x9) {
+                    sendFrame(0xA, payload);
+                    continue;
+                }
+                if (opcode != 0x1) {
+                    continue;
+                }
+
+                json message   = json::parse(payload, nullptr, false);
+                std::string id = message.value("id", "");
+                if (message.value("hold", false)) {
+                    held.push_back(id);
+                    continue;
+                }
+                if (message.contains("release")) {
+                    sendDone(message["release"].get<std::string>());
+                } else {
+                    sendFrame(0x1, json{{"request_id", id}, {"type", "response.delta"}, {"delta", "stand-in"}}.dump());
+                }
+                sendDone(id);
+            }
+        }
+
+        Socket _listener = INVALID;
+        std::atomic<Socket> _client{INVALID};
+        std::atomic<bool> _stopping{false};
+        std::atomic<int> _connections{0};
+        int _port = 0;
+        std::thread _thread;
+    };
+
+    json request(const StandInServer &server, const std::string &id, const json &payload, int *deltas = nullptr) {
+        auto future = byoa::WebSocket::sendAsync(server.url(), "{}", id, payload.dump(), [deltas](const std::string &) {
+            if (deltas) {
+                (*deltas)++;
+            }
+        });
+        return json::parse(future.get());
+    }
+
+} // namespace
+
+int main() {
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+    {
+        StandInServer server;
+
+        int deltas    = 0;
+        json response = request(server, "first", {{"id", "first"}}, &deltas);
+        check(response["ok"] == true, "request completes on response.done");
+        check(deltas == 2, "every message routed to the request reaches onDelta");
+
+        // A second request with a pending id must not replace the first one's promise
+        auto held = byoa::WebSocket::sendAsync(server.url(), "{}", "dup", json{{"id", "dup"}, {"hold", true}}.dump(), nullptr);
+        json duplicate = request(server, "dup", {{"id", "dup"}});
+        check(duplicate["ok"] == false, "duplicate pending id is rejected");
+        check(duplicate["error"].get<std::string>().find("already in use") != std::string::npos, "rejection names the reused id");
+
+        json release = request(server, "release", {{"id", "release"}, {"release", "dup"}});
+        check(release["ok"] == true, "release request completes");
+        check(json::parse(held.get())["ok"] == true, "held request still completes after the duplicate was rejected");
+
+        json reused = request(server, "dup", {{"id", "dup"}});
+        check(reused["ok"] == true, "id can be reused once the earlier request settled");
+
+        // New requests wake the connection thread instead of waiting out a poll interval
+        constexpr int ROUND_TRIPS = 200;
+        auto started              = std::chrono::steady_clock::now();
+        bool allOk                = true;
+        for (int i = 0; i < ROUND_TRIPS; i++) {
+            std::string id = "rt" + std::to_string(i);
+            allOk          = allOk && request(server, id, {{"id", id}})["ok"] == true;
+        }
+        double meanMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count() / ROUND_TRIPS;
+        std::printf("     mean round trip over %d requests: %.3f ms\n", ROUND_TRIPS, meanMs);
+        check(allOk, "sequential round trips complete");
+        check(server.connections() == 1, "requests share one connection");
+
+        byoa::WebSocket::closeAll();
+    }
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return failures == 0 ? 0 : 1;
+}
@@ -1,10 +1,11 @@
 import { useState, useEffect } from 'react';
 import { BrowserRouter as Router, useSearchParams } from 'react-router-dom';
-import { ConfigProvider, theme } from 'antd';
+import { ConfigProvider, message, theme } from 'antd';
 import { AssistantPopup } from './components/assistant-popup';
 import { SettingsDialog } from './components/settings-dialog';
 import { ClipboardUtils } from './utils/clipboard';
-import { VaultUtils } from './utils/vault';
+import { VaultStatus, VaultUtils } from './utils/vault';
+import { sharedSettings } from './utils/settings';
 import { events } from './utils/events';
 
 export type ThemeMode =
@@ -21,9 +22,19 @@ export interface LLMConfig {
     id: string;
     name: string;
     modelName: string;
+    // "local:<path to .gguf>" runs a small model in-process instead of calling a provider
     baseURL: string;
     apiKey: string;
     enabled: boolean;
+    // Unix domain socket of a local server (Ollama, llama.cpp); baseURL then only supplies the path
+    socketPath?: string;
+    // Further (endpoint, key) pairs for the same model, balanced natively
+    pool?: { baseURL: string; apiKey: string; socketPath?: string }[];
+    poolPolicy?: 'round-robin' | 'least-outstanding' | 'ewma-latency';
+    // Context window in tokens, lets the router skip models an input would not fit
+    contextTokens?: number;
+    // Prompt cache markers; guessed from baseURL when unset
+    promptCache?: 'off' | 'anthropic' | 'openai';
 }
 
 export interface Action {
@@ -31,11 +42,35 @@ export interface Action {
     label: string;
     prompt: string;
     enabled: boolean;
+    // Paragraphs can be processed independently, so re-runs only resend what changed
+    incremental?: boolean;
+    // Ids of actions run in sequence, each on the previous one's output
+    pipeline?: string[];
+    // With "Auto" selected, pick the model natively per input instead of the first enabled one
+    routing?: { models?: string[]; latencyTargetMs?: number };
+}
+
+// Tell the user when API keys can't be saved, rather than have them vanish at the next launch
+function reportVaultStatus(status: VaultStatus | null) {
+    const errors = Object.values(status?.failed ?? {});
+    if (status?.unavailable) {
+        message.error(
+            `The credential store can't be used, API keys are not saved: ${status.unavailable}`,
+            8,
+        );
+    } else if (errors.length > 0) {
+        message.error(
+            `API keys could not be saved to the credential store (${errors[0]}). ` +
+                'They are kept until the app quits and saving is retried.',
+            8,
+        );
+    }
 }
 
 function AppContent() {
     const [searchParams] = useSearchParams();
     const [clipboardContent, setClipboardContent] = useState('');
+    const [clipboardImage, setClipboardImage] = useState('');
     const [themeMode, setThemeMode] = useState<ThemeMode>('auto');
     const [selectedLLM, setSelectedLLM] = useState<'auto' | 'all' | string>('auto');
     const [llmConfigs, setLLMConfigs] = useState<LLMConfig[]>([]);
@@ -43,127 +78,87 @@ function AppContent() {
 
     const workflow = searchParams.get('workflow');
 
-    // Load LLM configurations and actions from vault on initialization
+    // Load LLM configurations and actions from the config store on initialization
     useEffect(() => {
-        const loadConfigs = async () => {
+        // One native round trip for everything the settings need
+        const loadSettings = async () => {
             try {
-                const configs = await VaultUtils.loadLLMConfigs();
-                setLLMConfigs(configs);
-
-                // Log the source of configurations for debugging
-                const hasVaultConfigs = await VaultUtils.hasLLMConfigs();
-                if (hasVaultConfigs) {
-                    console.log('Loaded LLM configurations from vault');
-                } else {
-                    console.log('Using default LLM configurations (vault is empty)');
+                // The shared document also subscribes this window to changes made in the other one
+                const shared = await sharedSettings.load();
+                const snapshot = shared
+                    ? VaultUtils.fromDocument(shared)
+                    : await VaultUtils.loadAll();
+                setLLMConfigs(snapshot.llmConfigs);
+                setActions(snapshot.actions);
+                setThemeMode(snapshot.theme);
+
+                console.log(
+                    'Loaded from the config store:',
+                    snapshot.hasLLMConfigs ? 'LLM configs' : 'default LLM configs,',
+                    snapshot.hasActions ? 'actions' : 'default actions,',
+                    snapshot.hasTheme ? `theme ${snapshot.theme}` : 'default theme',
+                );
+
+                // If no actions in the config store, save the default ones
+                if (!snapshot.hasActions && snapshot.actions.length > 0) {
+                    console.log('Saving default actions to the config store...');
+                    await VaultUtils.saveActions(snapshot.actions);
                 }
             } catch (error) {
-                console.error('Failed to load LLM configs:', error);
+                console.error('Failed to load from the config store:', error);
             }
         };
 
-        const loadActions = async () => {
-            try {
-                const hasVaultActions = await VaultUtils.hasActions();
-                const loadedActions = await VaultUtils.loadActions();
-
-                console.log('Loaded actions:', loadedActions.length, 'actions');
-                setActions(loadedActions);
-
-                // If no actions in vault, save the default ones
-                if (!hasVaultActions && loadedActions.length > 0) {
-                    console.log('Saving default actions to vault...');
-                    await VaultUtils.saveActions(loadedActions);
-                }
-
-                if (hasVaultActions) {
-                    console.log('Loaded actions from vault');
-                } else {
-                    console.log('Using default actions (vault is empty)');
-                }
-            } catch (error) {
-                console.error('Failed to load actions:', error);
-            }
-        };
-
-        const loadTheme = async () => {
-            try {
-                const savedTheme = await VaultUtils.loadTheme();
-                setThemeMode(savedTheme);
-
-                const hasVaultTheme = await VaultUtils.hasTheme();
-                if (hasVaultTheme) {
-                    console.log('Loaded theme from vault:', savedTheme);
-                } else {
-                    console.log('Using default theme (vault is empty)');
-                }
-            } catch (error) {
-                console.error('Failed to load theme:', error);
-            }
-        };
-
-        loadConfigs();
-        loadActions();
-        loadTheme();
+        loadSettings();
     }, []);
 
     useEffect(() => {
         // Initialize events system
         events.initialize();
 
-        // Set up native callback for clipboard changes and events
+        // Events from native code and from the other webview
         window.__nativeCallback = (eventName: string, data: string) => {
-            // Handle clipboard focus changes
-            if (eventName === 'on-focus-change' && data === 'true') {
-                ClipboardUtils.readData().then(data => {
-                    if (data && data[0] && data[0].type === 'text') {
-                        setClipboardContent(data[0].data as string);
-                    }
-                });
-            }
-
-            // Handle events from other webviews
             events.handleNativeEvent(eventName, data);
         };
 
-        // Listen for settings changes from other webviews
-        const unsubscribeTheme = events.on('settings:theme-changed', async data => {
-            console.log('Theme changed, updating:', data.theme);
-            setThemeMode(data.theme);
-
-            // Save theme to vault
-            try {
-                await VaultUtils.saveTheme(data.theme);
-            } catch (error) {
-                console.error('Failed to save theme to vault:', error);
+        // Pick up what was copied while the window was away
+        const unsubscribeFocus = events.on('app:focus-changed', data => {
+            if (!data.focused) {
+                return;
             }
+            ClipboardUtils.readData().then(data => {
+                if (data && data[0] && data[0].type === 'text') {
+                    setClipboardContent(data[0].data as string);
+                    setClipboardImage('');
+                } else if (data && data[0] && data[0].type === 'image') {
+                    // Only native reads produce image handles; browser blobs are not sent
+                    if (typeof data[0].data === 'string') {
+                        setClipboardImage(data[0].data);
+                        setClipboardContent('');
+                    }
+                }
+            });
         });
 
-        const unsubscribeLLMConfigs = events.on('settings:llm-configs-changed', async () => {
-            console.log('LLM configs changed, refreshing from vault');
-            try {
-                const configs = await VaultUtils.loadLLMConfigs();
-                setLLMConfigs(configs);
-            } catch (error) {
-                console.error('Failed to refresh LLM configs:', error);
-            }
+        // Settings changed in the other window arrive as deltas to the shared document
+        const unsubscribeSettings = sharedSettings.onChange(shared => {
+            const snapshot = VaultUtils.fromDocument(shared);
+            setLLMConfigs(snapshot.llmConfigs);
+            setActions(snapshot.actions);
+            setThemeMode(snapshot.theme);
         });
 
-        const unsubscribeActions = events.on('settings:actions-changed', async () => {
-            console.log('Actions changed, refreshing from vault');
-            try {
-                const loadedActions = await VaultUtils.loadActions();
-                setActions(loadedActions);
-            } catch (error) {
-                console.error('Failed to refresh actions:', error);
-            }
-        });
+        // API keys reach the credential store in the background; report the ones it rejects
+        const unsubscribeVault = events.on('vault:status', data =>
+            reportVaultStatus(data as unknown as VaultStatus),
+        );
+        VaultUtils.loadStatus().then(reportVaultStatus);
 
         // Cleanup listeners on unmount
         return () => {
-            unsubscribeTheme();
-            unsubscribeLLMConfigs();
-            unsubscribeActions();
+            unsubscribeFocus();
+            unsubscribeSettings();
+            unsubscribeVault();
         };
     }, []);
 
@@ -203,7 +198,15 @@ function AppContent() {
     const handleLLMConfigsChange = async (newConfigs: LLMConfig[]) => {
         setLLMConfigs(newConfigs);
         try {
-            await VaultUtils.saveLLMConfigs(newConfigs);
+            if (!(await VaultUtils.saveLLMConfigs(newConfigs))) {
+                // Configs are refused as a whole when the credential store can't take their keys
+                const status = await VaultUtils.loadStatus();
+                message.error(
+                    status?.unavailable
+                        ? `Failed to save LLM configurations: ${status.unavailable}`
+                        : 'Failed to save LLM configurations',
+                );
+            }
         } catch (error) {
             console.error('Failed to save LLM configs to vault:', error);
         }
@@ -213,12 +216,26 @@ function AppContent() {
     const handleActionsChange = async (newActions: Action[]) => {
         setActions(newActions);
         try {
-            await VaultUtils.saveActions(newActions);
+            if (!(await VaultUtils.saveActions(newActions))) {
+                message.error('Failed to save actions');
+            }
         } catch (error) {
             console.error('Failed to save actions to vault:', error);
         }
     };
 
+    // Handle theme changes and save to the config store
+    const handleThemeChange = async (newTheme: ThemeMode) => {
+        setThemeMode(newTheme);
+        try {
+            if (!(await VaultUtils.saveTheme(newTheme))) {
+                message.error('Failed to save the theme');
+            }
+        } catch (error) {
+            console.error('Failed to save theme to the config store:', error);
+        }
+    };
+
     const enabledLLMs = llmConfigs.filter(llm => llm.enabled);
 
     const isDark =
@@ -244,6 +261,7 @@ function AppContent() {
                 {workflow === 'assistant' ? (
                     <AssistantPopup
                         clipboardContent={clipboardContent}
+                        clipboardImage={clipboardImage}
                         onClose={() => {
                             // Close handler - could be implemented if needed
                         }}
@@ -263,7 +281,7 @@ function AppContent() {
                         actions={actions}
                         onActionsChange={handleActionsChange}
                         theme={themeMode}
-                        onThemeChange={setThemeMode}
+                        onThemeChange={handleThemeChange}
                     />
                 )}
             </div>
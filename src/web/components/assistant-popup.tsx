@@ -3,7 +3,14 @@ import { Button, Input, Select, Spin, message, Switch } from 'antd';
 import { Copy, CheckCircle2, RotateCcw, Send, X } from 'lucide-react';
 import AppIcon from '../assets/app-icon.svg?react';
 import { LLMConfig, Action } from '../app';
-import { InvokeLLM } from '../utils/llm';
+import {
+    InvokeLLM,
+    InvokeLLMIncremental,
+    InvokeLLMNative,
+    InvokeLLMRouted,
+    InvokeLLMSpeculated,
+    InvokePipeline,
+} from '../utils/llm';
 import { ClipboardUtils } from '../utils/clipboard';
 import { DiffViewer } from './diff-viewer';
 import { calculateStringSimilarity } from '../utils/similarity';
@@ -11,6 +18,8 @@ import { events } from '../utils/events';
 
 interface AssistantPopupProps {
     clipboardContent: string;
+    // Native attachment handle of a clipboard image, when the clipboard holds one instead of text
+    clipboardImage?: string;
     onClose: () => void;
     selectedLLM: 'auto' | 'all' | string;
     onLLMChange: (_llm: 'auto' | 'all' | string) => void;
@@ -24,10 +33,13 @@ interface LLMResult {
     llmId: string;
     llmName: string;
     result: string;
+    // Why the router picked this model, when it did
+    routeReason?: string;
 }
 
 export function AssistantPopup({
     clipboardContent,
+    clipboardImage = '',
     onClose,
     selectedLLM,
     onLLMChange,
@@ -44,6 +56,9 @@ export function AssistantPopup({
     const showAllResults = selectedLLM === 'all';
     const enabledLLMs = llmConfigs.filter(llm => llm.enabled);
     const enabledActions = actions ? actions.filter(action => action.enabled) : [];
+    const hasContent = !!clipboardContent || !!clipboardImage;
+    // What the current results were produced from, so a new copy resets the popup
+    const currentContent = clipboardImage || clipboardContent;
 
     // Initialize events system and set up listeners
     useEffect(() => {
@@ -87,7 +102,7 @@ export function AssistantPopup({
 
     // Reset popup state when clipboard content changes
     useEffect(() => {
-        if (clipboardContent !== lastProcessedContent && clipboardContent.trim() !== '') {
+        if (currentContent !== lastProcessedContent && currentContent.trim() !== '') {
             // If clipboard content is different from what was last processed, reset to idle state
             if (state === 'completed' && results.length > 0) {
                 setState('idle');
@@ -96,22 +111,55 @@ export function AssistantPopup({
                 setCustomPrompt('');
             }
         }
-    }, [clipboardContent, lastProcessedContent, state, results.length]);
+    }, [currentContent, lastProcessedContent, state, results.length]);
 
     // Helper function to invoke LLM using the configured baseURL
     const invokeLLM = async (
         config: LLMConfig,
         systemContent: string,
         userContent: string,
+        action?: Action,
+        recordUsage = true,
     ): Promise<string> => {
         try {
-            const result = await InvokeLLM(
-                config.baseURL,
-                config.modelName,
-                config.apiKey,
-                systemContent,
-                userContent,
-            );
+            // Images go straight to the model; routing, pipelines and the text caches only apply to text
+            if (clipboardImage) {
+                const result = await InvokeLLM(
+                    config.baseURL,
+                    config.modelName,
+                    config.apiKey,
+                    systemContent,
+                    userContent,
+                    clipboardImage,
+                    config.socketPath,
+                );
+                return result || '';
+            }
+
+            // Pipeline actions chain other actions natively instead of one popup round-trip per step
+            const stages = (action?.pipeline ?? [])
+                .map(id => actions.find(candidate => candidate.id === id))
+                .filter((stage): stage is Action => !!stage);
+
+            const result = stages.length
+                ? await InvokePipeline(config, stages, userContent)
+                : action?.incremental
+                ? await InvokeLLMIncremental(
+                      config,
+                      action.id,
+                      systemContent,
+                      userContent,
+                      recordUsage,
+                  )
+                : action
+                ? await InvokeLLMSpeculated(
+                      config,
+                      action.id,
+                      systemContent,
+                      userContent,
+                      recordUsage,
+                  )
+                : await InvokeLLMNative(config, systemContent, userContent);
             return result || '';
         } catch (error) {
             console.error(`Error invoking ${config.name}:`, error);
@@ -124,7 +172,7 @@ export function AssistantPopup({
     };
 
     // Process with selected LLM(s)
-    const processWithLLM = async (actionPrompt: string) => {
+    const processWithLLM = async (actionPrompt: string, action?: Action) => {
         setState('processing');
         setResults([]);
         setCopied(false);
@@ -135,10 +183,16 @@ export function AssistantPopup({
 
         try {
             if (selectedLLM === 'all') {
-                // Process with all enabled LLMs
-                const promises = enabledLLMs.map(async config => {
+                // Process with all enabled LLMs; the click counts once towards the usage statistics
+                const promises = enabledLLMs.map(async (config, index) => {
                     try {
-                        const result = await invokeLLM(config, systemContent, userContent);
+                        const result = await invokeLLM(
+                            config,
+                            systemContent,
+                            userContent,
+                            action,
+                            index === 0,
+                        );
                         return {
                             llmId: config.id,
                             llmName: config.name,
@@ -171,6 +225,39 @@ export function AssistantPopup({
                 // Process with selected LLM or auto-select first enabled
                 let targetConfig: LLMConfig | undefined;
 
+                if (
+                    selectedLLM === 'auto' &&
+                    action?.routing &&
+                    !action.pipeline?.length &&
+                    !clipboardImage
+                ) {
+                    const routed = await InvokeLLMRouted(
+                        enabledLLMs,
+                        action,
+                        systemContent,
+                        userContent,
+                    );
+                    if (routed) {
+                        const config = enabledLLMs.find(
+                            candidate => candidate.id === routed.configId,
+                        );
+                        setResults([
+                            {
+                                llmId: routed.configId,
+                                llmName: config?.name ?? routed.configId,
+                                result: routed.content,
+                                routeReason: routed.reason,
+                            },
+                        ]);
+                        setShowDiffViewer(
+                            calculateStringSimilarity(clipboardContent, routed.content).isSimilar,
+                        );
+                        setState('completed');
+                        setLastProcessedContent(currentContent);
+                        return;
+                    }
+                }
+
                 if (selectedLLM === 'auto') {
                     targetConfig = enabledLLMs[0];
                 } else {
@@ -181,11 +268,18 @@ export function AssistantPopup({
                     throw new Error('No LLM configuration found or enabled');
                 }
 
-                if (!targetConfig.apiKey || targetConfig.apiKey.trim() === '') {
+                // In-process models ("local:<path to .gguf>") need no key
+                const isLocal = targetConfig.baseURL.startsWith('local:');
+                if (!isLocal && (!targetConfig.apiKey || targetConfig.apiKey.trim() === '')) {
                     throw new Error(`API key not configured for ${targetConfig.name}`);
                 }
 
-                const result = await invokeLLM(targetConfig, systemContent, userContent);
+                const result = await invokeLLM(
+                    targetConfig,
+                    systemContent,
+                    userContent,
+                    action,
+                );
                 const singleResult = {
                     llmId: targetConfig.id,
                     llmName: targetConfig.name,
@@ -200,7 +294,7 @@ export function AssistantPopup({
 
             setState('completed');
             // Track the clipboard content that was processed
-            setLastProcessedContent(clipboardContent);
+            setLastProcessedContent(currentContent);
         } catch (error) {
             console.error('Error processing with LLM:', error);
             message.error(error instanceof Error ? error.message : 'Failed to process request', 8);
@@ -209,7 +303,7 @@ export function AssistantPopup({
     };
 
     const handleQuickAction = (action: Action) => {
-        processWithLLM(action.prompt);
+        processWithLLM(action.prompt, action);
     };
 
     const handleCustomPrompt = () => {
@@ -335,7 +429,7 @@ export function AssistantPopup({
                                         key={action.id}
                                         size='small'
                                         onClick={() => handleQuickAction(action)}
-                                        disabled={state === 'processing' || !clipboardContent}
+                                        disabled={state === 'processing' || !hasContent}
                                         style={{
                                             justifyContent: 'flex-start',
                                             height: '28px',
@@ -386,7 +480,7 @@ export function AssistantPopup({
                                 onClick={handleCustomPrompt}
                                 disabled={
                                     state === 'processing' ||
-                                    !clipboardContent ||
+                                    !hasContent ||
                                     !customPrompt.trim()
                                 }
                                 className='send-button'
@@ -407,7 +501,9 @@ export function AssistantPopup({
                     <div className='results-container'>
                         {state === 'idle' && (
                             <div className='clipboard-content'>
-                                {clipboardContent || 'No content in clipboard'}
+                                {clipboardImage
+                                    ? 'Image in clipboard'
+                                    : clipboardContent || 'No content in clipboard'}
                             </div>
                         )}
 
@@ -423,8 +519,9 @@ export function AssistantPopup({
                                 {results.map((result, index) => (
                                     <div key={result.llmId} className='result-item'>
                                         <div className='result-header'>
-                                            {showAllResults && (
+                                            {(showAllResults || result.routeReason) && (
                                                 <div
+                                                    title={result.routeReason}
                                                     style={{
                                                         fontSize: '0.75rem',
                                                         color: '#8c8c8c',
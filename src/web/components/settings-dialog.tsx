@@ -3,7 +3,6 @@ import { Button, Input, Select, Switch, Tabs, message } from 'antd';
 import { Trash2, Plus, Eye, EyeOff } from 'lucide-react';
 import { Action, LLMConfig, ThemeMode } from '../app';
 import { events } from '../utils/events';
-import { VaultUtils } from '../utils/vault';
 
 interface SettingsDialogProps {
     open: boolean;
@@ -35,31 +34,17 @@ export function SettingsDialog({
         events.initialize();
     }, []);
 
-    // Wrapper for theme change to emit events
-    const handleThemeChange = async (newTheme: ThemeMode) => {
+    // The app saves these to the shared settings, which send the assistant window the difference
+    const handleThemeChange = (newTheme: ThemeMode) => {
         _onThemeChange(newTheme);
-
-        // Save theme to vault
-        try {
-            await VaultUtils.saveTheme(newTheme);
-        } catch (error) {
-            console.error('Failed to save theme to vault:', error);
-        }
-
-        // Emit event to notify other components
-        events.triggerToOtherWebview('settings:theme-changed', { theme: newTheme });
     };
 
-    // Wrapper for LLM configs change to emit events
     const handleLLMConfigsChange = (newConfigs: LLMConfig[]) => {
         _onLLMConfigsChange(newConfigs);
-        events.triggerToOtherWebview('settings:llm-configs-changed', { configs: newConfigs });
     };
 
-    // Wrapper for actions change to emit events
     const handleActionsChange = (newActions: Action[]) => {
         _onActionsChange(newActions);
-        events.triggerToOtherWebview('settings:actions-changed', { actions: newActions });
     };
 
     const handleAddNew = () => {
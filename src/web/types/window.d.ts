@@ -1,9 +1,20 @@
 // Type definitions for the BYOA native API and Saucer
 
+// A body fragment: literal text, or a native attachment spliced in by handle
+type NetworkBodyPart =
+    | { text: string }
+    | { attachment: string; encoding?: 'raw' | 'json' | 'base64' | 'dataUrl' };
+
 interface NetworkFetchOptions {
     method?: string;
     headers?: Record<string, string>;
     body?: string;
+    bodyParts?: NetworkBodyPart[];
+    unixSocket?: string;
+    // Bytes kept in memory before the body spills to a temporary file; at most 8 MiB here
+    memoryLimit?: number;
+    // Bytes after which the transfer is aborted; capped at memoryLimit, since the body comes back inline
+    maxBodySize?: number;
 }
 
 interface NetworkFetchResponse {
@@ -22,12 +33,71 @@ declare global {
                 clipboard_readText(): Promise<string>;
                 clipboard_writeText(_text: string): Promise<boolean>;
                 clipboard_clear(): Promise<void>;
+                attachment_readClipboardImage(): Promise<string>;
+                attachment_release(_handle: string): Promise<boolean>;
                 vault_getData(_key: string): Promise<string>;
                 vault_setData(_key: string, _value: string): Promise<boolean>;
                 vault_deleteData(_key: string): Promise<boolean>;
                 vault_hasData(_key: string): Promise<boolean>;
+                vault_getMany(_keysJson: string): Promise<string>;
+                vault_setMany(_valuesJson: string): Promise<boolean>;
+                vault_workerStats(): Promise<string>;
+                vault_status(): Promise<string>;
+                config_getData(_key: string): Promise<string>;
+                config_setData(_key: string, _value: string): Promise<boolean>;
+                config_deleteData(_key: string): Promise<boolean>;
+                config_hasData(_key: string): Promise<boolean>;
+                config_setMany(_valuesJson: string): Promise<boolean>;
+                config_snapshot(): Promise<string>;
+                settings_subscribe(): Promise<string>;
+                settings_apply(_patchJson: string, _baseVersion: number): Promise<string>;
                 network_fetch(_url: string, _options: string): Promise<string>;
+                llm_invokeIncremental(
+                    _configJson: string,
+                    _actionKey: string,
+                    _systemContent: string,
+                    _userContent: string,
+                ): Promise<string>;
+                llm_complete(
+                    _configJson: string,
+                    _systemContent: string,
+                    _userContent: string,
+                ): Promise<string>;
+                llm_invokeRouted(
+                    _configsJson: string,
+                    _policyJson: string,
+                    _systemContent: string,
+                    _userContent: string,
+                ): Promise<string>;
+                speculation_claim(
+                    _actionId: string,
+                    _configJson: string,
+                    _systemContent: string,
+                    _userContent: string,
+                    _recordUsage: boolean,
+                ): Promise<string>;
+                speculation_stats(): Promise<string>;
+                llm_poolStats(): Promise<string>;
+                llm_promptCacheStats(): Promise<string>;
+                pipeline_run(
+                    _configJson: string,
+                    _stagesJson: string,
+                    _input: string,
+                    _fromStage: number,
+                    _runId: string,
+                ): Promise<string>;
+                ws_send(
+                    _url: string,
+                    _headersJson: string,
+                    _requestId: string,
+                    _payload: string,
+                ): Promise<string>;
+                event_queueStats(): Promise<string>;
+                event_subscribe(_eventName: string, _listening: boolean): Promise<boolean>;
+                event_resubscribe(_eventNamesJson: string): Promise<boolean>;
+                event_busStats(): Promise<string>;
                 event_trigger(_eventName: string, _data: string): Promise<void>;
+                debug_bridgeStats(): Promise<string>;
             };
         };
 
@@ -36,4 +106,4 @@ declare global {
     }
 }
 
-export type { NetworkFetchOptions, NetworkFetchResponse };
+export type { NetworkBodyPart, NetworkFetchOptions, NetworkFetchResponse };
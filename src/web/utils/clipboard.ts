@@ -18,9 +18,22 @@ export class ClipboardUtils {
             // Use our native clipboard API if available, fallback to browser API
             if (window.saucer?.exposed?.clipboard_readText) {
                 const text = await window.saucer.exposed.clipboard_readText();
+                if (!text && window.saucer.exposed.attachment_readClipboardImage) {
+                    // Images stay native; the data is a handle for "bodyParts", not the bytes
+                    const handle = await window.saucer.exposed.attachment_readClipboardImage();
+                    if (handle) {
+                        this.releaseCachedImage();
+                        this._cache = {
+                            type: 'image',
+                            data: handle,
+                        };
+                    }
+                    return [this._cache];
+                }
                 if (!text || (this._cache.type === 'text' && this._cache.data === text)) {
                     return [this._cache];
                 }
+                this.releaseCachedImage();
                 this._cache = {
                     type: 'text',
                     data: text,
@@ -101,6 +114,15 @@ export class ClipboardUtils {
         return !!(window.saucer?.exposed?.clipboard_readText || navigator.clipboard);
     }
 
+    /**
+     * Release the native attachment behind a cached image handle
+     */
+    private static releaseCachedImage(): void {
+        if (this._cache.type === 'image' && typeof this._cache.data === 'string') {
+            window.saucer?.exposed?.attachment_release(this._cache.data);
+        }
+    }
+
     /**
      * Get cached clipboard data
      */
@@ -112,6 +134,7 @@ export class ClipboardUtils {
      * Clear cached clipboard data
      */
     static clearCache(): void {
+        this.releaseCachedImage();
         this._cache = {
             type: 'text',
             data: '',
@@ -5,11 +5,16 @@
  */
 
 import type { LLMConfig, Action } from '../app';
+import type { PatchOperation } from './settings';
 
 export type EventData = Record<string, unknown>;
 
 export type EventListener = (data: EventData) => void;
 
+/**
+ * Every event the webviews exchange. The native side keeps the same list (with ids) in
+ * src/native/include/event-registry.hpp and only routes events a window listens for.
+ */
 export interface EventMap {
     'settings:theme-changed': {
         theme:
@@ -28,6 +33,11 @@ export interface EventMap {
     'settings:action-enabled-changed': { actionId: string; enabled: boolean };
     'assistant:request-refresh': { reason: string };
     'assistant:clipboard-changed': { content: string };
+    'network:ws-delta': { requestId: string; message: string };
+    'pipeline:progress': { runId: string; stage: number; delta: string; done: boolean };
+    'settings:patch': { version: number; patch: PatchOperation[] };
+    'app:focus-changed': { focused: boolean };
+    'vault:status': { pending: number; failed: Record<string, string>; unavailable?: string };
 }
 
 export type EventName = keyof EventMap;
@@ -63,6 +73,8 @@ class Events {
         }
 
         this.isInitialized = true;
+        // After the effects of the first render have added their listeners and the native callback
+        setTimeout(() => this.syncNativeSubscriptions(), 0);
         console.log('Events system initialized');
     }
 
@@ -167,6 +179,7 @@ class Events {
     on<T extends EventName>(eventName: T, listener: EventListener): () => void {
         if (!this.listeners.has(eventName)) {
             this.listeners.set(eventName, new Set());
+            this.setNativeSubscription(eventName, true);
         }
 
         const eventListeners = this.listeners.get(eventName);
@@ -181,6 +194,7 @@ class Events {
                 eventListeners.delete(listener);
                 if (eventListeners.size === 0) {
                     this.listeners.delete(eventName);
+                    this.setNativeSubscription(eventName, false);
                 }
             }
         };
@@ -195,10 +209,32 @@ class Events {
             eventListeners.delete(listener);
             if (eventListeners.size === 0) {
                 this.listeners.delete(eventName);
+                this.setNativeSubscription(eventName, false);
             }
         }
     }
 
+    /**
+     * Tell the native side whether this window has listeners for an event;
+     * events it has none for are not sent here at all
+     */
+    private setNativeSubscription(eventName: EventName, listening: boolean): void {
+        window.saucer?.exposed?.event_subscribe?.(eventName, listening).catch(error => {
+            console.error(`[Events] Failed to update subscription for ${eventName}:`, error);
+        });
+    }
+
+    /**
+     * Send the whole subscription set once the page has started. The native side holds this
+     * window's events until then (and again after a reload), so none sent during startup are lost
+     */
+    private syncNativeSubscriptions(): void {
+        const eventNames = JSON.stringify([...this.listeners.keys()]);
+        window.saucer?.exposed?.event_resubscribe?.(eventNames).catch(error => {
+            console.error('[Events] Failed to send subscriptions:', error);
+        });
+    }
+
     /**
      * Subscribe to an event once (auto-unsubscribe after first call)
      */
@@ -213,7 +249,9 @@ class Events {
 
     /**
      * Trigger an event to other webviews via native API
-     * This is used to communicate between SettingsDialog and AssistantPopup
+     * This is used to communicate between SettingsDialog and AssistantPopup. The native side
+     * only accepts events webviews raise, with a JSON object payload; its fields are not checked
+     * against EventMap there, so they are only as well-typed as the sender
      */
     triggerToOtherWebview<T extends EventName>(eventName: T, data: EventMap[T]): void {
         try {
@@ -255,6 +293,7 @@ class Events {
      * Clear all listeners (useful for cleanup)
      */
     clearAll(): void {
+        this.listeners.forEach((_, eventName) => this.setNativeSubscription(eventName, false));
         this.listeners.clear();
     }
 }
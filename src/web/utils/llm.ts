@@ -1,4 +1,24 @@
 import type { NetworkFetchOptions, NetworkFetchResponse } from '../types/window.d';
+import type { Action, LLMConfig } from '../app';
+import { events } from './events';
+
+// Base instruction that applies to all requests
+const baseInstruction =
+    'CRITICAL INSTRUCTION: You are a direct output generator. Your ONLY job is to produce RAW OUTPUT with ZERO conversational elements. ' +
+    '\n\n' +
+    'ABSOLUTELY FORBIDDEN - Never start your response with ANY of these phrases or similar ones:\n' +
+    '- "Here\'s..." / "Here is..." / "Here are..."\n' +
+    '- "I understand..." / "I see..." / "I\'ve..." / "I can..."\n' +
+    '- "The improved..." / "The corrected..." / "The result..."\n' +
+    '- "Your answer..." / "Your result..."\n' +
+    '- "Based on..." / "According to..."\n' +
+    '- "Let me..." / "I will..."\n' +
+    '- "Sure,..." \n' +
+    '- Any explanatory prefix whatsoever\n' +
+    '\n' +
+    'YOUR FIRST WORD/CHARACTER MUST BE THE ACTUAL ANSWER ITSELF. ' +
+    'DO NOT acknowledge the request. DO NOT introduce the answer. DO NOT add quotes around the answer unless they are part of the actual content. ' +
+    'START IMMEDIATELY WITH THE ANSWER.\n\n';
 
 export async function InvokeLLM(
     baseURL: string,
@@ -6,27 +26,11 @@ export async function InvokeLLM(
     apiKey: string,
     systemContent: string,
     userContent: string,
+    imageHandle?: string,
+    socketPath?: string,
 ) {
     console.info(`Invoking LLM with baseURL: ${baseURL}, modelName: ${modelName}`);
 
-    // Base instruction that applies to all requests
-    const baseInstruction =
-        'CRITICAL INSTRUCTION: You are a direct output generator. Your ONLY job is to produce RAW OUTPUT with ZERO conversational elements. ' +
-        '\n\n' +
-        'ABSOLUTELY FORBIDDEN - Never start your response with ANY of these phrases or similar ones:\n' +
-        '- "Here\'s..." / "Here is..." / "Here are..."\n' +
-        '- "I understand..." / "I see..." / "I\'ve..." / "I can..."\n' +
-        '- "The improved..." / "The corrected..." / "The result..."\n' +
-        '- "Your answer..." / "Your result..."\n' +
-        '- "Based on..." / "According to..."\n' +
-        '- "Let me..." / "I will..."\n' +
-        '- "Sure,..." \n' +
-        '- Any explanatory prefix whatsoever\n' +
-        '\n' +
-        'YOUR FIRST WORD/CHARACTER MUST BE THE ACTUAL ANSWER ITSELF. ' +
-        'DO NOT acknowledge the request. DO NOT introduce the answer. DO NOT add quotes around the answer unless they are part of the actual content. ' +
-        'START IMMEDIATELY WITH THE ANSWER.\n\n';
-
     // Combine base instruction with the action-specific system content
     const fullSystemContent = baseInstruction + systemContent;
 
@@ -48,6 +52,36 @@ export async function InvokeLLM(
         },
         body: JSON.stringify(requestBody),
     };
+
+    // Local servers listening on a Unix domain socket skip TCP and proxy lookup natively
+    if (socketPath) {
+        options.unixSocket = socketPath;
+    }
+
+    // Images stay native: split the body around a marker and let native code splice
+    // the base64 data URL of the attachment in, so the payload never passes through JS
+    if (imageHandle) {
+        const marker = '__BYOA_IMAGE_URL__';
+        const [head, tail] = JSON.stringify({
+            ...requestBody,
+            messages: [
+                requestBody.messages[0],
+                {
+                    role: 'user',
+                    content: [
+                        ...(userContent ? [{ type: 'text', text: userContent }] : []),
+                        { type: 'image_url', image_url: { url: marker } },
+                    ],
+                },
+            ],
+        }).split(marker);
+        delete options.body;
+        options.bodyParts = [
+            { text: head },
+            { attachment: imageHandle, encoding: 'dataUrl' },
+            { text: tail },
+        ];
+    }
     // Remove the trailing slashes and '/chat/completions' from the baseURL
     const baseURLWithoutTrailingSlashes = baseURL
         .replace(/\/$/, '')
@@ -91,3 +125,282 @@ export async function InvokeLLM(
         throw error;
     }
 }
+
+/**
+ * Take over the request native code speculatively started for this action when the popup
+ * opened, if it predicted this action on this input. Returns undefined otherwise.
+ * With `recordUsage` the call also teaches the native predictor which action this source
+ * usually gets; set it on one call per click, not once per enabled model.
+ */
+async function claimSpeculation(
+    config: LLMConfig,
+    actionId: string,
+    systemContent: string,
+    userContent: string,
+    recordUsage: boolean,
+) {
+    if (!window.saucer?.exposed?.speculation_claim) {
+        return undefined;
+    }
+
+    const resultJson = await window.saucer.exposed.speculation_claim(
+        actionId,
+        JSON.stringify(config),
+        baseInstruction + systemContent,
+        userContent,
+        recordUsage,
+    );
+    const result: { hit: boolean; ok: boolean; content: string; savedMs: number } =
+        JSON.parse(resultJson);
+    if (result.hit && result.ok) {
+        console.info(`Speculative result used, saved ${result.savedMs} ms`);
+        return result.content;
+    }
+    return undefined;
+}
+
+/**
+ * Invoke an LLM natively, reusing cached results for paragraphs that did not change
+ * since the last run of the same action. A matching speculative result is used as is.
+ * Falls back to a full InvokeLLM call when the native bridge is unavailable.
+ */
+export async function InvokeLLMIncremental(
+    config: LLMConfig,
+    actionKey: string,
+    systemContent: string,
+    userContent: string,
+    recordUsage = true,
+) {
+    const speculated = await claimSpeculation(
+        config,
+        actionKey,
+        systemContent,
+        userContent,
+        recordUsage,
+    );
+    if (speculated !== undefined) {
+        return speculated;
+    }
+
+    if (!window.saucer?.exposed?.llm_invokeIncremental) {
+        return InvokeLLM(
+            config.baseURL,
+            config.modelName,
+            config.apiKey,
+            systemContent,
+            userContent,
+            undefined,
+            config.socketPath,
+        );
+    }
+
+    const resultJson = await window.saucer.exposed.llm_invokeIncremental(
+        JSON.stringify(config),
+        actionKey,
+        baseInstruction + systemContent,
+        userContent,
+    );
+    const result: { ok: boolean; content: string; error: string; segments: number; sent: number } =
+        JSON.parse(resultJson);
+
+    if (!result.ok) {
+        throw new Error(result.error || 'Incremental processing failed');
+    }
+
+    console.info(`Incremental run: sent ${result.sent} of ${result.segments} paragraphs`);
+    return result.content;
+}
+
+/**
+ * Invoke an LLM with the request built natively: the stable prompt prefix goes first
+ * with the provider's cache markers, and `pool` members are balanced per `poolPolicy`.
+ * Falls back to InvokeLLM when the native bridge is unavailable.
+ */
+export async function InvokeLLMNative(
+    config: LLMConfig,
+    systemContent: string,
+    userContent: string,
+) {
+    if (!window.saucer?.exposed?.llm_complete) {
+        return InvokeLLM(
+            config.baseURL,
+            config.modelName,
+            config.apiKey,
+            systemContent,
+            userContent,
+            undefined,
+            config.socketPath,
+        );
+    }
+
+    const resultJson = await window.saucer.exposed.llm_complete(
+        JSON.stringify(config),
+        baseInstruction + systemContent,
+        userContent,
+    );
+    const result: { ok: boolean; status: number; content: string; error: string } =
+        JSON.parse(resultJson);
+
+    if (!result.ok) {
+        throw new Error(result.error || 'Native request failed');
+    }
+    return result.content;
+}
+
+/**
+ * Run an action, taking over the request native code speculatively started for it when
+ * the popup opened (if it predicted this action on this input); otherwise InvokeLLMNative.
+ * See claimSpeculation for `recordUsage`.
+ */
+export async function InvokeLLMSpeculated(
+    config: LLMConfig,
+    actionId: string,
+    systemContent: string,
+    userContent: string,
+    recordUsage = true,
+) {
+    const speculated = await claimSpeculation(
+        config,
+        actionId,
+        systemContent,
+        userContent,
+        recordUsage,
+    );
+    return speculated ?? InvokeLLMNative(config, systemContent, userContent);
+}
+
+/**
+ * Let native code choose among the enabled configs for this input, using the action's
+ * routing policy and observed latency, falling back along the chain on errors.
+ * Returns undefined when the native bridge is unavailable.
+ */
+export async function InvokeLLMRouted(
+    configs: LLMConfig[],
+    action: Action,
+    systemContent: string,
+    userContent: string,
+) {
+    if (!window.saucer?.exposed?.llm_invokeRouted) {
+        return undefined;
+    }
+
+    const resultJson = await window.saucer.exposed.llm_invokeRouted(
+        JSON.stringify(configs),
+        JSON.stringify(action.routing ?? {}),
+        baseInstruction + systemContent,
+        userContent,
+    );
+    const result: {
+        ok: boolean;
+        content: string;
+        error: string;
+        configId: string;
+        reason: string;
+        attempts: { configId: string; ok: boolean; error: string }[];
+    } = JSON.parse(resultJson);
+
+    console.info(`Routed: ${result.reason}`);
+    if (!result.ok) {
+        throw new Error(result.error || 'Routed request failed');
+    }
+    return result;
+}
+
+/**
+ * Run actions as a native pipeline, each stage on the previous stage's output.
+ * Incremental (paragraph-local) actions start on streamed sentences of the previous
+ * stage. Finished stages are cached natively, so a re-run resumes after the last
+ * cached stage; pass `fromStage` to force re-running from a given stage.
+ */
+export async function InvokePipeline(
+    config: LLMConfig,
+    stages: Action[],
+    userContent: string,
+    onProgress?: (stage: number, delta: string, done: boolean) => void,
+    fromStage = -1,
+) {
+    if (!window.saucer?.exposed?.pipeline_run) {
+        // No native bridge: run the stages one after the other
+        let content = userContent;
+        for (const stage of stages) {
+            content = await InvokeLLM(
+                config.baseURL,
+                config.modelName,
+                config.apiKey,
+                stage.prompt,
+                content,
+                undefined,
+                config.socketPath,
+            );
+        }
+        return content;
+    }
+
+    const runId = `run-${Date.now().toString(36)}-${Math.random().toString(36).slice(2, 8)}`;
+    const unsubscribe = events.on('pipeline:progress', data => {
+        if (data.runId === runId && onProgress) {
+            onProgress(data.stage as number, data.delta as string, data.done as boolean);
+        }
+    });
+
+    try {
+        const resultJson = await window.saucer.exposed.pipeline_run(
+            JSON.stringify(config),
+            JSON.stringify(
+                stages.map(stage => ({
+                    id: stage.id,
+                    prompt: baseInstruction + stage.prompt,
+                    streamable: !!stage.incremental,
+                })),
+            ),
+            userContent,
+            fromStage,
+            runId,
+        );
+        const result: { ok: boolean; content: string; error: string; resumedFrom: number } =
+            JSON.parse(resultJson);
+        if (!result.ok) {
+            throw new Error(result.error || 'Pipeline failed');
+        }
+
+        console.info(`Pipeline run: resumed from stage ${result.resumedFrom} of ${stages.length}`);
+        return result.content;
+    } finally {
+        unsubscribe();
+    }
+}
+
+/**
+ * Send a message over the persistent native WebSocket connection for `url`
+ * (realtime-style provider APIs). Every provider message routed to this request
+ * is passed to `onDelta`; the promise resolves with the final message.
+ */
+export async function SendRealtime(
+    url: string,
+    apiKey: string,
+    payload: Record<string, unknown>,
+    onDelta: (message: Record<string, unknown>) => void,
+) {
+    const requestId = `req-${Date.now().toString(36)}-${Math.random().toString(36).slice(2, 8)}`;
+    const unsubscribe = events.on('network:ws-delta', (data) => {
+        if (data.requestId === requestId) {
+            onDelta(JSON.parse(data.message as string));
+        }
+    });
+
+    try {
+        const resultJson = await window.saucer.exposed.ws_send(
+            url,
+            JSON.stringify({ Authorization: `Bearer ${apiKey}` }),
+            requestId,
+            JSON.stringify({ ...payload, event_id: requestId }),
+        );
+        const result: { ok: boolean; error: string; message: string } = JSON.parse(resultJson);
+        if (!result.ok) {
+            throw new Error(result.error || 'WebSocket request failed');
+        }
+        return JSON.parse(result.message);
+    } finally {
+        unsubscribe();
+    }
+}
@@ -0,0 +1,207 @@
+/**
+ * Window-side copy of the native shared settings document (llm_configs, actions, theme).
+ * Changes are sent as JSON patches against the last seen version; other windows receive
+ * them as 'settings:patch' deltas instead of reloading everything from storage.
+ */
+
+import { events } from './events';
+
+export interface PatchOperation {
+    op: 'add' | 'remove' | 'replace' | 'move' | 'copy' | 'test';
+    path: string;
+    value?: unknown;
+    from?: string;
+}
+
+export type SettingsDocument = Record<string, unknown>;
+
+type SettingsListener = (state: SettingsDocument) => void;
+
+const isContainer = (value: unknown): value is Record<string, unknown> =>
+    typeof value === 'object' && value !== null;
+
+const escapePointer = (token: string) => token.replace(/~/g, '~0').replace(/\//g, '~1');
+
+const unescapePointer = (token: string) => token.replace(/~1/g, '/').replace(/~0/g, '~');
+
+/**
+ * add/remove/replace operations turning `from` into `to`; arrays changing length are replaced
+ */
+export function diffJson(from: unknown, to: unknown, path = '', ops: PatchOperation[] = []) {
+    if (from === to) {
+        return ops;
+    }
+    if (isContainer(from) && isContainer(to) && Array.isArray(from) === Array.isArray(to)) {
+        if (Array.isArray(from) && Array.isArray(to)) {
+            if (from.length !== to.length) {
+                ops.push({ op: 'replace', path, value: to });
+                return ops;
+            }
+            from.forEach((item, i) => diffJson(item, to[i], `${path}/${i}`, ops));
+            return ops;
+        }
+        for (const key of Object.keys(from)) {
+            const child = `${path}/${escapePointer(key)}`;
+            if (!(key in to)) {
+                ops.push({ op: 'remove', path: child });
+            } else {
+                diffJson(from[key], to[key], child, ops);
+            }
+        }
+        for (const key of Object.keys(to)) {
+            if (!(key in from)) {
+                ops.push({ op: 'add', path: `${path}/${escapePointer(key)}`, value: to[key] });
+            }
+        }
+        return ops;
+    }
+    if (to === undefined) {
+        ops.push({ op: 'remove', path });
+    } else {
+        ops.push({ op: from === undefined ? 'add' : 'replace', path, value: to });
+    }
+    return ops;
+}
+
+/**
+ * Apply add/remove/replace operations (what the native side broadcasts)
+ */
+function applyPatch(document: SettingsDocument, ops: PatchOperation[]) {
+    // Top-level values are copied before their first change, so React sees new references
+    const copied = new Set<string>();
+    for (const op of ops) {
+        const tokens = op.path.split('/').slice(1).map(unescapePointer);
+        if (tokens.length > 1 && !copied.has(tokens[0])) {
+            copied.add(tokens[0]);
+            document[tokens[0]] = structuredClone(document[tokens[0]]);
+        }
+        const last = tokens.pop();
+        if (last === undefined) {
+            continue;
+        }
+        let parent: unknown = document;
+        for (const token of tokens) {
+            parent = isContainer(parent) ? parent[token] : undefined;
+        }
+        if (!isContainer(parent)) {
+            throw new Error(`Invalid patch path ${op.path}`);
+        }
+        if (Array.isArray(parent)) {
+            const index = last === '-' ? parent.length : Number(last);
+            if (op.op === 'remove') {
+                parent.splice(index, 1);
+            } else if (op.op === 'add') {
+                parent.splice(index, 0, op.value);
+            } else {
+                parent[index] = op.value;
+            }
+        } else if (op.op === 'remove') {
+            delete parent[last];
+        } else {
+            parent[last] = op.value;
+        }
+    }
+}
+
+class SharedSettings {
+    private version = 0;
+    private state: SettingsDocument = {};
+    private listeners = new Set<SettingsListener>();
+    private subscribed = false;
+
+    /**
+     * Whether the native shared settings API is present
+     */
+    get available(): boolean {
+        return !!window.saucer?.exposed?.settings_subscribe;
+    }
+
+    /**
+     * Subscribe this window to deltas and load the current document
+     */
+    async load(): Promise<SettingsDocument | null> {
+        if (!window.saucer?.exposed?.settings_subscribe) {
+            return null;
+        }
+        if (!this.subscribed) {
+            this.subscribed = true;
+            events.on('settings:patch', data =>
+                this.handleDelta(data.version as number, data.patch as PatchOperation[]),
+            );
+        }
+        this.reset(JSON.parse(await window.saucer.exposed.settings_subscribe()));
+        return this.state;
+    }
+
+    /**
+     * Set top-level `key` to `value`, sending only what changed
+     */
+    async update(key: string, value: unknown): Promise<boolean> {
+        if (!window.saucer?.exposed?.settings_apply) {
+            return false;
+        }
+        // A conflict means another window got in first: resync and diff again, once
+        for (let attempt = 0; attempt < 2; attempt++) {
+            const ops = diffJson(this.state[key], value, `/${escapePointer(key)}`);
+            if (ops.length === 0) {
+                return true;
+            }
+            const result = JSON.parse(
+                await window.saucer.exposed.settings_apply(JSON.stringify(ops), this.version),
+            ) as { ok: boolean; version: number; conflict?: boolean };
+            if (result.ok) {
+                // A newer delta may already have reloaded a snapshot that includes this change
+                if (result.version > this.version) {
+                    applyPatch(this.state, ops);
+                    this.version = result.version;
+                }
+                return true;
+            }
+            if (!result.conflict) {
+                console.error('Settings change rejected:', ops);
+                return false;
+            }
+            await this.load();
+        }
+        return false;
+    }
+
+    /**
+     * Called with the whole document after every change made by another window
+     */
+    onChange(listener: SettingsListener): () => void {
+        this.listeners.add(listener);
+        return () => this.listeners.delete(listener);
+    }
+
+    private reset(snapshot: { version: number; state: SettingsDocument }) {
+        this.version = snapshot.version;
+        this.state = snapshot.state ?? {};
+    }
+
+    private handleDelta(version: number, patch: PatchOperation[]) {
+        if (version <= this.version) {
+            return;
+        }
+        if (version !== this.version + 1) {
+            // Missed a delta; the snapshot is authoritative
+            this.load().then(() => this.notify());
+            return;
+        }
+        try {
+            applyPatch(this.state, patch);
+            this.version = version;
+        } catch (error) {
+            console.error('Failed to apply settings delta, reloading:', error);
+            this.load().then(() => this.notify());
+            return;
+        }
+        this.notify();
+    }
+
+    private notify() {
+        this.listeners.forEach(listener => listener(this.state));
+    }
+}
+
+export const sharedSettings = new SharedSettings();
@@ -1,224 +1,347 @@
 import { LLMConfig, Action, ThemeMode } from '../app';
+import { sharedSettings } from './settings';
+
+// Everything the app loads from the config store at startup; has* is false where defaults were used
+export interface VaultSnapshot {
+    llmConfigs: LLMConfig[];
+    actions: Action[];
+    theme: ThemeMode;
+    hasLLMConfigs: boolean;
+    hasActions: boolean;
+    hasTheme: boolean;
+}
+
+// Deferred credential store writes; `failed` maps each key the store rejected to its error.
+// Native code keeps retrying those and sends the new status as 'vault:status'. `unavailable`
+// is set when the configured store can't be used at all, and API key writes are refused.
+export interface VaultStatus {
+    pending: number;
+    failed: Record<string, string>;
+    unavailable?: string;
+}
 
-// Vault utility functions for LLM configurations and actions
+// Settings storage for LLM configurations, actions and theme. These go to the native config
+// store, which keeps only the API keys in the OS vault.
 export class VaultUtils {
     private static readonly LLM_CONFIGS_KEY = 'llm_configs';
     private static readonly ACTIONS_KEY = 'actions';
     private static readonly THEME_KEY = 'theme';
 
     /**
-     * Load LLM configurations from the vault
+     * Load configs, actions and theme with a single config_snapshot call,
+     * falling back to the per-key calls if the batched API is unavailable
+     */
+    static async loadAll(): Promise<VaultSnapshot> {
+        if (!window.saucer?.exposed?.config_snapshot) {
+            const [llmConfigs, actions, theme, hasLLMConfigs, hasActions, hasTheme] =
+                await Promise.all([
+                    this.loadLLMConfigs(),
+                    this.loadActions(),
+                    this.loadTheme(),
+                    this.hasLLMConfigs(),
+                    this.hasActions(),
+                    this.hasTheme(),
+                ]);
+            return { llmConfigs, actions, theme, hasLLMConfigs, hasActions, hasTheme };
+        }
+
+        const document: Record<string, unknown> = {};
+        try {
+            const values = JSON.parse(await window.saucer.exposed.config_snapshot()) as Record<
+                string,
+                string | null
+            >;
+            for (const [key, data] of Object.entries(values)) {
+                if (!data || data.trim() === '') {
+                    continue;
+                }
+                try {
+                    document[key] = JSON.parse(data);
+                } catch (error) {
+                    console.error(`Failed to parse ${key} from the config store:`, error);
+                }
+            }
+        } catch (error) {
+            console.error('Failed to load settings snapshot:', error);
+        }
+        return this.fromDocument(document);
+    }
+
+    /**
+     * Current credential store status, or null if the native API is unavailable
+     */
+    static async loadStatus(): Promise<VaultStatus | null> {
+        try {
+            if (!window.saucer?.exposed?.vault_status) {
+                return null;
+            }
+            return JSON.parse(await window.saucer.exposed.vault_status()) as VaultStatus;
+        } catch (error) {
+            console.error('Failed to load the credential store status:', error);
+            return null;
+        }
+    }
+
+    /**
+     * Typed settings from a parsed settings document, with defaults for what is missing
+     */
+    static fromDocument(document: Record<string, unknown>): VaultSnapshot {
+        const pick = <T>(key: string, fallback: T): [T, boolean] =>
+            document[key] === undefined || document[key] === null
+                ? [fallback, false]
+                : [document[key] as T, true];
+
+        const [llmConfigs, hasLLMConfigs] = pick(this.LLM_CONFIGS_KEY, this.getDefaultConfigs());
+        const [actions, hasActions] = pick(this.ACTIONS_KEY, this.getDefaultActions());
+        const [theme, hasTheme] = pick<ThemeMode>(this.THEME_KEY, 'auto');
+        return { llmConfigs, actions, theme, hasLLMConfigs, hasActions, hasTheme };
+    }
+
+    /**
+     * Store several raw values in one config_setMany call
+     */
+    static async saveMany(values: Record<string, string>): Promise<boolean> {
+        try {
+            const exposed = window.saucer?.exposed;
+            if (!exposed?.config_setMany) {
+                if (!exposed?.config_setData) {
+                    console.warn('Config store API not available, cannot save values');
+                    return false;
+                }
+                const entries = Object.entries(values);
+                const writes = entries.map(([k, v]) => exposed.config_setData(k, v));
+                const results = await Promise.all(writes);
+                return results.every(Boolean);
+            }
+            return await exposed.config_setMany(JSON.stringify(values));
+        } catch (error) {
+            console.error('Error saving values to the config store:', error);
+            return false;
+        }
+    }
+
+    /**
+     * Load LLM configurations from the config store
      */
     static async loadLLMConfigs(): Promise<LLMConfig[]> {
         try {
-            if (!window.saucer?.exposed?.vault_getData) {
-                console.warn('Vault API not available, using default configs');
+            if (!window.saucer?.exposed?.config_getData) {
+                console.warn('Config store API not available, using default configs');
                 return this.getDefaultConfigs();
             }
 
-            const data = await window.saucer.exposed.vault_getData(this.LLM_CONFIGS_KEY);
+            const data = await window.saucer.exposed.config_getData(this.LLM_CONFIGS_KEY);
 
             if (!data) {
-                console.log('No LLM configs found in vault, using defaults');
+                console.log('No LLM configs found in the config store, using defaults');
                 return this.getDefaultConfigs();
             }
 
             const configs = JSON.parse(data) as LLMConfig[];
-            console.log('Loaded LLM configs from vault:', configs.length, 'configurations');
+            console.log('Loaded LLM configs from the config store:', configs.length, 'configs');
             return configs;
         } catch (error) {
-            console.error('Failed to load LLM configs from vault:', error);
+            console.error('Failed to load LLM configs from the config store:', error);
             return this.getDefaultConfigs();
         }
     }
 
     /**
-     * Save LLM configurations to the vault
+     * Save LLM configurations to the config store
      */
     static async saveLLMConfigs(configs: LLMConfig[]): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_setData) {
-                console.warn('Vault API not available, cannot save configs');
+            // Shared settings persist natively and send other windows only the difference
+            if (sharedSettings.available) {
+                return await sharedSettings.update(this.LLM_CONFIGS_KEY, configs);
+            }
+
+            if (!window.saucer?.exposed?.config_setData) {
+                console.warn('Config store API not available, cannot save configs');
                 return false;
             }
 
             const data = JSON.stringify(configs);
-            const success = await window.saucer.exposed.vault_setData(this.LLM_CONFIGS_KEY, data);
+            const success = await window.saucer.exposed.config_setData(this.LLM_CONFIGS_KEY, data);
 
             if (success) {
-                console.log('Successfully saved LLM configs to vault');
+                console.log('Successfully saved LLM configs to the config store');
             } else {
-                console.error('Failed to save LLM configs to vault');
+                console.error('Failed to save LLM configs to the config store');
             }
 
             return success;
         } catch (error) {
-            console.error('Error saving LLM configs to vault:', error);
+            console.error('Error saving LLM configs to the config store:', error);
             return false;
         }
     }
 
     /**
-     * Check if LLM configurations exist in the vault
+     * Check if LLM configurations exist in the config store
      */
     static async hasLLMConfigs(): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_hasData) {
+            if (!window.saucer?.exposed?.config_hasData) {
                 return false;
             }
 
-            return await window.saucer.exposed.vault_hasData(this.LLM_CONFIGS_KEY);
+            return await window.saucer.exposed.config_hasData(this.LLM_CONFIGS_KEY);
         } catch (error) {
-            console.error('Error checking for LLM configs in vault:', error);
+            console.error('Error checking for LLM configs in the config store:', error);
             return false;
         }
     }
 
     /**
-     * Delete LLM configurations from the vault
+     * Delete LLM configurations from the config store
      */
     static async deleteLLMConfigs(): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_deleteData) {
-                console.warn('Vault API not available, cannot delete configs');
+            if (!window.saucer?.exposed?.config_deleteData) {
+                console.warn('Config store API not available, cannot delete configs');
                 return false;
             }
 
-            const success = await window.saucer.exposed.vault_deleteData(this.LLM_CONFIGS_KEY);
+            const success = await window.saucer.exposed.config_deleteData(this.LLM_CONFIGS_KEY);
 
             if (success) {
-                console.log('Successfully deleted LLM configs from vault');
+                console.log('Successfully deleted LLM configs from the config store');
             } else {
-                console.error('Failed to delete LLM configs from vault');
+                console.error('Failed to delete LLM configs from the config store');
             }
 
             return success;
         } catch (error) {
-            console.error('Error deleting LLM configs from vault:', error);
+            console.error('Error deleting LLM configs from the config store:', error);
             return false;
         }
     }
 
     /**
-     * Get default LLM configurations (fallback when vault is empty)
+     * Get default LLM configurations (fallback when config store is empty)
      */
     private static getDefaultConfigs(): LLMConfig[] {
         return [];
     }
 
     /**
-     * Migrate from hardcoded configs to vault (one-time operation)
+     * Migrate from hardcoded configs to the config store (one-time operation)
      */
     static async migrateToVault(currentConfigs: LLMConfig[]): Promise<void> {
         try {
             const hasConfigs = await this.hasLLMConfigs();
 
             if (!hasConfigs && currentConfigs.length > 0) {
-                console.log('Migrating existing LLM configs to vault...');
+                console.log('Migrating existing LLM configs to the config store...');
                 await this.saveLLMConfigs(currentConfigs);
             }
         } catch (error) {
-            console.error('Error during vault migration:', error);
+            console.error('Error during config store migration:', error);
         }
     }
 
     // ===== Actions Management =====
 
     /**
-     * Load actions from the vault
+     * Load actions from the config store
      */
     static async loadActions(): Promise<Action[]> {
         try {
-            if (!window.saucer?.exposed?.vault_getData) {
-                console.warn('Vault API not available, using default actions');
+            if (!window.saucer?.exposed?.config_getData) {
+                console.warn('Config store API not available, using default actions');
                 return this.getDefaultActions();
             }
 
-            const data = await window.saucer.exposed.vault_getData(this.ACTIONS_KEY);
+            const data = await window.saucer.exposed.config_getData(this.ACTIONS_KEY);
 
             if (!data || data.trim() === '') {
-                console.log('No actions found in vault, using defaults');
+                console.log('No actions found in the config store, using defaults');
                 return this.getDefaultActions();
             }
 
             const actions = JSON.parse(data) as Action[];
-            console.log('Loaded actions from vault:', actions.length, 'actions');
+            console.log('Loaded actions from the config store:', actions.length, 'actions');
             return actions;
         } catch (error) {
-            console.error('Failed to load actions from vault:', error);
+            console.error('Failed to load actions from the config store:', error);
             return this.getDefaultActions();
         }
     }
 
     /**
-     * Save actions to the vault
+     * Save actions to the config store
      */
     static async saveActions(actions: Action[]): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_setData) {
-                console.warn('Vault API not available, cannot save actions');
+            if (sharedSettings.available) {
+                return await sharedSettings.update(this.ACTIONS_KEY, actions);
+            }
+
+            if (!window.saucer?.exposed?.config_setData) {
+                console.warn('Config store API not available, cannot save actions');
                 return false;
             }
 
             const data = JSON.stringify(actions);
-            const success = await window.saucer.exposed.vault_setData(this.ACTIONS_KEY, data);
+            const success = await window.saucer.exposed.config_setData(this.ACTIONS_KEY, data);
 
             if (success) {
-                console.log('Successfully saved actions to vault');
+                console.log('Successfully saved actions to the config store');
             } else {
-                console.error('Failed to save actions to vault');
+                console.error('Failed to save actions to the config store');
             }
 
             return success;
         } catch (error) {
-            console.error('Error saving actions to vault:', error);
+            console.error('Error saving actions to the config store:', error);
             return false;
         }
     }
 
     /**
-     * Check if actions exist in the vault
+     * Check if actions exist in the config store
      */
     static async hasActions(): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_hasData) {
+            if (!window.saucer?.exposed?.config_hasData) {
                 return false;
             }
 
-            return await window.saucer.exposed.vault_hasData(this.ACTIONS_KEY);
+            return await window.saucer.exposed.config_hasData(this.ACTIONS_KEY);
         } catch (error) {
-            console.error('Error checking for actions in vault:', error);
+            console.error('Error checking for actions in the config store:', error);
             return false;
         }
     }
 
     /**
-     * Delete actions from the vault
+     * Delete actions from the config store
      */
     static async deleteActions(): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_deleteData) {
-                console.warn('Vault API not available, cannot delete actions');
+            if (!window.saucer?.exposed?.config_deleteData) {
+                console.warn('Config store API not available, cannot delete actions');
                 return false;
             }
 
-            const success = await window.saucer.exposed.vault_deleteData(this.ACTIONS_KEY);
+            const success = await window.saucer.exposed.config_deleteData(this.ACTIONS_KEY);
 
             if (success) {
-                console.log('Successfully deleted actions from vault');
+                console.log('Successfully deleted actions from the config store');
             } else {
-                console.error('Failed to delete actions from vault');
+                console.error('Failed to delete actions from the config store');
             }
 
             return success;
         } catch (error) {
-            console.error('Error deleting actions from vault:', error);
+            console.error('Error deleting actions from the config store:', error);
             return false;
         }
     }
 
     /**
-     * Get default actions (fallback when vault is empty)
+     * Get default actions (fallback when config store is empty)
      */
     private static getDefaultActions(): Action[] {
         return [
@@ -227,12 +350,14 @@ export class VaultUtils {
                 label: 'Fix Grammar',
                 prompt: 'Fix the grammar and spelling in the following text',
                 enabled: true,
+                incremental: true,
             },
             {
                 id: 'improve-writing',
                 label: 'Improve Writing',
                 prompt: 'Improve the writing quality of the following text',
                 enabled: true,
+                incremental: true,
             },
             {
                 id: 'summarize',
@@ -245,12 +370,14 @@ export class VaultUtils {
                 label: 'Translate',
                 prompt: 'Translate the following text to English',
                 enabled: true,
+                incremental: true,
             },
             {
                 id: 'simplify',
                 label: 'Simplify',
                 prompt: 'Simplify the following text',
                 enabled: true,
+                incremental: true,
             },
             {
                 id: 'make-longer',
@@ -280,68 +407,72 @@ export class VaultUtils {
     }
 
     /**
-     * Load theme from the vault
+     * Load theme from the config store
      */
     static async loadTheme(): Promise<ThemeMode> {
         try {
-            if (!window.saucer?.exposed?.vault_getData) {
-                console.warn('Vault API not available, using default theme');
+            if (!window.saucer?.exposed?.config_getData) {
+                console.warn('Config store API not available, using default theme');
                 return 'auto';
             }
 
-            const data = await window.saucer.exposed.vault_getData(this.THEME_KEY);
+            const data = await window.saucer.exposed.config_getData(this.THEME_KEY);
 
             if (!data) {
-                console.log('No theme found in vault, using default');
+                console.log('No theme found in the config store, using default');
                 return 'auto';
             }
 
             const theme = JSON.parse(data) as ThemeMode;
-            console.log('Loaded theme from vault:', theme);
+            console.log('Loaded theme from the config store:', theme);
             return theme;
         } catch (error) {
-            console.error('Failed to load theme from vault:', error);
+            console.error('Failed to load theme from the config store:', error);
             return 'auto';
         }
     }
 
     /**
-     * Save theme to the vault
+     * Save theme to the config store
      */
     static async saveTheme(theme: ThemeMode): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_setData) {
-                console.warn('Vault API not available, cannot save theme');
+            if (sharedSettings.available) {
+                return await sharedSettings.update(this.THEME_KEY, theme);
+            }
+
+            if (!window.saucer?.exposed?.config_setData) {
+                console.warn('Config store API not available, cannot save theme');
                 return false;
             }
 
             const data = JSON.stringify(theme);
-            const success = await window.saucer.exposed.vault_setData(this.THEME_KEY, data);
+            const success = await window.saucer.exposed.config_setData(this.THEME_KEY, data);
 
             if (success) {
-                console.log('Successfully saved theme to vault:', theme);
+                console.log('Successfully saved theme to the config store:', theme);
             } else {
-                console.error('Failed to save theme to vault');
+                console.error('Failed to save theme to the config store');
             }
 
             return success;
         } catch (error) {
-            console.error('Failed to save theme to vault:', error);
+            console.error('Failed to save theme to the config store:', error);
             return false;
         }
     }
 
     /**
-     * Check if theme exists in vault
+     * Check if theme exists in the config store
      */
     static async hasTheme(): Promise<boolean> {
         try {
-            if (!window.saucer?.exposed?.vault_hasData) {
+            if (!window.saucer?.exposed?.config_hasData) {
                 return false;
             }
-            return await window.saucer.exposed.vault_hasData(this.THEME_KEY);
+            return await window.saucer.exposed.config_hasData(this.THEME_KEY);
         } catch (error) {
-            console.error('Failed to check if theme exists in vault:', error);
+            console.error('Failed to check if theme exists in the config store:', error);
             return false;
         }
     }